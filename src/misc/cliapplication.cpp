@@ -81,11 +81,12 @@ CliApplication::~CliApplication()
 
 //==============================================================================
 
-void CliApplication::loadPlugins()
+void CliApplication::loadPlugins(const QStringList &pCliPlugins)
 {
-    // Load all the plugins by creating our plugin manager
+    // Load all the plugins (or only the given CLI plugins, if any, and the
+    // plugins they need) by creating our plugin manager
 
-    mPluginManager = new PluginManager(false);
+    mPluginManager = new PluginManager(false, pCliPlugins);
 
     // Retrieve some categories of plugins
 
@@ -200,14 +201,29 @@ void CliApplication::about() const
 
 //==============================================================================
 
+static const auto CommandSeparator = QStringLiteral("::");
+
+//==============================================================================
+
+QString CliApplication::commandPluginName(const QString &pCommand)
+{
+    // Return the plugin, if any, to which the given command is to be sent
+
+    int commandSeparatorPosition = pCommand.indexOf(CommandSeparator);
+
+    return (commandSeparatorPosition != -1)?
+               pCommand.left(commandSeparatorPosition):
+               QString();
+}
+
+//==============================================================================
+
 bool CliApplication::command(const QString &pCommand,
                              const QStringList &pArguments, int &pRes) const
 {
     // Determine whether the command is to be executed by all the CLI plugins or
     // only a given CLI plugin
 
-    static const QString CommandSeparator = "::";
-
     QString commandName = pCommand;
     QString commandPlugin = commandName;
     int commandSeparatorPosition = commandName.indexOf(CommandSeparator);
@@ -634,9 +650,14 @@ bool CliApplication::run(int &pRes)
 
                 help();
             } else {
-                loadPlugins();
+                // Only load the plugin to which the command is to be sent (and
+                // the plugins it needs), if any, rather than all our CLI
+                // plugins
 
                 QString command = arguments.first();
+                QString plugin = commandPluginName(command);
+
+                loadPlugins(plugin.isEmpty()?QStringList():QStringList(plugin));
 
                 arguments.removeFirst();
 
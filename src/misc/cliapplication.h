@@ -62,10 +62,12 @@ private:
     Plugins mLoadedPluginPlugins;
     Plugins mLoadedSolverPlugins;
 
-    void loadPlugins();
+    void loadPlugins(const QStringList &pCliPlugins = {});
     void includePlugins(const QStringList &pPluginNames,
                         bool pInclude = true) const;
 
+    static QString commandPluginName(const QString &pCommand);
+
     void about() const;
     bool command(const QString &pCommand, const QStringList &pArguments,
                  int &pRes) const;
@@ -230,9 +230,14 @@ bool SynchronousFileDownloader::download(const QString &pUrl,
 
         // Make sure that we get told if there are SSL errors (which would
         // happen if a website's certificate is invalid, e.g. it has expired)
+        // Note: we use a direct connection since we may be called from a
+        //       background thread (e.g. to fetch several CellML imports
+        //       concurrently), in which case the SSL errors must be ignored in
+        //       that thread...
 
         connect(&networkAccessManager, &QNetworkAccessManager::sslErrors,
-                this, &SynchronousFileDownloader::networkAccessManagerSslErrors);
+                this, &SynchronousFileDownloader::networkAccessManagerSslErrors,
+                Qt::DirectConnection);
 
         // Download the contents of the remote file
 
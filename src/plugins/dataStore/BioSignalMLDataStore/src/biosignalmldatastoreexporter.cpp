@@ -100,11 +100,17 @@ void BiosignalmlDataStoreExporterWorker::run()
             clock->set_label(voi->name().toStdString());
 
             // Determine what should be exported (minus the VOI, which should
-            // always be exported in the case of a BioSignalML file)
+            // always be exported in the case of a BioSignalML file, and the
+            // variables that were not recorded for the current run)
 
-            DataStore::DataStoreVariables variables = mDataStoreData->variables();
+            const DataStore::DataStoreVariables dataStoreVariables = mDataStoreData->variables();
+            DataStore::DataStoreVariables variables;
 
-            variables.removeOne(dataStore->voi());
+            for (auto variable : dataStoreVariables) {
+                if ((variable != dataStore->voi()) && variable->isRecorded(i)) {
+                    variables << variable;
+                }
+            }
 
             // Retrieve some information about the different variables that are
             // to be exported
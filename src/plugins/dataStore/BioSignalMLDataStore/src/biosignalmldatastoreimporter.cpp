@@ -81,6 +81,8 @@ void BiosignalmlDataStoreImporterWorker::run()
             emit progress(mImportData, mImportData->progress());
         }
 
+        importDataStore->flushValues();
+
         delete[] variables;
 
         recording->close();
@@ -132,6 +132,12 @@ void CsvDataStoreExporterWorker::run()
 
         for (auto variable : qAsConst(variables)) {
             for (int i = 0; i < nbOfRuns; ++i) {
+                // Skip the variable if it wasn't recorded for the current run
+
+                if (!variable->isRecorded(i)) {
+                    continue;
+                }
+
                 if (!header.isEmpty()) {
                     header += ',';
                 }
@@ -173,6 +179,12 @@ void CsvDataStoreExporterWorker::run()
                     int j = 0;
 
                     for (auto variableRun : variableRuns) {
+                        if (!variableRun->isRecorded(j)) {
+                            ++j;
+
+                            continue;
+                        }
+
                         if (firstRowData && rowData.isEmpty()) {
                             firstRowData = false;
                         } else {
@@ -72,6 +72,8 @@ void CsvDataStoreImporterWorker::run()
             emit progress(mImportData, mImportData->progress());
         }
 
+        importDataStore->flushValues();
+
         file.close();
     } else {
         errorMessage = tr("The file could not be opened.");
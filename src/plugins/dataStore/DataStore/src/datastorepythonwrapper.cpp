@@ -434,13 +434,21 @@ PyObject * DataStorePythonWrapper::values(DataStoreVariable *pDataStoreVariable,
                                           int pRun) const
 {
     // Create and return a NumPy array for the given data store variable and run
+    // Note: we use a snapshot of the run since a simulation may be adding
+    //       values to it (and therefore growing its array) from another
+    //       thread...
 
-    DataStoreArray *dataStoreArray = pDataStoreVariable->array(pRun);
+    if (pDataStoreVariable != nullptr) {
+        quint64 size;
+        DataStoreArray *dataStoreArray = pDataStoreVariable->snapshot(size, pRun);
 
-    if ((pDataStoreVariable != nullptr) && (dataStoreArray != nullptr)) {
-        auto numPyArray = new NumPyPythonWrapper(dataStoreArray, pDataStoreVariable->size());
+        if (dataStoreArray != nullptr) {
+            auto numPyArray = new NumPyPythonWrapper(dataStoreArray, size);
 
-        return numPyArray->numPyArray();
+            dataStoreArray->release();
+
+            return numPyArray->numPyArray();
+        }
     }
 
 #include "pythonbegin.h"
@@ -459,8 +467,12 @@ NumPyPythonWrapper::NumPyPythonWrapper(DataStoreArray *pDataStoreArray,
     mArray->hold();
 
     // Initialise ourselves
+    // Note: our array may be bigger than the number of values it actually
+    //       holds (e.g. if it is for a run that is still being simulated or
+    //       for a variable that isn't recorded), so we only expose the given
+    //       number of values, even if it is zero...
 
-    std::array<npy_intp, 1> dims = { npy_intp((pSize > 0)?pSize:pDataStoreArray->size()) };
+    std::array<npy_intp, 1> dims = { npy_intp(pSize) };
 
 #include "pythonbegin.h"
     mNumPyArray = PyArray_SimpleNewFromData(1, dims.data(), NPY_DOUBLE, static_cast<void *>(mArray->data())); // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
@@ -75,7 +75,7 @@ class NumPyPythonWrapper : public QObject
 
 public:
     explicit NumPyPythonWrapper(DataStoreArray *pDataStoreArray,
-                                quint64 pSize = 0);
+                                quint64 pSize);
     ~NumPyPythonWrapper() override;
 
     PyObject * numPyArray() const;
@@ -43,7 +43,7 @@ extern "C" Q_DECL_EXPORT int dataStoreInterfaceVersion()
 {
     // Version of the data store interface
 
-    return 5;
+    return 8;
 }
 
 //==============================================================================
@@ -52,6 +52,11 @@ namespace DataStore {
 
 //==============================================================================
 
+static const quint64 InitialRunCapacity = 8192;
+static const quint64 BlockCapacity = 32;
+
+//==============================================================================
+
 DataStoreArray::DataStoreArray(quint64 pSize) :
     mSize(pSize)
 {
@@ -106,7 +111,7 @@ void DataStoreArray::hold()
 {
     // Increment our reference counter
 
-    ++mReferenceCounter;
+    mReferenceCounter.ref();
 }
 
 //==============================================================================
@@ -116,7 +121,7 @@ void DataStoreArray::release()
     // Decrement our reference counter, and delete our data and ourselves, if
     // needed
 
-    if (--mReferenceCounter == 0) {
+    if (!mReferenceCounter.deref()) {
         delete[] mData;
 
         delete this;
@@ -202,13 +207,25 @@ DataStoreValues::~DataStoreValues()
 
 //==============================================================================
 
-DataStoreVariableRun::DataStoreVariableRun(quint64 pCapacity, double *pValue) :
+DataStoreVariableRun::DataStoreVariableRun(quint64 pCapacity, double *pValue,
+                                           bool pPerPoint) :
     mCapacity(pCapacity),
+    mPerPoint(pPerPoint),
     mValue(pValue)
 {
     // Create our array of values
+    // Note: we used to allocate our full capacity straightaway, but for long
+    //       simulations of large models, this meant allocating (lots of)
+    //       memory that we might never use, or even failing to allocate it
+    //       all. So, now, we only allocate our full capacity if it is small
+    //       enough, and otherwise grow on demand (see grow())...
+
+    auto array = new DataStoreArray(qMin(mCapacity, InitialRunCapacity));
 
-    mArray = new DataStoreArray(mCapacity);
+    mArray.store(array);
+
+    mData = array->data();
+    mDataSize = array->size();
 }
 
 //==============================================================================
@@ -217,7 +234,65 @@ DataStoreVariableRun::~DataStoreVariableRun()
 {
     // Delete some internal objects
 
-    mArray->release();
+    mArray.load()->release();
+
+    for (auto retiredArray : qAsConst(mRetiredArrays)) {
+        retiredArray->release();
+    }
+}
+
+//==============================================================================
+
+bool DataStoreVariableRun::grow()
+{
+    // Try to double the size of our array, without going beyond our capacity
+    // Note #1: our old array may still be in use (e.g. the GUI thread may be
+    //          about to plot its values while we are running in a worker
+    //          thread), so rather than releasing it, we retire it and only
+    //          release it when we get deleted. Also, since our array grows
+    //          geometrically, our retired arrays never use more memory than our
+    //          current array...
+    // Note #2: if we cannot grow our array (e.g. because we have run out of
+    //          memory), then we consider that we have reached our capacity,
+    //          meaning that subsequent values will be ignored, as would have
+    //          been the case had we been full...
+    // Note #3: we are only ever called from the thread that adds values to
+    //          us, and our new array is published before the size that
+    //          requires it (see addValue()), so a reader that sees a given
+    //          size is guaranteed to also see an array that is big enough for
+    //          it...
+
+    if (mDataSize == mCapacity) {
+        return false;
+    }
+
+    try {
+        auto array = new DataStoreArray(qMin(mCapacity, 2*mDataSize));
+
+        memcpy(array->data(), mData, mSize.load()*Solver::SizeOfDouble);
+
+        mRetiredArrays << mArray.load();
+
+        mArray.storeRelease(array);
+
+        mData = array->data();
+        mDataSize = array->size();
+    } catch (...) {
+        mCapacity = mDataSize;
+
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+quint64 DataStoreVariableRun::capacity() const
+{
+    // Return our capacity
+
+    return mCapacity;
 }
 
 //==============================================================================
@@ -225,20 +300,42 @@ DataStoreVariableRun::~DataStoreVariableRun()
 quint64 DataStoreVariableRun::size() const
 {
     // Return our size
+    // Note: we may be called from a thread other than the one that adds values
+    //       to us, hence we acquire our size, so that all the values that it
+    //       covers are visible to the caller...
 
-    return mSize;
+    return mSize.loadAcquire();
+}
+
+//==============================================================================
+
+bool DataStoreVariableRun::isPerPoint() const
+{
+    // Return whether we hold one value per point
+
+    return mPerPoint;
 }
 
 //==============================================================================
 
 void DataStoreVariableRun::addValue()
 {
-    // Set the value of the variable at the given position
+    // Set the value of the variable at the given position, after growing our
+    // array, if needed
+    // Note #1: we rely on our cached data pointer and size rather than go
+    //          through our array...
+    // Note #2: we are the only ones to modify our size, so we can read it
+    //          without any ordering constraint, but we must release it once
+    //          our new value has been set, so that a reader that acquires our
+    //          size also sees our new value...
+
+    quint64 size = mSize.load();
 
-    if ((mSize < mCapacity) && (mValue != nullptr)) {
-        mArray->data()[mSize] = *mValue;
+    if (   (mValue != nullptr)
+        && ((size < mDataSize) || grow())) {
+        mData[size] = *mValue;
 
-        ++mSize;
+        mSize.storeRelease(size+1);
     }
 }
 
@@ -246,22 +343,79 @@ void DataStoreVariableRun::addValue()
 
 void DataStoreVariableRun::addValue(double pValue)
 {
-    // Set the value of the variable at the given position using the given value
+    // Set the value of the variable at the given position using the given
+    // value, after growing our array, if needed
 
-    if (mSize < mCapacity) {
-        mArray->data()[mSize] = pValue;
+    quint64 size = mSize.load();
 
-        ++mSize;
+    if ((size < mDataSize) || grow()) {
+        mData[size] = pValue;
+
+        mSize.storeRelease(size+1);
     }
 }
 
 //==============================================================================
 
+void DataStoreVariableRun::addValues(const double *pValues, quint64 pStride,
+                                     quint64 pCount)
+{
+    // Add the given number of values, which are separated by the given stride,
+    // after growing our array, if needed
+    // Note: our size is released only once, i.e. after all our new values
+    //       have been set, so that a reader sees either none or all of them...
+
+    quint64 size = mSize.load();
+    quint64 newSize = size+pCount;
+
+    while ((newSize > mDataSize) && grow()) {
+    }
+
+    newSize = qMin(newSize, mDataSize);
+
+    if (newSize == size) {
+        return;
+    }
+
+    if (pStride == 1) {
+        memcpy(mData+size, pValues, (newSize-size)*Solver::SizeOfDouble);
+    } else {
+        for (quint64 i = size; i < newSize; ++i, pValues += pStride) {
+            mData[i] = *pValues;
+        }
+    }
+
+    mSize.storeRelease(newSize);
+}
+
+//==============================================================================
+
 DataStoreArray * DataStoreVariableRun::array() const
 {
     // Return our array
 
-    return mArray;
+    return mArray.loadAcquire();
+}
+
+//==============================================================================
+
+DataStoreArray * DataStoreVariableRun::snapshot(quint64 &pSize) const
+{
+    // Return our array, after holding it on behalf of the caller, together
+    // with the number of values that it is guaranteed to contain
+    // Note #1: our size must be acquired before our array since values may be
+    //          added (and our array grown) in between, in which case we want
+    //          our size to be an underestimate for our array rather than an
+    //          overestimate...
+    // Note #2: the caller is responsible for releasing the array...
+
+    pSize = mSize.loadAcquire();
+
+    DataStoreArray *res = mArray.loadAcquire();
+
+    res->hold();
+
+    return res;
 }
 
 //==============================================================================
@@ -269,9 +423,19 @@ DataStoreArray * DataStoreVariableRun::array() const
 double DataStoreVariableRun::value(quint64 pPosition) const
 {
     // Return the value at the given position
+    // Note: if we don't hold one value per point, then we hold (at most) one
+    //       value for the whole run, so that is the value at any position...
+
+    quint64 size = mSize.loadAcquire();
 
-    return (pPosition < mSize)?
-               mArray->data()[pPosition]:
+    if (!mPerPoint) {
+        return (size != 0)?
+                   mArray.loadAcquire()->data()[0]:
+                   qQNaN();
+    }
+
+    return (pPosition < size)?
+               mArray.loadAcquire()->data()[pPosition]:
                qQNaN();
 }
 
@@ -279,9 +443,21 @@ double DataStoreVariableRun::value(quint64 pPosition) const
 
 double * DataStoreVariableRun::values() const
 {
-    // Return our values
+    // Return our values, but only if we hold one value per point since people
+    // expect as many values as there are points
 
-    return mArray->data();
+    return mPerPoint?
+               mArray.loadAcquire()->data():
+               nullptr;
+}
+
+//==============================================================================
+
+double * DataStoreVariableRun::valuePointer() const
+{
+    // Return the pointer to the value that we add at each point
+
+    return mValue;
 }
 
 //==============================================================================
@@ -341,10 +517,17 @@ int DataStoreVariable::runsCount() const
 
 bool DataStoreVariable::addRun(quint64 pCapacity)
 {
-    // Try to add a run of the given capacity
+    // Try to add a run of the given capacity, unless we are not to record all
+    // of our values, in which case our run needs to be able to hold no value
+    // at all or only one value
 
     try {
-        mRuns << new DataStoreVariableRun(pCapacity, mValue);
+        if (mRecording == Recording::Always) {
+            mRuns << new DataStoreVariableRun(pCapacity, mValue);
+        } else {
+            mRuns << new DataStoreVariableRun((mRecording == Recording::None)?0:qMin(pCapacity, quint64(1)),
+                                              mValue, false);
+        }
     } catch (...) {
         return false;
     }
@@ -367,6 +550,37 @@ void DataStoreVariable::keepRuns(int pRunsCount)
 
 //==============================================================================
 
+DataStoreVariableRun * DataStoreVariable::lastRun() const
+{
+    // Return our last run, if any
+
+    return mRuns.isEmpty()?
+               nullptr:
+               mRuns.last();
+}
+
+//==============================================================================
+
+DataStoreVariable::Recording DataStoreVariable::recording() const
+{
+    // Return our recording mode
+
+    return mRecording;
+}
+
+//==============================================================================
+
+void DataStoreVariable::setRecording(Recording pRecording)
+{
+    // Set our recording mode
+    // Note: our recording mode only affects the runs that get added from now
+    //       on...
+
+    mRecording = pRecording;
+}
+
+//==============================================================================
+
 int DataStoreVariable::type() const
 {
     // Return our type
@@ -458,6 +672,27 @@ quint64 DataStoreVariable::size(int pRun) const
 
 //==============================================================================
 
+bool DataStoreVariable::isRecorded(int pRun) const
+{
+    // Return whether we have recorded (or are recording) some values for the
+    // given run, i.e. whether the run can hold any value at all (see
+    // DataStoreVariable::addRun())
+
+    if (mRuns.isEmpty()) {
+        return false;
+    }
+
+    if (pRun == -1) {
+        return mRuns.last()->capacity() != 0;
+    }
+
+    return ((pRun >= 0) && (pRun < mRuns.count()))?
+               mRuns[pRun]->capacity() != 0:
+               false;
+}
+
+//==============================================================================
+
 DataStoreArray * DataStoreVariable::array(int pRun) const
 {
     // Return the array for the given run, if any
@@ -477,6 +712,28 @@ DataStoreArray * DataStoreVariable::array(int pRun) const
 
 //==============================================================================
 
+DataStoreArray * DataStoreVariable::snapshot(quint64 &pSize, int pRun) const
+{
+    // Return a snapshot of the given run, if any (see
+    // DataStoreVariableRun::snapshot())
+
+    pSize = 0;
+
+    if (mRuns.isEmpty()) {
+        return nullptr;
+    }
+
+    if (pRun == -1) {
+        return mRuns.last()->snapshot(pSize);
+    }
+
+    return ((pRun >= 0) && (pRun < mRuns.count()))?
+                mRuns[pRun]->snapshot(pSize):
+                nullptr;
+}
+
+//==============================================================================
+
 void DataStoreVariable::addValue()
 {
     // Add a value to our current (i.e. last) run
@@ -490,13 +747,17 @@ void DataStoreVariable::addValue()
 
 void DataStoreVariable::addValue(double pValue, int pRun)
 {
-    // Add the given value to our current (i.e. last) run
+    // Add the given value to the given run or to our current (i.e. last) run
+    // Note: we use QList::at() rather than QList::operator[]() since the
+    //       former doesn't detach our list, which is important since different
+    //       threads may add values to different runs (see
+    //       SimulationEnsembleWorker)...
 
     if (!mRuns.isEmpty()) {
         if (pRun == -1) {
             mRuns.last()->addValue(pValue);
         } else if ((pRun >= 0) && (pRun < mRuns.count())) {
-            mRuns[pRun]->addValue(pValue);
+            mRuns.at(pRun)->addValue(pValue);
         }
     }
 }
@@ -817,6 +1078,8 @@ DataStore::~DataStore()
     for (auto variable : qAsConst(mVariables)) {
         delete variable;
     }
+
+    delete[] mBlock;
 }
 
 //==============================================================================
@@ -840,19 +1103,69 @@ int DataStore::runsCount() const
 
 //==============================================================================
 
+quint64 DataStore::memoryLimit() const
+{
+    // Return our memory limit
+
+    return mMemoryLimit;
+}
+
+//==============================================================================
+
+void DataStore::setMemoryLimit(quint64 pMemoryLimit)
+{
+    // Set our memory limit, i.e. the amount of memory (in bytes) that the
+    // values of a run may use, with 0 meaning that there is no limit
+    // Note: our limit only applies to the runs that get added after it has
+    //       been set...
+
+    mMemoryLimit = pMemoryLimit;
+}
+
+//==============================================================================
+
 bool DataStore::addRun(quint64 pCapacity)
 {
-    // Try to add a run to our VOI and all our variables
+    // Try to add a run to our VOI and all our variables, making sure that we
+    // don't go beyond our memory limit, if any
+    // Note #1: only our VOI and the variables that are always recorded hold one
+    //          value per point, so they are the only ones that count towards
+    //          our memory limit...
+    // Note #2: a run grows geometrically (see DataStoreVariableRun::grow()),
+    //          keeping its previous arrays until it gets deleted, and those
+    //          arrays never use more memory than its current array, hence we
+    //          only allow half of our memory limit for a run's capacity...
+    // Note #3: all our per-point runs get the same capacity, which means that
+    //          they all grow in lockstep and that, once our memory limit has
+    //          been reached, subsequent points get ignored for all of them
+    //          rather than for only some of them...
+
+    flushValues();
+
+    quint64 capacity = pCapacity;
+
+    if (mMemoryLimit != 0) {
+        quint64 perPointVariablesCount = 1;
+
+        for (auto variable : qAsConst(mVariables)) {
+            if (variable->recording() == DataStoreVariable::Recording::Always) {
+                ++perPointVariablesCount;
+            }
+        }
+
+        capacity = qMin(capacity,
+                        mMemoryLimit/(2*perPointVariablesCount*Solver::SizeOfDouble));
+    }
 
     int oldRunsCount = mVoi->runsCount();
 
     try {
-        if (!mVoi->addRun(pCapacity)) {
+        if (!mVoi->addRun(capacity)) {
             throw std::exception();
         }
 
         for (auto variable : qAsConst(mVariables)) {
-            if (!variable->addRun(pCapacity)) {
+            if (!variable->addRun(capacity)) {
                 throw std::exception();
             }
         }
@@ -860,20 +1173,35 @@ bool DataStore::addRun(quint64 pCapacity)
         // We couldn't add a run to our VOI and all our variables, so only keep
         // the number of runs we used to have
 
-        mVoi->keepRuns(oldRunsCount);
-
-        for (auto variable : qAsConst(mVariables)) {
-            variable->keepRuns(oldRunsCount);
-        }
+        keepRuns(oldRunsCount);
 
         return false;
     }
 
+    mNeedRecordedRuns = true;
+
     return true;
 }
 
 //==============================================================================
 
+void DataStore::keepRuns(int pRunsCount)
+{
+    // Keep the given number of runs for our VOI and all our variables
+
+    flushValues();
+
+    mVoi->keepRuns(pRunsCount);
+
+    for (auto variable : qAsConst(mVariables)) {
+        variable->keepRuns(pRunsCount);
+    }
+
+    mNeedRecordedRuns = true;
+}
+
+//==============================================================================
+
 quint64 DataStore::size(int pRun) const
 {
     // Return our size, i.e. the size of our VOI, for example
@@ -923,6 +1251,8 @@ DataStoreVariables DataStore::addVariables(double *pValues, int pCount)
 {
     // Add some variables to our data store
 
+    flushValues();
+
     DataStoreVariables variables;
 
     for (int i = 0; i < pCount; ++i, ++pValues) {
@@ -931,6 +1261,8 @@ DataStoreVariables DataStore::addVariables(double *pValues, int pCount)
 
     mVariables << variables;
 
+    mNeedRecordedRuns = true;
+
     return variables;
 }
 
@@ -940,10 +1272,14 @@ DataStoreVariable * DataStore::addVariable(double *pValue)
 {
     // Add a variable to our data store
 
+    flushValues();
+
     auto variable = new DataStoreVariable(pValue);
 
     mVariables << variable;
 
+    mNeedRecordedRuns = true;
+
     return variable;
 }
 
@@ -953,11 +1289,15 @@ void DataStore::removeVariables(const DataStoreVariables &pVariables)
 {
     // Remove the given variables from our data store
 
+    flushValues();
+
     for (auto variable : pVariables) {
         delete variable;
 
         mVariables.removeOne(variable);
     }
+
+    mNeedRecordedRuns = true;
 }
 
 //==============================================================================
@@ -966,9 +1306,76 @@ void DataStore::removeVariable(DataStoreVariable *pVariable)
 {
     // Remove the given variable from our data store
 
+    flushValues();
+
     delete pVariable;
 
     mVariables.removeOne(pVariable);
+
+    mNeedRecordedRuns = true;
+}
+
+//==============================================================================
+
+void DataStore::updateRecordedRuns()
+{
+    // Keep track of the current (i.e. last) run of our variables that hold one
+    // value per point or one value for the whole run
+    // Note #1: this means that addValues() doesn't have to go through our
+    //          variables to find their current run, nor does it need to check
+    //          whether a variable is recorded...
+    // Note #2: our runs that hold one value per point are sorted by the
+    //          address of their value, so that we can group them by contiguous
+    //          block of memory (e.g. the states of a model) and copy each of
+    //          those blocks in one go (see addValues())...
+
+    mAlwaysRecordedRuns.clear();
+    mOnceRecordedRuns.clear();
+
+    for (auto variable : qAsConst(mVariables)) {
+        DataStoreVariableRun *run = variable->lastRun();
+
+        if (   (run != nullptr) && (run->capacity() != 0)
+            && (run->valuePointer() != nullptr)) {
+            if (run->isPerPoint()) {
+                mAlwaysRecordedRuns << run;
+            } else {
+                mOnceRecordedRuns << run;
+            }
+        }
+    }
+
+    std::sort(mAlwaysRecordedRuns.begin(), mAlwaysRecordedRuns.end(),
+              [](DataStoreVariableRun *pRun1, DataStoreVariableRun *pRun2) {
+                  return pRun1->valuePointer() < pRun2->valuePointer();
+              });
+
+    mBlockSources.clear();
+
+    const double *blockSourceEnd = nullptr;
+
+    for (auto run : qAsConst(mAlwaysRecordedRuns)) {
+        if (run->valuePointer() == blockSourceEnd) {
+            ++mBlockSources.last().second;
+        } else {
+            mBlockSources << QPair<const double *, int>(run->valuePointer(), 1);
+        }
+
+        blockSourceEnd = run->valuePointer()+1;
+    }
+
+    mVoiRun = mVoi->lastRun();
+
+    // Create our block, which holds the values of our VOI and of our runs that
+    // hold one value per point for up to BlockCapacity points, one row per
+    // point
+
+    delete[] mBlock;
+
+    mBlockWidth = mAlwaysRecordedRuns.count()+1;
+    mBlock = new double[BlockCapacity*quint64(mBlockWidth)] {};
+
+    mNeedRecordedRuns = false;
 }
 
 //==============================================================================
@@ -977,16 +1384,70 @@ void DataStore::addValues(double pVoiValue)
 {
     // Set the value at the mSize position of all our variables including our
     // VOI, which value is directly given to us
-    // Note: it is very important to add the VOI value last since our size()
-    //       method relies on it to determine our size. So, if we were to add
-    //       the VOI value first, we might in some cases (see issue #1579 for
-    //       example) end up with the wrong size...
+    // Note #1: variables that are not recorded are skipped altogether while
+    //          those that are recorded once only get their value added for the
+    //          first point of a run...
+    // Note #2: rather than adding the value of our variables one by one, we
+    //          copy them, block of memory by block of memory, to a new row of
+    //          our block, which gets flushed to our runs once it is full (see
+    //          flushValues()). This means that our values only become visible
+    //          to others once our block has been flushed, so whoever adds
+    //          values to us must also flush us once done or before having
+    //          others look at our values (e.g. when pausing a simulation)...
+
+    if (mNeedRecordedRuns) {
+        updateRecordedRuns();
+    }
 
-    for (auto variable : qAsConst(mVariables)) {
-        variable->addValue();
+    if ((mBlockSize == 0) && (mVoi->size() == 0)) {
+        for (auto run : qAsConst(mOnceRecordedRuns)) {
+            run->addValue();
+        }
+    }
+
+    double *row = mBlock+mBlockSize*quint64(mBlockWidth);
+
+    for (const auto &blockSource : qAsConst(mBlockSources)) {
+        memcpy(row, blockSource.first, quint64(blockSource.second)*Solver::SizeOfDouble);
+
+        row += blockSource.second;
+    }
+
+    *row = pVoiValue;
+
+    if (++mBlockSize == BlockCapacity) {
+        flushValues();
+    }
+}
+
+//==============================================================================
+
+void DataStore::flushValues()
+{
+    // Flush our block, i.e. add each of its columns to the corresponding run
+    // Note #1: it is very important to add the VOI values last since our size()
+    //          method relies on it to determine our size. So, if we were to
+    //          add the VOI values first, we might in some cases (see issue
+    //          #1579 for example) end up with the wrong size...
+    // Note #2: since the size of a run is released once its values have been
+    //          set (see DataStoreVariableRun::addValues()), adding the VOI
+    //          values last also means that a reader (e.g. the GUI thread) that
+    //          gets our size is guaranteed to see all the values it covers,
+    //          and this for all our variables...
+
+    if (mBlockSize == 0) {
+        return;
+    }
+
+    for (int i = 0, iMax = mAlwaysRecordedRuns.count(); i < iMax; ++i) {
+        mAlwaysRecordedRuns[i]->addValues(mBlock+i, quint64(mBlockWidth), mBlockSize);
+    }
+
+    if (mVoiRun != nullptr) {
+        mVoiRun->addValues(mBlock+mBlockWidth-1, quint64(mBlockWidth), mBlockSize);
     }
 
-    mVoi->addValue(pVoiValue);
+    mBlockSize = 0;
 }
 
 //==============================================================================
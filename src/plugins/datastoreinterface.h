@@ -25,7 +25,10 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QAtomicInteger>
+#include <QAtomicPointer>
 #include <QObject>
+#include <QVector>
 
 //==============================================================================
 
@@ -50,7 +53,7 @@ public:
     void release();
 
 private:
-    int mReferenceCounter = 1;
+    QAtomicInt mReferenceCounter = 1;
 
     quint64 mSize;
     double *mData = nullptr;
@@ -95,25 +98,42 @@ class DataStoreVariableRun : public QObject
     Q_OBJECT
 
 public:
-    explicit DataStoreVariableRun(quint64 pCapacity, double *pValue);
+    explicit DataStoreVariableRun(quint64 pCapacity, double *pValue,
+                                  bool pPerPoint = true);
     ~DataStoreVariableRun() override;
 
+    quint64 capacity() const;
     quint64 size() const;
 
+    bool isPerPoint() const;
+
     DataStoreArray * array() const;
+    DataStoreArray * snapshot(quint64 &pSize) const;
 
     void addValue();
     void addValue(double pValue);
+    void addValues(const double *pValues, quint64 pStride, quint64 pCount);
 
     double value(quint64 pPosition) const;
     double * values() const;
 
+    double * valuePointer() const;
+
 private:
     quint64 mCapacity;
-    quint64 mSize = 0;
+    QAtomicInteger<quint64> mSize = 0;
+
+    bool mPerPoint;
+
+    QAtomicPointer<DataStoreArray> mArray = nullptr;
+    QList<DataStoreArray *> mRetiredArrays;
+
+    double *mData;
+    quint64 mDataSize;
 
-    DataStoreArray *mArray = nullptr;
     double *mValue;
+
+    bool grow();
 };
 
 //==============================================================================
@@ -127,6 +147,12 @@ class DataStoreVariable : public QObject
     Q_OBJECT
 
 public:
+    enum class Recording {
+        None,
+        Once,
+        Always
+    };
+
     explicit DataStoreVariable(double *pValue = nullptr);
     ~DataStoreVariable() override;
 
@@ -136,6 +162,11 @@ public:
     bool addRun(quint64 pCapacity);
     void keepRuns(int pRunsCount);
 
+    DataStoreVariableRun * lastRun() const;
+
+    Recording recording() const;
+    void setRecording(Recording pRecording);
+
     void setType(int pType);
 
     void setUri(const QString &pUri);
@@ -143,6 +174,7 @@ public:
     void setUnit(const QString &pUnit);
 
     DataStoreArray * array(int pRun = -1) const;
+    DataStoreArray * snapshot(quint64 &pSize, int pRun = -1) const;
 
     void addValue();
     void addValue(double pValue, int pRun = -1);
@@ -162,12 +194,16 @@ public slots:
 
     quint64 size(int pRun = -1) const;
 
+    bool isRecorded(int pRun = -1) const;
+
     double value(quint64 pPosition, int pRun = -1) const;
 
     double value() const;
     void setValue(double pValue);
 
 private:
+    Recording mRecording = Recording::Always;
+
     int mType = -1;
     QString mUri;
     QString mName;
@@ -291,6 +327,7 @@ public:
     ~DataStore() override;
 
     bool addRun(quint64 pCapacity);
+    void keepRuns(int pRunsCount);
 
     DataStoreVariables variables();
     DataStoreVariables voiAndVariables();
@@ -302,6 +339,7 @@ public:
     void removeVariable(DataStoreVariable *pVariable);
 
     void addValues(double pVoiValue);
+    void flushValues();
 
 public slots:
     QString uri() const;
@@ -312,11 +350,31 @@ public slots:
 
     OpenCOR::DataStore::DataStoreVariable * voi() const;
 
+    quint64 memoryLimit() const;
+    void setMemoryLimit(quint64 pMemoryLimit);
+
 private:
     QString mUri;
 
+    quint64 mMemoryLimit = 0;
+
     DataStoreVariable *mVoi = nullptr;
     DataStoreVariables mVariables;
+
+    bool mNeedRecordedRuns = true;
+
+    DataStoreVariableRuns mAlwaysRecordedRuns;
+    DataStoreVariableRuns mOnceRecordedRuns;
+
+    DataStoreVariableRun *mVoiRun = nullptr;
+
+    QVector<QPair<const double *, int>> mBlockSources;
+
+    double *mBlock = nullptr;
+    int mBlockWidth = 0;
+    quint64 mBlockSize = 0;
+
+    void updateRecordedRuns();
 };
 
 //==============================================================================
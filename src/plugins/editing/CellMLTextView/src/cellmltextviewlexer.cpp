@@ -22,7 +22,6 @@ along with this program. If not, see <https://gnu.org/licenses>.
 //==============================================================================
 
 #include "cellmltextviewlexer.h"
-#include "qscintillawidget.h"
 
 //==============================================================================
 
@@ -134,6 +133,11 @@ static const int StyleChunk = 32768;
 
 //==============================================================================
 
+static const int MultilineCommentState = 0x1;
+static const int ParameterBlockState   = 0x2;
+
+//==============================================================================
+
 void CellmlTextViewLexer::styleText(int pStart, int pEnd)
 {
 #ifdef QT_DEBUG
@@ -144,58 +148,77 @@ void CellmlTextViewLexer::styleText(int pStart, int pEnd)
     }
 #endif
 
-    // Keep track of some information
-
-    mFullText = editor()->text().toUtf8();
-    mEolString = qobject_cast<QScintillaWidget::QScintillaWidget *>(editor())->eolString();
-
-    // Style the text in small chunks (to reduce memory usage, which can quickly
-    // become ridiculous the first time we are styling a big CellML file)
-
-    int start = pStart;
-    int end;
-
-    forever {
-        // Use a default style for our chunk of text
-        // Note: this is so that validString() can work properly...
-
-        end = qMin(start+StyleChunk, pEnd);
-
-        applyStyle(start, end, Style::Default);
-
-        // Retrieve the chunk of text to style and style it
-
-        auto data = new char[end-start+1] {};
-
-        editor()->SendScintilla(QsciScintilla::SCI_GETTEXTRANGE,
-                                start, end, data);
-
-        styleText(start, end, data, false);
+    // Retrieve direct access to our editor's text
+    // Note: this gives us access to Scintilla's own buffer, so there is no need
+    //       to copy and convert the whole document every time we are asked to
+    //       style some text. The pointer remains valid for as long as the text
+    //       is not modified, which it won't be while we are styling it...
+
+    mText = static_cast<const char *>(editor()->SendScintillaPtrResult(QsciScintillaBase::SCI_GETCHARACTERPOINTER));
+    mTextLength = int(editor()->SendScintilla(QsciScintillaBase::SCI_GETLENGTH));
+
+    // Style the text line by line, starting from the state in which the
+    // previous line left us
+    // Note #1: QScintilla always asks us to style some text from the beginning
+    //          of a line, but we make sure that it is the case, just in case...
+    // Note #2: the state of a line (i.e. whether it ends within a /* XXX */
+    //          comment and/or a parameter block) is kept by Scintilla, which
+    //          means that we never need to look back further than the previous
+    //          line. Also, Scintilla discards the styling of everything that
+    //          follows a modification, so we only need to style the lines we
+    //          are asked to style, the following lines being styled (from the
+    //          state in which we left them) whenever they are needed...
+    // Note #3: we style the text in small chunks (to reduce memory usage, which
+    //          can quickly become ridiculous the first time we are styling a
+    //          big CellML file)...
+
+    int line = int(editor()->SendScintilla(QsciScintillaBase::SCI_LINEFROMPOSITION, pStart));
+    int linesCount = int(editor()->SendScintilla(QsciScintillaBase::SCI_GETLINECOUNT));
+    int state = (line == 0)?
+                    0:
+                    int(editor()->SendScintilla(QsciScintillaBase::SCI_GETLINESTATE, line-1));
+    int start = int(editor()->SendScintilla(QsciScintillaBase::SCI_POSITIONFROMLINE, line));
+    int end = start;
+
+    mStyles.resize(0);
+
+    while ((end < pEnd) && (line < linesCount)) {
+        int lineEnd = (line+1 < linesCount)?
+                          int(editor()->SendScintilla(QsciScintillaBase::SCI_POSITIONFROMLINE, line+1)):
+                          mTextLength;
+
+        state = styleLine(end, lineEnd, state);
+
+        editor()->SendScintilla(QsciScintillaBase::SCI_SETLINESTATE, line, state);
+
+        end = lineEnd;
+
+        ++line;
+
+        if (mStyles.length() >= StyleChunk) {
+            flushStyles(start);
+
+            start = end;
+        }
+    }
 
-        delete[] data;
+    flushStyles(start);
 
 #ifdef QT_DEBUG
-        // Make sure that the end position of the last bit of chunk of text that
-        // we styled is end
-        // Note: we need to ensure that it is the case, so that validString()
-        //       can take advantage of the style of a given character in the
-        //       editor...
-
-        if (editor()->SendScintilla(QsciScintillaBase::SCI_GETENDSTYLED) != end) {
-            qFatal("FATAL ERROR | %s:%d: the styling of the text must be incremental.", __FILE__, __LINE__);
-        }
-#endif
-
-        // Was it our last chunk of text?
+    // Make sure that the end position of the last bit of text that we styled is
+    // end
+    // Note: we need to ensure that it is the case, so that QScintilla can
+    //       determine where to start the next bit of styling...
 
-        if (end == pEnd) {
-            break;
-        }
+    if (editor()->SendScintilla(QsciScintillaBase::SCI_GETENDSTYLED) != end) {
+        qFatal("FATAL ERROR | %s:%d: the styling of the text must be incremental.", __FILE__, __LINE__);
+    }
+#endif
 
-        // Get ready for the next chunk of text
+    // We are done with our editor's text
 
-        start = end;
-    }
+    mText = nullptr;
+    mTextLength = 0;
 
     // Let people know that we are done with our styling
 
@@ -204,564 +227,295 @@ void CellmlTextViewLexer::styleText(int pStart, int pEnd)
 
 //==============================================================================
 
-static const char *SingleLineCommentString = "//";
-static const int SingleLineCommentLength   = 2;
-
-//==============================================================================
-
-static const char *StartMultilineCommentString = "/*";
-static const char *EndMultilineCommentString   = "*/";
-static const int EndMultilineCommentLength     = 2;
-
-//==============================================================================
-
-static const char *StartParameterBlockString = "{";
-static const char *EndParameterBlockString   = "}";
-static const int StartParameterBlockLength   = 1;
-static const int EndParameterBlockLength     = 1;
-
-//==============================================================================
-
-static const char *StringString = R"(")";
-static const int StringLength   = 1;
-
-//==============================================================================
-
-void CellmlTextViewLexer::applyStyle(int pStart, int pEnd, Style pStyle)
-{
-    // Apply the given style to the given chunk of text
-
-    startStyling(pStart);
-    setStyling(pEnd-pStart, int(pStyle));
-}
-
-//==============================================================================
-
-void CellmlTextViewLexer::styleText(int pStart, int pEnd,
-                                    const QByteArray &pText,
-                                    bool pParameterBlock)
+void CellmlTextViewLexer::flushStyles(int pStart)
 {
-    // Make sure that we are given some text to style
+    // Apply the styles that we have computed so far, in one go, starting from
+    // the given position
 
-    if (pStart == pEnd) {
+    if (mStyles.isEmpty()) {
         return;
     }
 
-    // Check whether a /* XXX */ comment or a parameter block started before or
-    // at the beginning of the given text
-
-    int multilineCommentStartPosition = findString(StartMultilineCommentString, pStart, Style::MultilineComment, false);
-    int parameterBlockStartPosition = findString(StartParameterBlockString, pStart, Style::ParameterBlock, false);
-
-    multilineCommentStartPosition = (multilineCommentStartPosition == -1)?
-                                        INT_MAX:
-                                        multilineCommentStartPosition;
-    parameterBlockStartPosition = (parameterBlockStartPosition == -1)?
-                                      INT_MAX:
-                                      parameterBlockStartPosition;
-
-    int multilineCommentEndPosition = (multilineCommentStartPosition == INT_MAX)?
-                                          INT_MAX:
-                                          findString(EndMultilineCommentString, multilineCommentStartPosition, Style::MultilineComment);
-
-    multilineCommentEndPosition = (multilineCommentEndPosition == -1)?
-                                      INT_MAX:
-                                      multilineCommentEndPosition;
+    startStyling(pStart);
 
-    if (   (multilineCommentStartPosition != INT_MAX)
-        && (   (parameterBlockStartPosition == INT_MAX)
-            || (   (multilineCommentStartPosition > parameterBlockStartPosition)
-                && (multilineCommentEndPosition > pStart)))) {
-        // There is a previous /* XXX */ comment to style
+    editor()->SendScintilla(QsciScintillaBase::SCI_SETSTYLINGEX,
+                            ulong(mStyles.length()), mStyles.constData());
 
-        styleTextPreviousMultilineComment(multilineCommentStartPosition,
-                                          pStart, pEnd,
-                                          pText, pParameterBlock);
-    } else {
-        int parameterBlockEndPosition = (parameterBlockStartPosition == INT_MAX)?
-                                            INT_MAX:
-                                            findString(EndParameterBlockString, parameterBlockStartPosition, Style::ParameterBlock);
-
-        parameterBlockEndPosition = (parameterBlockEndPosition == -1)?
-                                        INT_MAX:
-                                        parameterBlockEndPosition;
-
-        if (   (parameterBlockStartPosition != INT_MAX)
-            && (   (multilineCommentStartPosition == INT_MAX)
-                || (   (parameterBlockStartPosition > multilineCommentStartPosition)
-                    && (parameterBlockEndPosition > pStart)))) {
-            // There is a previous parameter block to style
-
-            styleTextPreviousParameterBlock(parameterBlockStartPosition,
-                                            pStart, pEnd,
-                                            pText, pParameterBlock);
-        } else {
-            // Style the current text
-
-            styleTextCurrent(pStart, pEnd, pText,
-                             (parameterBlockStartPosition < pStart) && (parameterBlockEndPosition > pStart));
-        }
-    }
+    mStyles.resize(0);
 }
 
 //==============================================================================
 
-void CellmlTextViewLexer::styleTextCurrent(int pStart, int pEnd,
-                                           const QByteArray &pText,
-                                           bool pParameterBlock)
+int CellmlTextViewLexer::styleLine(int pStart, int pEnd, int pState)
 {
-    // Make sure that we are given some text to style
-
-    if (pStart == pEnd) {
-        return;
-    }
-
-    // Check whether the given text contains a string, a // comment, a /* XXX */
-    // comment or a parameter block
-
-    int stringPosition = pText.indexOf(StringString);
-    int singleLineCommentPosition = pText.indexOf(SingleLineCommentString);
-    int multilineCommentStartPosition = pText.indexOf(StartMultilineCommentString);
-
-    stringPosition = (stringPosition == -1)?
-                         INT_MAX:
-                         stringPosition;
-    singleLineCommentPosition = (singleLineCommentPosition == -1)?
-                                    INT_MAX:
-                                    singleLineCommentPosition;
-    multilineCommentStartPosition = (multilineCommentStartPosition == -1)?
-                                        INT_MAX:
-                                        multilineCommentStartPosition;
-
-    if (   (stringPosition != INT_MAX)
-        && (stringPosition < singleLineCommentPosition)
-        && (stringPosition < multilineCommentStartPosition)) {
-        // There is a string to style
-
-        styleTextString(stringPosition, pStart, pEnd, pText, pParameterBlock);
-    } else if (   (singleLineCommentPosition != INT_MAX)
-               && (singleLineCommentPosition < stringPosition)
-               && (singleLineCommentPosition < multilineCommentStartPosition)) {
-        // There is a // comment to style, so first style everything that is
-        // before it
-
-        styleTextCurrent(pStart, pStart+singleLineCommentPosition,
-                         pText.left(singleLineCommentPosition),
-                         pParameterBlock);
-
-        // Style the // comment itself, after having looked for the end of the
-        // line, if any
-
-        int eolPosition = pText.indexOf(mEolString, singleLineCommentPosition+SingleLineCommentLength);
-        int end = (eolPosition == -1)?pEnd:pStart+eolPosition+mEolString.length();
-
-        applyStyle(pStart+singleLineCommentPosition, end, Style::SingleLineComment);
-
-        // Now, style everything that is after the // comment, if anything
-
-        if (eolPosition != -1) {
-            styleText(end, pEnd, pText.right(pEnd-end), pParameterBlock);
-        }
-    } else if (   (multilineCommentStartPosition != INT_MAX)
-               && (multilineCommentStartPosition < stringPosition)
-               && (multilineCommentStartPosition < singleLineCommentPosition)) {
-        // There is a /* XXX */ comment to style, so first style everything that
-        // is before it
-
-        styleTextCurrent(pStart, pStart+multilineCommentStartPosition,
-                         pText.left(multilineCommentStartPosition),
-                         pParameterBlock);
-
-        // Now style everything from the comment onwards
-        // Note #1: to style everything from the comment onwards means that we
-        //          will find that a /* XXX */ comment starts at the beginning
-        //          of the 'new' given text...
-        // Note #2: for the parameter block value, we check whether a parameter
-        //          block was started before the /* XXX */ comment line since
-        //          we need to finish styling it (which is effectively done in
-        //          styleTextPreviousMultilineComment())...
-
-        int multilineCommentParameterBlockStartPosition = findString(StartParameterBlockString, pStart+multilineCommentStartPosition, Style::ParameterBlock, false);
-        int multilineCommentParameterBlockEndPosition = findString(EndParameterBlockString, multilineCommentParameterBlockStartPosition, Style::ParameterBlock);
-
-        multilineCommentParameterBlockStartPosition = (multilineCommentParameterBlockStartPosition == -1)?
-                                                          INT_MAX:
-                                                          multilineCommentParameterBlockStartPosition;
-        multilineCommentParameterBlockEndPosition = (multilineCommentParameterBlockEndPosition == -1)?
-                                                        INT_MAX:
-                                                        multilineCommentParameterBlockEndPosition;
-
-        int absoluteMultilineCommentStartPosition = pStart+multilineCommentStartPosition;
-
-        styleText(pStart+multilineCommentStartPosition, pEnd,
-                  pText.right(pEnd-pStart-multilineCommentStartPosition),
-                     (multilineCommentParameterBlockStartPosition < absoluteMultilineCommentStartPosition)
-                  && (absoluteMultilineCommentStartPosition < multilineCommentParameterBlockEndPosition));
-    } else {
-        int parameterBlockStartPosition = pText.indexOf(StartParameterBlockString);
-
-        parameterBlockStartPosition = (parameterBlockStartPosition == -1)?
-                                          INT_MAX:
-                                          parameterBlockStartPosition;
-
-        if (   (parameterBlockStartPosition != INT_MAX)
-            && (parameterBlockStartPosition < stringPosition)
-            && (parameterBlockStartPosition < singleLineCommentPosition)
-            && (parameterBlockStartPosition < multilineCommentStartPosition)) {
-            // There is a parameter block, so first style everything that is
-            // before it
-
-            styleTextCurrent(pStart, pStart+parameterBlockStartPosition,
-                             pText.left(parameterBlockStartPosition),
-                             pParameterBlock);
-
-            // Now style everything from the parameter block onwards
-            // Note: to style everything from the parameter block onwards means
-            //       that we will find that a parameter block starts at the
-            //       beginning of the 'new' given text...
-
-            styleText(pStart+parameterBlockStartPosition, pEnd,
-                      pText.right(pEnd-pStart-parameterBlockStartPosition),
-                      pParameterBlock);
-        } else {
-            // Style the given text as a parameter block, if needed
-
-            if (pParameterBlock) {
-                applyStyle(pStart, pEnd, Style::ParameterBlock);
+    // Style the given line, which starts in the given state, and return the
+    // state in which it ends
+    // Note: a string, a // comment, a /* XXX */ comment or a parameter block
+    //       starts with whichever of them comes first, strings and // comments
+    //       ending with the line at the latest while /* XXX */ comments and
+    //       parameter blocks may span several lines...
+
+    bool multilineComment = (pState & MultilineCommentState) != 0;
+    bool parameterBlock = (pState & ParameterBlockState) != 0;
+    int codeStart = pStart;
+    int i = pStart;
+
+    while (i < pEnd) {
+        if (multilineComment) {
+            // We are within a /* XXX */ comment, so look for its end on this
+            // line
+
+            int end = pEnd;
+
+            for (int j = i; j+1 < pEnd; ++j) {
+                if ((mText[j] == '*') && (mText[j+1] == '/')) {
+                    end = j+2;
+                    multilineComment = false;
+
+                    break;
+                }
             }
 
-            // Check whether the given text contains some keywords from various
-            // categories
-
-            static const QRegularExpression KeywordsRegEx = QRegularExpression(
-                "\\b("
-                    // CellML Text keywords
-
-                    "and|as|between|case|comp|def|endcomp|enddef|endsel|for|"
-                    "group|import|incl|map|model|otherwise|sel|unit|using|var|"
-                    "vars|"
-
-                    // MathML arithmetic operators
-
-                    "abs|ceil|exp|fact|floor|ln|log|pow|root|sqr|sqrt|"
-
-                    // MathML logical operators
-
-                    "and|or|xor|not|"
-
-                    // MathML calculus elements
-
-                    "ode|"
+            mStyles.append(end-i, char(Style::MultilineComment));
 
-                    // MathML min/max operators
+            i = codeStart = end;
 
-                    "min|max|"
-
-                    // MathML gcd/lcm operators
-
-                    "gcd|lcm|"
-
-                    // MathML trigonometric operators
-
-                    "sin|cos|tan|sec|csc|cot|sinh|cosh|tanh|sech|csch|coth|"
-                    "asin|acos|atan|asec|acsc|acot|asinh|acosh|atanh|asech|"
-                    "acsch|acoth|"
+            continue;
+        }
 
-                    // MathML constants
+        char character = mText[i];
+        char nextCharacter = (i+1 < pEnd)?mText[i+1]:0;
 
-                    "true|false|nan|pi|inf|e|"
+        if (character == '"') {
+            // There is a string, so style everything that is before it and then
+            // the string itself, up to the end of the line if it doesn't end on
+            // this line
 
-                    // Extra operators
+            styleCode(codeStart, i, parameterBlock);
 
-                    "rem"
-                ")\\b");
+            int end = pEnd;
 
-            static const QRegularExpression CellmlKeywordsRegEx = QRegularExpression(
-                "\\b("
-                     // Miscellaneous
+            for (int j = i+1; j < pEnd; ++j) {
+                if (mText[j] == '"') {
+                    end = j+1;
 
-                    "base|encapsulation|containment"
-                ")\\b");
+                    break;
+                }
+            }
 
-            static const QRegularExpression ParameterKeywordsRegEx = QRegularExpression(
-                "\\b("
-                    // Unit keywords
+            mStyles.append(end-i, char(parameterBlock?
+                                           Style::ParameterString:
+                                           Style::String));
 
-                    "pref|expo|mult|off|"
+            i = codeStart = end;
+        } else if ((character == '/') && (nextCharacter == '/')) {
+            // There is a // comment, so style everything that is before it and
+            // then the rest of the line as a comment
 
-                    // Variable keywords
+            styleCode(codeStart, i, parameterBlock);
 
-                    "init|pub|priv"
-                ")\\b");
+            mStyles.append(pEnd-i, char(Style::SingleLineComment));
 
-            static const QRegularExpression ParameterCellmlKeywordsRegEx = QRegularExpression(
-                "\\b("
-                    // Unit prefixes
+            i = codeStart = pEnd;
+        } else if ((character == '/') && (nextCharacter == '*')) {
+            // There is a /* XXX */ comment, so style everything that is before
+            // it and then its start, the rest being styled in the next
+            // iteration
 
-                    "yotta|zetta|exa|peta|tera|giga|mega|kilo|hecto|deka|deci|"
-                    "centi|milli|micro|nano|pico|femto|atto|zepto|yocto|"
+            styleCode(codeStart, i, parameterBlock);
 
-                    // Public/private interfaces
+            mStyles.append(2, char(Style::MultilineComment));
 
-                    "in|out|none"
-                ")\\b");
+            multilineComment = true;
 
-            static const QRegularExpression SiUnitKeywordsRegEx = QRegularExpression(
-                "\\b("
-                    // Standard units
+            i = codeStart = i+2;
+        } else if ((character == '{') || ((character == '}') && parameterBlock)) {
+            // There is the start or the end of a parameter block, so style
+            // everything that is before it and then the brace itself
 
-                    "ampere|becquerel|candela|celsius|coulomb|dimensionless|"
-                    "farad|gram|gray|henry|hertz|joule|katal|kelvin|kilogram|"
-                    "liter|litre|lumen|lux|meter|metre|mole|newton|ohm|pascal|"
-                    "radian|second|siemens|sievert|steradian|tesla|volt|watt|"
-                    "weber"
-                ")\\b");
+            styleCode(codeStart, i, parameterBlock);
 
-            if (pParameterBlock) {
-                styleTextRegEx(pStart, pText, ParameterKeywordsRegEx, Style::ParameterKeyword);
-                styleTextRegEx(pStart, pText, ParameterCellmlKeywordsRegEx, Style::ParameterCellmlKeyword);
-            } else {
-                styleTextRegEx(pStart, pText, KeywordsRegEx, Style::Keyword);
-                styleTextRegEx(pStart, pText, CellmlKeywordsRegEx, Style::CellmlKeyword);
-            }
+            mStyles.append(1, char(Style::ParameterBlock));
 
-            styleTextRegEx(pStart, pText, SiUnitKeywordsRegEx,
-                           pParameterBlock?
-                               Style::ParameterCellmlKeyword:
-                               Style::CellmlKeyword);
+            parameterBlock = character == '{';
 
-            // Check whether the given text contains some numbers
+            i = codeStart = i+1;
+        } else {
+            ++i;
+        }
+    }
 
-            styleTextNumber(pStart, pText, pParameterBlock?
-                                               Style::ParameterNumber:
-                                               Style::Number);
+    // Style whatever is left on the line
 
-            // Let QScintilla know that we are done with the styling of the
-            // given text
-            // Note: indeed, QScintilla uses the end position of the last bit of
-            //       text that has been styled to determine the starting
-            //       position of the next bit of text that needs to be styled
-            //       (see QsciLexerCustom::handleStyleNeeded()). Now, depending
-            //       on whether keywords and/or numbers have been styled, the
-            //       end position may or not be pEnd. So, here, we make sure
-            //       that it is, so that QScintilla can work as it should...
+    styleCode(codeStart, pEnd, parameterBlock);
 
-            startStyling(pEnd);
-        }
-    }
+    return   (multilineComment?MultilineCommentState:0)
+           | (parameterBlock?ParameterBlockState:0);
 }
 
 //==============================================================================
 
-void CellmlTextViewLexer::styleTextPreviousMultilineComment(int pPosition,
-                                                            int pStart,
-                                                            int pEnd,
-                                                            const QByteArray &pText,
-                                                            bool pParameterBlock)
+void CellmlTextViewLexer::styleCode(int pStart, int pEnd, bool pParameterBlock)
 {
-    // A /* XXX */ comment started before or at the beginning of the given text,
-    // so now look for where it ends
+    // Make sure that we are given some code to style
 
-    int multilineCommentEndPosition = findString(EndMultilineCommentString, pPosition, Style::MultilineComment);
-
-    if (multilineCommentEndPosition == -1) {
-        multilineCommentEndPosition = mFullText.length();
+    if (pStart == pEnd) {
+        return;
     }
 
-    // Check whether the beginning of the given text is within the /* XXX */
-    // comment
+    // Style the given code as default or as a parameter block
 
-    if ((pPosition <= pStart) && (pStart <= multilineCommentEndPosition)) {
-        // The beginning of the given text is within a /* XXX */ comment, so
-        // style it
+    int offset = mStyles.length();
 
-        int realEnd = multilineCommentEndPosition+EndMultilineCommentLength;
-        int end = qMin(pEnd, realEnd);
+    mStyles.append(pEnd-pStart, char(pParameterBlock?
+                                         Style::ParameterBlock:
+                                         Style::Default));
 
-        applyStyle(pStart, end, Style::MultilineComment);
+    // Check whether the given code contains some keywords from various
+    // categories
+    // Note: keywords and numbers are plain ASCII, so we can use a Latin-1
+    //       version of our code, which means that positions in it are the same
+    //       as in our editor's text...
 
-        // Now, style everything that is behind the /* XXX */ comment, if
-        // anything
+    QString code = QString::fromLatin1(mText+pStart, pEnd-pStart);
 
-        if (end != pEnd) {
-            if (pParameterBlock) {
-                // Our /* XXX */ comment is within a parameter block, so finish
-                // styling our parameter block
+    static const QRegularExpression KeywordsRegEx = QRegularExpression(
+        "\\b("
+            // CellML Text keywords
 
-                styleTextPreviousParameterBlock(end, end, pEnd, pText.right(pEnd-end), false);
-            } else {
-                styleText(end, pEnd, pText.right(pEnd-end), pParameterBlock);
-            }
-        }
-    } else {
-        // The beginning of the given text is not within a /* XXX */ comment, so
-        // style it
+            "and|as|between|case|comp|def|endcomp|enddef|endsel|for|"
+            "group|import|incl|map|model|otherwise|sel|unit|using|var|"
+            "vars|"
 
-        styleTextCurrent(pStart, pEnd, pText, pParameterBlock);
-    }
-}
-
-//==============================================================================
+            // MathML arithmetic operators
 
-void CellmlTextViewLexer::styleTextPreviousParameterBlock(int pPosition,
-                                                          int pStart, int pEnd,
-                                                          const QByteArray &pText,
-                                                          bool pParameterBlock)
-{
-    // A parameter block started before or at the beginning of the given text,
-    // so now look for where it ends
-
-    int parameterBlockEndPosition = findString(EndParameterBlockString, pPosition, Style::ParameterBlock);
-
-    if (parameterBlockEndPosition == -1) {
-        parameterBlockEndPosition = mFullText.length();
-    }
+            "abs|ceil|exp|fact|floor|ln|log|pow|root|sqr|sqrt|"
 
-    // Check whether the beginning of the given text is within a parameter block
+            // MathML logical operators
 
-    if ((pPosition <= pStart) && (pStart <= parameterBlockEndPosition)) {
-        // The beginning of the given text is within a parameter block, so style
-        // it as such
+            "and|or|xor|not|"
 
-        int realEnd = parameterBlockEndPosition+EndParameterBlockLength;
-        int end = qMin(pEnd, realEnd);
-        bool hasStart =    (pPosition == pStart)
-                        && (mFullText.mid(pPosition, StartParameterBlockLength) == StartParameterBlockString);
-        bool hasEnd = end == realEnd;
+            // MathML calculus elements
 
-        // If needed, style the start of the parameter block
+            "ode|"
 
-        if (hasStart) {
-            applyStyle(pStart, pStart+StartParameterBlockLength, Style::ParameterBlock);
-        }
+            // MathML min/max operators
 
-        // Now style the contents of the parameter block itself
+            "min|max|"
 
-        int newStart = pStart+(hasStart?StartParameterBlockLength:0);
-        int newEnd = end-(hasEnd?EndParameterBlockLength:0);
+            // MathML gcd/lcm operators
 
-        styleTextCurrent(newStart, newEnd, pText.mid(newStart-pStart, newEnd-newStart), true);
+            "gcd|lcm|"
 
-        // If needed, style the end of the parameter block, as well as what is
-        // behind it
+            // MathML trigonometric operators
 
-        if (hasEnd) {
-            applyStyle(end-EndParameterBlockLength, end, Style::ParameterBlock);
+            "sin|cos|tan|sec|csc|cot|sinh|cosh|tanh|sech|csch|coth|"
+            "asin|acos|atan|asec|acsc|acot|asinh|acosh|atanh|asech|"
+            "acsch|acoth|"
 
-            styleText(end, pEnd, pText.right(pEnd-end), pParameterBlock);
-        }
-    } else {
-        // The beginning of the given text is not within a parameter block, so
-        // style it
+            // MathML constants
 
-        styleTextCurrent(pStart, pEnd, pText, pParameterBlock);
-    }
-}
+            "true|false|nan|pi|inf|e|"
 
-//==============================================================================
+            // Extra operators
 
-void CellmlTextViewLexer::styleTextString(int pPosition, int pStart, int pEnd,
-                                          const QByteArray &pText,
-                                          bool pParameterBlock)
-{
-    // There is a string to style, so first style everything that is before it
+            "rem"
+        ")\\b");
 
-    int position = pStart+pPosition;
+    static const QRegularExpression CellmlKeywordsRegEx = QRegularExpression(
+        "\\b("
+             // Miscellaneous
 
-    styleTextCurrent(pStart, position, pText.left(pPosition), pParameterBlock);
+            "base|encapsulation|containment"
+        ")\\b");
 
-    // Now, check where the string ends, if anywhere
+    static const QRegularExpression ParameterKeywordsRegEx = QRegularExpression(
+        "\\b("
+            // Unit keywords
 
-    int nextStart = -1;
-    int stringEndPosition = pText.indexOf(StringString, pPosition+StringLength);
+            "pref|expo|mult|off|"
 
-    if (stringEndPosition != -1) {
-        // The string ends somewhere, so compare its line number against that of
-        // where it started
+            // Variable keywords
 
-        int stringStartLineNumber, stringStartColumnNumber;
-        int stringEndLineNumber, stringEndColumnNumber;
+            "init|pub|priv"
+        ")\\b");
 
-        editor()->lineIndexFromPosition(position,
-                                        &stringStartLineNumber, &stringStartColumnNumber);
-        editor()->lineIndexFromPosition(pStart+stringEndPosition,
-                                        &stringEndLineNumber, &stringEndColumnNumber);
+    static const QRegularExpression ParameterCellmlKeywordsRegEx = QRegularExpression(
+        "\\b("
+            // Unit prefixes
 
-        if (stringStartLineNumber == stringEndLineNumber) {
-            // The string starts and ends on the same line, so get ready to
-            // style everything that is after the string
+            "yotta|zetta|exa|peta|tera|giga|mega|kilo|hecto|deka|deci|"
+            "centi|milli|micro|nano|pico|femto|atto|zepto|yocto|"
 
-            nextStart = pStart+stringEndPosition+StringLength;
-        } else {
-            // The string starts and ends on a different line, so consider that
-            // we couldn't find the end of the string
+            // Public/private interfaces
 
-            stringEndPosition = -1;
-        }
-    }
+            "in|out|none"
+        ")\\b");
 
-    if (stringEndPosition == -1) {
-        // The string doesn't end or we found the beginning of another string on
-        // a different line, so get ready to style everything that is after the
-        // end of the line, if anything, on which the string started
+    static const QRegularExpression SiUnitKeywordsRegEx = QRegularExpression(
+        "\\b("
+            // Standard units
 
-        int eolPosition = pText.indexOf(mEolString, pPosition+StringLength);
+            "ampere|becquerel|candela|celsius|coulomb|dimensionless|"
+            "farad|gram|gray|henry|hertz|joule|katal|kelvin|kilogram|"
+            "liter|litre|lumen|lux|meter|metre|mole|newton|ohm|pascal|"
+            "radian|second|siemens|sievert|steradian|tesla|volt|watt|"
+            "weber"
+        ")\\b");
 
-        if (eolPosition != -1) {
-            nextStart = pStart+eolPosition+mEolString.length();
-        }
+    if (pParameterBlock) {
+        styleCodeRegEx(offset, code, ParameterKeywordsRegEx, Style::ParameterKeyword);
+        styleCodeRegEx(offset, code, ParameterCellmlKeywordsRegEx, Style::ParameterCellmlKeyword);
+    } else {
+        styleCodeRegEx(offset, code, KeywordsRegEx, Style::Keyword);
+        styleCodeRegEx(offset, code, CellmlKeywordsRegEx, Style::CellmlKeyword);
     }
 
-    // Style the string itself
+    styleCodeRegEx(offset, code, SiUnitKeywordsRegEx,
+                   pParameterBlock?
+                       Style::ParameterCellmlKeyword:
+                       Style::CellmlKeyword);
 
-    applyStyle(position,
-               (nextStart == -1)?
-                   pEnd:
-                   nextStart,
-               pParameterBlock?
-                   Style::ParameterString:
-                   Style::String);
+    // Check whether the given code contains some numbers
 
-    // Style whatever is after the string
-
-    if (nextStart != -1) {
-        styleText(nextStart, pEnd, pText.right(pEnd-nextStart), pParameterBlock);
-    }
+    styleCodeNumber(pStart, offset, code, pParameterBlock?
+                                              Style::ParameterNumber:
+                                              Style::Number);
 }
 
 //==============================================================================
 
-void CellmlTextViewLexer::styleTextRegEx(int pStart, const QByteArray &pText,
+void CellmlTextViewLexer::styleCodeRegEx(int pOffset, const QString &pCode,
                                          const QRegularExpression &pRegEx,
                                          Style pStyle)
 {
-    // Style the given text using the given regular expression
+    // Style the given code using the given regular expression
 
-    QRegularExpressionMatchIterator regExMatchIter = pRegEx.globalMatch(pText);
+    QRegularExpressionMatchIterator regExMatchIter = pRegEx.globalMatch(pCode);
 
     while (regExMatchIter.hasNext()) {
         // We have a match, so style it
 
         QRegularExpressionMatch regExMatch = regExMatchIter.next();
-        int capturedStart = regExMatch.capturedStart();
 
-        applyStyle(pStart+capturedStart, pStart+capturedStart+regExMatch.capturedLength(), pStyle);
+        memset(mStyles.data()+pOffset+regExMatch.capturedStart(),
+               char(pStyle), size_t(regExMatch.capturedLength()));
     }
 }
 
 //==============================================================================
 
-void CellmlTextViewLexer::styleTextNumber(int pStart, const QByteArray &pText,
-                                          Style pStyle)
+void CellmlTextViewLexer::styleCodeNumber(int pStart, int pOffset,
+                                          const QString &pCode, Style pStyle)
 {
-    // Style the given text using the number regular expression
+    // Style the given code using the number regular expression
 
     static const QRegularExpression NumberRegEx = QRegularExpression(R"((\d+(\.\d*)?|\.\d+)([eE][+-]?\d*)?)");
     // Note: this regular expression is not aimed at catching valid numbers, but
     //       at catching something that could become a valid number (e.g. we
     //       want to be able to catch "123e")...
 
-    QRegularExpressionMatchIterator regExMatchIter = NumberRegEx.globalMatch(pText);
+    QRegularExpressionMatchIterator regExMatchIter = NumberRegEx.globalMatch(pCode);
 
     while (regExMatchIter.hasNext()) {
         // We have a match, so style it, but only if:
@@ -777,10 +531,10 @@ void CellmlTextViewLexer::styleTextNumber(int pStart, const QByteArray &pText,
         int nextCharPos = prevCharPos+capturedLength+1;
 
         char prevChar = (prevCharPos >= 0)?
-                            mFullText[prevCharPos]:
+                            mText[prevCharPos]:
                             0;
-        char nextChar = (nextCharPos < mFullText.length())?
-                            mFullText[nextCharPos]:
+        char nextChar = (nextCharPos < mTextLength)?
+                            mText[nextCharPos]:
                             0;
 
         if (   (    (prevChar  <  48)
@@ -793,50 +547,14 @@ void CellmlTextViewLexer::styleTextNumber(int pStart, const QByteArray &pText,
                 || ((nextChar  >  90) &&  (nextChar  <  95))
                 ||  (nextChar ==  96)
                 ||  (nextChar  > 122))) {
-            applyStyle(pStart+capturedStart, pStart+capturedStart+capturedLength, pStyle);
+            memset(mStyles.data()+pOffset+capturedStart,
+                   char(pStyle), size_t(capturedLength));
         }
     }
 }
 
 //==============================================================================
 
-bool CellmlTextViewLexer::validString(int pFrom, int pTo, Style pStyle) const
-{
-    // Check whether the string, which range is given, is valid, i.e. is either
-    // of the default or given style
-
-    for (int i = pFrom; i < pTo; ++i) {
-        Style style = Style(editor()->SendScintilla(QsciScintilla::SCI_GETSTYLEAT, i));
-
-        if ((style != Style::Default) && (style != pStyle)) {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-//==============================================================================
-
-int CellmlTextViewLexer::findString(const QByteArray &pString, int pFrom,
-                                    Style pStyle, bool pForward)
-{
-    // Find forward/backward the given string starting from the given position
-
-    int stringLength = pString.length();
-    int res = pForward?pFrom:pFrom+1;
-
-    do {
-        pFrom = pForward?res+stringLength:res-1;
-
-        res = pForward?mFullText.indexOf(pString, pFrom):mFullText.lastIndexOf(pString, pFrom);
-    } while ((res != -1) && !validString(res, res+stringLength, pStyle));
-
-    return res;
-}
-
-//==============================================================================
-
 } // namespace CellMLTextView
 } // namespace OpenCOR
 
@@ -72,31 +72,20 @@ public:
     void styleText(int pStart, int pEnd) override;
 
 private:
-    QByteArray mFullText;
-    QByteArray mEolString;
-
-    void applyStyle(int pStart, int pEnd, Style pStyle);
-    void styleText(int pStart, int pEnd, const QByteArray &pText,
-                   bool pParameterBlock);
-    void styleTextCurrent(int pStart, int pEnd, const QByteArray &pText,
-                          bool pParameterBlock);
-    void styleTextPreviousMultilineComment(int pPosition, int pStart, int pEnd,
-                                           const QByteArray &pText,
-                                           bool pParameterBlock);
-    void styleTextPreviousParameterBlock(int pPosition, int pStart, int pEnd,
-                                         const QByteArray &pText,
-                                         bool pParameterBlock);
-    void styleTextString(int pPosition, int pStart, int pEnd,
-                         const QByteArray &pText, bool pParameterBlock);
-    void styleTextRegEx(int pStart, const QByteArray &pText,
+    const char *mText = nullptr;
+    int mTextLength = 0;
+
+    QByteArray mStyles;
+
+    void flushStyles(int pStart);
+
+    int styleLine(int pStart, int pEnd, int pState);
+    void styleCode(int pStart, int pEnd, bool pParameterBlock);
+    void styleCodeRegEx(int pOffset, const QString &pCode,
                         const QRegularExpression &pRegEx, Style pStyle);
-    void styleTextNumber(int pStart, const QByteArray &pText,
+    void styleCodeNumber(int pStart, int pOffset, const QString &pCode,
                          Style pStyle);
 
-    bool validString(int pFrom, int pTo, Style pStyle) const;
-    int findString(const QByteArray &pString, int pFrom, Style pStyle,
-                   bool pForward = true);
-
 signals:
     void done();
 };
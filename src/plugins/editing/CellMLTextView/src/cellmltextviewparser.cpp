@@ -85,11 +85,15 @@ QString CellmlTextViewParserMessage::message() const
 //==============================================================================
 
 bool CellmlTextViewParser::execute(const QString &pCellmlText,
-                                   CellMLSupport::CellmlFile::Version pCellmlVersion)
+                                   CellMLSupport::CellmlFile::Version pCellmlVersion,
+                                   const QAtomicInt *pCanceled)
 {
     // Get ready for the parsing of a model definition
+    // Note: pCanceled is optional and is used to stop our parsing, in case it
+    //       is done in a background thread and is not needed anymore (e.g.
+    //       because the CellML Text has been modified in the meantime)...
 
-    initialize(pCellmlText);
+    initialize(pCellmlText, pCanceled);
 
     // Expect "def"
 
@@ -320,12 +324,15 @@ CellmlTextViewParser::Statement CellmlTextViewParser::statement() const
 
 //==============================================================================
 
-void CellmlTextViewParser::initialize(const QString &pCellmlText)
+void CellmlTextViewParser::initialize(const QString &pCellmlText,
+                                      const QAtomicInt *pCanceled)
 {
     // Initialize ourselves with the given CellML Text string
 
     mScanner.setText(pCellmlText);
 
+    mCanceled = pCanceled;
+
     mCellmlVersion = CellMLSupport::CellmlFile::Version::Cellml_1_0;
 
     mDomDocument = QDomDocument();
@@ -339,6 +346,15 @@ void CellmlTextViewParser::initialize(const QString &pCellmlText)
 
 //==============================================================================
 
+bool CellmlTextViewParser::isCanceled() const
+{
+    // Return whether our parsing has been canceled
+
+    return (mCanceled != nullptr) && (mCanceled->loadAcquire() != 0);
+}
+
+//==============================================================================
+
 void CellmlTextViewParser::addUnexpectedTokenErrorMessage(const QString &pExpectedString,
                                                           const QString &pFoundString)
 {
@@ -1101,6 +1117,12 @@ bool CellmlTextViewParser::parseModelDefinition(QDomNode &pDomNode)
     while (tokenType(pDomNode, tr("'%1' or '%2'").arg("def",
                                                       "enddef"),
                      Tokens)) {
+        // Stop here if our parsing has been canceled
+
+        if (isCanceled()) {
+            return false;
+        }
+
         if (mScanner.token() == CellmlTextViewScanner::Token::Def) {
             // Expect a model definition
 
@@ -1703,6 +1725,12 @@ bool CellmlTextViewParser::parseComponentDefinition(QDomNode &pDomNode)
                                                                        "ode",
                                                                        "enddef"),
                      Tokens)) {
+        // Stop here if our parsing has been canceled
+
+        if (isCanceled()) {
+            return false;
+        }
+
         // Move trailing comment(s), if any, from mathElement to
         // componentElement, if needed
         // Note: indeed since comments we come across while looking for anything
@@ -30,6 +30,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QAtomicInt>
 #include <QDomDocument>
 #include <QList>
 #include <QString>
@@ -97,7 +98,8 @@ public:
     };
 
     bool execute(const QString &pCellmlText,
-                 CellMLSupport::CellmlFile::Version pCellmlVersion);
+                 CellMLSupport::CellmlFile::Version pCellmlVersion,
+                 const QAtomicInt *pCanceled = nullptr);
     bool execute(const QString &pCellmlText, bool pFullParsing = true);
 
     CellMLSupport::CellmlFile::Version cellmlVersion() const;
@@ -123,7 +125,12 @@ private:
 
     Statement mStatement = Statement::Unknown;
 
-    void initialize(const QString &pCellmlText);
+    const QAtomicInt *mCanceled = nullptr;
+
+    void initialize(const QString &pCellmlText,
+                    const QAtomicInt *pCanceled = nullptr);
+
+    bool isCanceled() const;
 
     void addUnexpectedTokenErrorMessage(const QString &pExpectedString,
                                         const QString &pFoundString);
@@ -46,6 +46,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 #include <QMainWindow>
 #include <QSettings>
 #include <QTimer>
+#include <QtConcurrent/QtConcurrent>
 
 //==============================================================================
 
@@ -60,6 +61,111 @@ namespace CellMLTextView {
 
 //==============================================================================
 
+CellmlTextViewWidgetParsing::CellmlTextViewWidgetParsing(const QString &pFileName,
+                                                         const QString &pContents,
+                                                         CellMLSupport::CellmlFile::Version pCellmlVersion) :
+    mFileName(pFileName),
+    mContents(pContents),
+    mRequiredCellmlVersion(pCellmlVersion)
+{
+}
+
+//==============================================================================
+
+void CellmlTextViewWidgetParsing::execute(const QAtomicInt *pCanceled)
+{
+    // Parse our contents using our own parser, so that we can be executed in a
+    // background thread
+    // Note: we are only done if our parsing has not been canceled, since the
+    //       result of a canceled parsing is incomplete...
+
+    CellmlTextViewParser parser;
+
+    mSuccessful = parser.execute(mContents, mRequiredCellmlVersion, pCanceled);
+    mDone = (pCanceled == nullptr) || (pCanceled->loadAcquire() == 0);
+
+    mCellmlVersion = parser.cellmlVersion();
+    mDomDocument = parser.domDocument();
+    mMessages = parser.messages();
+}
+
+//==============================================================================
+
+bool CellmlTextViewWidgetParsing::isFor(const QString &pContents,
+                                        CellMLSupport::CellmlFile::Version pCellmlVersion) const
+{
+    // Return whether we are the (complete) parsing of the given contents
+
+    return    mDone
+           && (pCellmlVersion == mRequiredCellmlVersion)
+           && (pContents == mContents);
+}
+
+//==============================================================================
+
+QString CellmlTextViewWidgetParsing::fileName() const
+{
+    // Return our file name
+
+    return mFileName;
+}
+
+//==============================================================================
+
+QString CellmlTextViewWidgetParsing::contents() const
+{
+    // Return our contents
+
+    return mContents;
+}
+
+//==============================================================================
+
+bool CellmlTextViewWidgetParsing::isDone() const
+{
+    // Return whether we are done
+
+    return mDone;
+}
+
+//==============================================================================
+
+bool CellmlTextViewWidgetParsing::isSuccessful() const
+{
+    // Return whether our parsing was successful
+
+    return mSuccessful;
+}
+
+//==============================================================================
+
+CellMLSupport::CellmlFile::Version CellmlTextViewWidgetParsing::cellmlVersion() const
+{
+    // Return the CellML version needed by our contents
+
+    return mCellmlVersion;
+}
+
+//==============================================================================
+
+QDomDocument CellmlTextViewWidgetParsing::domDocument() const
+{
+    // Return our DOM document
+
+    return mDomDocument;
+}
+
+//==============================================================================
+
+CellmlTextViewParserMessages CellmlTextViewWidgetParsing::messages() const
+{
+    // Return our messages
+
+    return mMessages;
+}
+
+//==============================================================================
+
 CellmlTextViewWidgetData::CellmlTextViewWidgetData(CellmlTextViewWidgetEditingWidget *pEditingWidget,
                                                    const QString &pSha1,
                                                    bool pValid,
@@ -203,6 +309,60 @@ void CellmlTextViewWidgetData::setConvertedFileContents(const QString &pConverte
 
 //==============================================================================
 
+CellmlTextViewWidgetParsing CellmlTextViewWidgetData::parsing() const
+{
+    // Return our (latest) parsing
+
+    return mParsing;
+}
+
+//==============================================================================
+
+void CellmlTextViewWidgetData::setParsing(const CellmlTextViewWidgetParsing &pParsing)
+{
+    // Set our (latest) parsing
+
+    mParsing = pParsing;
+}
+
+//==============================================================================
+
+bool CellmlTextViewWidgetData::isValidated() const
+{
+    // Return whether we have been validated
+
+    return mValidated;
+}
+
+//==============================================================================
+
+void CellmlTextViewWidgetData::setValidated(bool pValidated)
+{
+    // Set whether we have been validated
+
+    mValidated = pValidated;
+}
+
+//==============================================================================
+
+bool CellmlTextViewWidgetData::onlyErrors() const
+{
+    // Return whether we only report errors when validated
+
+    return mOnlyErrors;
+}
+
+//==============================================================================
+
+void CellmlTextViewWidgetData::setOnlyErrors(bool pOnlyErrors)
+{
+    // Set whether we only report errors when validated
+
+    mOnlyErrors = pOnlyErrors;
+}
+
+//==============================================================================
+
 CellmlTextViewWidgetEditingWidget::CellmlTextViewWidgetEditingWidget(const QString &pContents,
                                                                      bool pReadOnly,
                                                                      QsciLexer *pLexer,
@@ -417,6 +577,44 @@ CellmlTextViewWidget::CellmlTextViewWidget(QWidget *pParent) :
 
     connect(&mMathmlConverter, &Core::MathmlConverter::done,
             this, &CellmlTextViewWidget::mathmlConversionDone);
+
+    // Create a timer to update our viewer once the user has stopped moving
+    // around or typing for a wee bit
+
+    mUpdateViewerTimer = new QTimer(this);
+
+    mUpdateViewerTimer->setInterval(50);
+    mUpdateViewerTimer->setSingleShot(true);
+
+    connect(mUpdateViewerTimer, &QTimer::timeout,
+            this, &CellmlTextViewWidget::updateViewer);
+
+    // Create a timer to parse, in a background thread, the contents of our
+    // current editor once the user has stopped typing for a bit, and create a
+    // connection to retrieve the result of that parsing
+
+    mParsingTimer = new QTimer(this);
+
+    mParsingTimer->setInterval(500);
+    mParsingTimer->setSingleShot(true);
+
+    connect(mParsingTimer, &QTimer::timeout,
+            this, &CellmlTextViewWidget::startParsing);
+
+    connect(&mParsingWatcher, &QFutureWatcher<CellmlTextViewWidgetParsing>::finished,
+            this, &CellmlTextViewWidget::parsingFinished);
+}
+
+//==============================================================================
+
+CellmlTextViewWidget::~CellmlTextViewWidget()
+{
+    // Cancel and wait for our background parsing, if any, since it relies on
+    // mParsingCanceled
+
+    mParsingCanceled.storeRelease(1);
+
+    mParsingWatcher.waitForFinished();
 }
 
 //==============================================================================
@@ -517,9 +715,15 @@ void CellmlTextViewWidget::initialize(const QString &pFileName, bool pUpdate)
             //       be done...
 
             connect(lexer, &CellmlTextViewLexer::done,
-                    this, &CellmlTextViewWidget::updateViewer);
+                    this, &CellmlTextViewWidget::delayedUpdateViewer);
             connect(editingWidget->editorWidget(), &EditorWidget::EditorWidget::cursorPositionChanged,
-                    this, &CellmlTextViewWidget::updateViewer);
+                    this, &CellmlTextViewWidget::delayedUpdateViewer);
+
+            // Parse our contents in the background whenever the text has
+            // changed
+
+            connect(editingWidget->editorWidget(), &EditorWidget::EditorWidget::textChanged,
+                    mParsingTimer, QOverload<>::of(&QTimer::start));
         } else {
             // The conversion wasn't successful, so make the editor read-only
             // (since its contents is that of the file itself) and add a couple
@@ -804,31 +1008,36 @@ bool CellmlTextViewWidget::saveFile(const QString &pOldFileName,
             // and, if so, ask the user whether it's OK to use that higher
             // version
 
+            CellmlTextViewWidgetParsing parsing = data->parsing();
+            CellMLSupport::CellmlFile::Version cellmlVersion = parsing.cellmlVersion();
+
             if (   !Core::FileManager::instance()->isNew(pOldFileName)
                 &&  (data->cellmlVersion() != CellMLSupport::CellmlFile::Version::Unknown)
-                &&  (mParser.cellmlVersion() > data->cellmlVersion())
+                &&  (cellmlVersion > data->cellmlVersion())
                 &&  (Core::questionMessageBox(tr("Save File"),
                                              tr("<strong>%1</strong> requires features that are not present in %2 and should therefore be saved as a %3 file. Do you want to proceed?").arg(QDir::toNativeSeparators(pNewFileName),
                                                                                                                                                                                             CellMLSupport::CellmlFile::versionAsString(data->cellmlVersion()),
-                                                                                                                                                                                            CellMLSupport::CellmlFile::versionAsString(mParser.cellmlVersion()))) == QMessageBox::No)) {
+                                                                                                                                                                                            CellMLSupport::CellmlFile::versionAsString(cellmlVersion))) == QMessageBox::No)) {
                 pNeedFeedback = false;
 
                 return false;
             }
 
-            data->setCellmlVersion(mParser.cellmlVersion());
+            data->setCellmlVersion(cellmlVersion);
 
             // Add the documentation, if any, to our model element
+            // Note: our parsing may be reused, so we work on a copy of its DOM
+            //       document...
+
+            QDomDocument domDocument = parsing.domDocument().cloneNode().toDocument();
+            QDomElement domElement = domDocument.documentElement();
 
             if (!data->documentationNode().isNull()) {
-                mParser.modelElement().appendChild(data->documentationNode().cloneNode());
+                domElement.appendChild(data->documentationNode().cloneNode());
             }
 
             // Add the metadata to our DOM document
 
-            QDomDocument domDocument = mParser.domDocument();
-            QDomElement domElement = domDocument.documentElement();
-
             for (QDomElement childElement = data->rdfNodes().firstChildElement();
                  !childElement.isNull(); childElement = childElement.nextSiblingElement()) {
                 domElement.appendChild(childElement.cloneNode());
@@ -900,7 +1109,7 @@ void CellmlTextViewWidget::reformat(const QString &pFileName)
 
         editor->cursorPosition(line, column);
 
-        mConverter.execute(Core::serialiseDomDocument(mParser.domDocument()));
+        mConverter.execute(Core::serialiseDomDocument(data->parsing().domDocument()));
 
         editor->setContents(mConverter.output(), false);
         editor->setCursorPosition(line, column);
@@ -931,6 +1140,44 @@ bool CellmlTextViewWidget::validate(const QString &pFileName, QString &pExtra)
 
 //==============================================================================
 
+CellmlTextViewWidgetParsing CellmlTextViewWidget::parseInBackground(CellmlTextViewWidgetParsing pParsing,
+                                                                     const QAtomicInt *pCanceled)
+{
+    // Parse the given contents
+    // Note: this method is executed in a background thread...
+
+    pParsing.execute(pCanceled);
+
+    return pParsing;
+}
+
+//==============================================================================
+
+void CellmlTextViewWidget::updateEditorList(EditorWidget::EditorListWidget *pEditorList,
+                                            const CellmlTextViewWidgetParsing &pParsing,
+                                            bool pOnlyErrors)
+{
+    // Replace the contents of the given editor list with the messages that were
+    // generated by the given parsing
+
+    pEditorList->clear();
+
+    const CellmlTextViewParserMessages messages = pParsing.messages();
+
+    for (const auto &message : messages) {
+        if (   !pOnlyErrors
+            || (message.type() == CellmlTextViewParserMessage::Type::Error)) {
+            pEditorList->addItem((message.type() == CellmlTextViewParserMessage::Type::Error)?
+                                     EditorWidget::EditorListItem::Type::Error:
+                                     EditorWidget::EditorListItem::Type::Warning,
+                                 message.line(), message.column(),
+                                 message.message());
+        }
+    }
+}
+
+//==============================================================================
+
 bool CellmlTextViewWidget::parse(const QString &pFileName, QString &pExtra,
                                  bool pOnlyErrors)
 {
@@ -939,28 +1186,31 @@ bool CellmlTextViewWidget::parse(const QString &pFileName, QString &pExtra,
     CellmlTextViewWidgetData *data = mData.value(pFileName);
 
     if (data != nullptr) {
+        // Reuse our latest parsing, if it is for our current contents, or parse
+        // our current contents
+        // Note: our latest parsing is normally the result of a background
+        //       parsing, meaning that, unless the user has just been typing, we
+        //       don't need to parse anything here...
+
         CellmlTextViewWidgetEditingWidget *editingWidget = data->editingWidget();
+        QString contents = editingWidget->editorWidget()->contents();
+        CellmlTextViewWidgetParsing parsing = data->parsing();
+
+        if (!parsing.isFor(contents, data->cellmlVersion())) {
+            parsing = CellmlTextViewWidgetParsing(pFileName, contents, data->cellmlVersion());
 
-        editingWidget->editorListWidget()->clear();
+            parsing.execute();
 
-        bool res = mParser.execute(editingWidget->editorWidget()->contents(),
-                                   data->cellmlVersion());
+            data->setParsing(parsing);
+        }
+
+        data->setValidated(true);
+        data->setOnlyErrors(pOnlyErrors);
 
         // Add the messages that were generated by the parser, if any, and
         // select the first one of them
 
-        const CellmlTextViewParserMessages messages = mParser.messages();
-
-        for (const auto &message : messages) {
-            if (   !pOnlyErrors
-                || (message.type() == CellmlTextViewParserMessage::Type::Error)) {
-                editingWidget->editorListWidget()->addItem((message.type() == CellmlTextViewParserMessage::Type::Error)?
-                                                               EditorWidget::EditorListItem::Type::Error:
-                                                               EditorWidget::EditorListItem::Type::Warning,
-                                                           message.line(), message.column(),
-                                                           message.message());
-            }
-        }
+        updateEditorList(editingWidget->editorListWidget(), parsing, pOnlyErrors);
 
         editingWidget->editorListWidget()->selectFirstItem();
 
@@ -972,7 +1222,7 @@ bool CellmlTextViewWidget::parse(const QString &pFileName, QString &pExtra,
             pExtra = tr(R"(the <a href="https://github.com/cellmlapi/cellml-api/">CellML validation service</a> cannot be used in this view, so only validation against the <a href="https://opencor.ws/user/plugins/editing/CellMLTextView.html#CellML Text format">CellML Text format</a> was performed. For full CellML validation, you might want to use the Raw CellML view instead.)");
         }
 
-        return res;
+        return parsing.isSuccessful();
     }
 
     return false;
@@ -1266,6 +1516,98 @@ void CellmlTextViewWidget::updateViewer()
 
 //==============================================================================
 
+void CellmlTextViewWidget::delayedUpdateViewer()
+{
+    // (Re)start our timer to update our viewer
+    // Note: this allows us to avoid parsing the statement around our current
+    //       position, and converting it to Presentation MathML, every single
+    //       time the user moves around or types something...
+
+    mUpdateViewerTimer->start();
+}
+
+//==============================================================================
+
+void CellmlTextViewWidget::startParsing()
+{
+    // Make sure that we still have an editing widget (i.e. it hasn't been
+    // closed since our timer was started)
+
+    if (mEditingWidget == nullptr) {
+        return;
+    }
+
+    // Make sure that we are not already parsing something and, if we are, then
+    // cancel it and try again once it's finished
+
+    if (mParsingWatcher.isRunning()) {
+        mParsingCanceled.storeRelease(1);
+
+        mParsingNeeded = true;
+
+        return;
+    }
+
+    // Retrieve the file associated with our current editing widget and parse
+    // its contents in a background thread, unless we already know about them
+
+    for (auto data = mData.constBegin(), dataEnd = mData.constEnd();
+         data != dataEnd; ++data) {
+        if (data.value()->editingWidget() == mEditingWidget) {
+            QString contents = mEditingWidget->editorWidget()->contents();
+
+            if (!data.value()->parsing().isFor(contents, data.value()->cellmlVersion())) {
+                mParsingCanceled.storeRelease(0);
+
+                mParsingWatcher.setFuture(QtConcurrent::run(&CellmlTextViewWidget::parseInBackground,
+                                                            CellmlTextViewWidgetParsing(data.key(), contents, data.value()->cellmlVersion()),
+                                                            &mParsingCanceled));
+            }
+
+            break;
+        }
+    }
+}
+
+//==============================================================================
+
+void CellmlTextViewWidget::parsingFinished()
+{
+    // Keep track of our background parsing, but only if it has been done for
+    // the current contents of its file
+
+    CellmlTextViewWidgetParsing parsing = mParsingWatcher.result();
+    CellmlTextViewWidgetData *data = mData.value(parsing.fileName());
+
+    if (   (data != nullptr)
+        &&  parsing.isFor(data->editingWidget()->editorWidget()->contents(),
+                          data->cellmlVersion())) {
+        data->setParsing(parsing);
+
+        // Update our editor list with the result of our parsing, if we have
+        // already been validated, and in the same way as when we were
+        // validated (e.g. only errors if we were reformatted)
+        // Note: we don't select the first item of our editor list since it
+        //       would move the cursor while the user is typing...
+
+        if (data->isValidated()) {
+            updateEditorList(data->editingWidget()->editorListWidget(), parsing,
+                             data->onlyErrors());
+        }
+    }
+
+    // Parse our current contents, if needed (i.e. if our parsing was canceled
+    // while running)
+
+    if (mParsingNeeded) {
+        mParsingNeeded = false;
+
+        startParsing();
+    }
+}
+
+//==============================================================================
+
 void CellmlTextViewWidget::selectFirstItemInEditorList()
 {
     // Rely on the contents of mEditorLists to select the first item of the
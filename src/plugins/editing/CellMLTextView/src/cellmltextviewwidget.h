@@ -35,10 +35,16 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QAtomicInt>
+#include <QFutureWatcher>
 #include <QMap>
 
 //==============================================================================
 
+class QTimer;
+
+//==============================================================================
+
 namespace OpenCOR {
 
 //==============================================================================
@@ -64,6 +70,44 @@ class CellmlTextViewWidgetEditingWidget;
 
 //==============================================================================
 
+class CellmlTextViewWidgetParsing
+{
+public:
+    CellmlTextViewWidgetParsing() = default;
+    explicit CellmlTextViewWidgetParsing(const QString &pFileName,
+                                         const QString &pContents,
+                                         CellMLSupport::CellmlFile::Version pCellmlVersion);
+
+    void execute(const QAtomicInt *pCanceled = nullptr);
+
+    bool isFor(const QString &pContents,
+               CellMLSupport::CellmlFile::Version pCellmlVersion) const;
+
+    QString fileName() const;
+    QString contents() const;
+
+    bool isDone() const;
+    bool isSuccessful() const;
+
+    CellMLSupport::CellmlFile::Version cellmlVersion() const;
+    QDomDocument domDocument() const;
+    CellmlTextViewParserMessages messages() const;
+
+private:
+    QString mFileName;
+    QString mContents;
+    CellMLSupport::CellmlFile::Version mRequiredCellmlVersion = CellMLSupport::CellmlFile::Version::Unknown;
+
+    bool mDone = false;
+    bool mSuccessful = false;
+
+    CellMLSupport::CellmlFile::Version mCellmlVersion = CellMLSupport::CellmlFile::Version::Unknown;
+    QDomDocument mDomDocument;
+    CellmlTextViewParserMessages mMessages;
+};
+
+//==============================================================================
+
 class CellmlTextViewWidgetData
 {
 public:
@@ -95,6 +139,15 @@ public:
     QString convertedFileContents() const;
     void setConvertedFileContents(const QString &pConvertedFileContents);
 
+    CellmlTextViewWidgetParsing parsing() const;
+    void setParsing(const CellmlTextViewWidgetParsing &pParsing);
+
+    bool isValidated() const;
+    void setValidated(bool pValidated);
+
+    bool onlyErrors() const;
+    void setOnlyErrors(bool pOnlyErrors);
+
 private:
     CellmlTextViewWidgetEditingWidget *mEditingWidget;
     QString mSha1;
@@ -104,6 +157,9 @@ private:
     QDomDocument mRdfNodes;
     QString mFileContents;
     QString mConvertedFileContents;
+    CellmlTextViewWidgetParsing mParsing;
+    bool mValidated = false;
+    bool mOnlyErrors = false;
 };
 
 //==============================================================================
@@ -133,6 +189,7 @@ class CellmlTextViewWidget : public Core::ViewWidget
 
 public:
     explicit CellmlTextViewWidget(QWidget *pParent);
+    ~CellmlTextViewWidget() override;
 
     void loadSettings(QSettings &pSettings) override;
     void saveSettings(QSettings &pSettings) const override;
@@ -181,6 +238,20 @@ private:
 
     QString mContentMathmlEquation;
 
+    QTimer *mUpdateViewerTimer;
+
+    QTimer *mParsingTimer;
+    QFutureWatcher<CellmlTextViewWidgetParsing> mParsingWatcher;
+    QAtomicInt mParsingCanceled = 0;
+    bool mParsingNeeded = false;
+
+    static CellmlTextViewWidgetParsing parseInBackground(CellmlTextViewWidgetParsing pParsing,
+                                                         const QAtomicInt *pCanceled);
+
+    void updateEditorList(EditorWidget::EditorListWidget *pEditorList,
+                          const CellmlTextViewWidgetParsing &pParsing,
+                          bool pOnlyErrors);
+
     bool parse(const QString &pFileName, QString &pExtra, bool pOnlyErrors);
     bool parse(const QString &pFileName, QString &pExtra);
     bool parse(const QString &pFileName, bool pOnlyErrors = false);
@@ -194,6 +265,10 @@ private:
 
 private slots:
     void updateViewer();
+    void delayedUpdateViewer();
+
+    void startParsing();
+    void parsingFinished();
 
     void selectFirstItemInEditorList();
 
@@ -0,0 +1,150 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// CellML Text view lexer tests
+//==============================================================================
+
+#include "cellmltextviewlexer.h"
+#include "lexertests.h"
+
+//==============================================================================
+
+#include <QtTest/QtTest>
+
+//==============================================================================
+
+#include "qscintillabegin.h"
+    #include "Qsci/qsciscintilla.h"
+#include "qscintillaend.h"
+
+//==============================================================================
+
+static const QString Text = "def model my_model as\n"
+                            "    def comp my_component as\n"
+                            "        var x: dimensionless {init: 1};\n"
+                            "        x = 2{dimensionless}*x;\n"
+                            "    enddef;\n"
+                            "enddef;\n";
+
+//==============================================================================
+
+static QByteArray styles(QsciScintilla *pEditor)
+{
+    // Style whatever needs (re)styling in the given editor, i.e. from where its
+    // styling was last invalidated, and return the style of each of its
+    // characters
+
+    pEditor->SendScintilla(QsciScintillaBase::SCI_COLOURISE,
+                           ulong(pEditor->SendScintilla(QsciScintillaBase::SCI_GETENDSTYLED)),
+                           -1L);
+
+    QByteArray res;
+
+    for (int i = 0, iMax = int(pEditor->SendScintilla(QsciScintillaBase::SCI_GETLENGTH)); i < iMax; ++i) {
+        res += char(pEditor->SendScintilla(QsciScintillaBase::SCI_GETSTYLEAT, i));
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+static QByteArray referenceStyles(const QString &pText)
+{
+    // Return the styles of the given text, as styled from scratch
+
+    QsciScintilla editor;
+
+    editor.setLexer(new OpenCOR::CellMLTextView::CellmlTextViewLexer(&editor));
+    editor.setText(pText);
+
+    return styles(&editor);
+}
+
+//==============================================================================
+
+void LexerTests::multilineCommentTests()
+{
+    // Style our text from scratch
+
+    QsciScintilla editor;
+
+    editor.setLexer(new OpenCOR::CellMLTextView::CellmlTextViewLexer(&editor));
+    editor.setText(Text);
+
+    QByteArray originalStyles = styles(&editor);
+
+    QCOMPARE(originalStyles, referenceStyles(Text));
+    QCOMPARE(int(originalStyles[Text.indexOf("{init")]), int(OpenCOR::CellMLTextView::CellmlTextViewLexer::Style::ParameterBlock));
+
+    // Open a /* XXX */ comment at the beginning of the second line and make
+    // sure that only the text from that line was restyled and that everything
+    // from there is now a comment
+
+    int commentStart = int(editor.positionFromLineIndex(1, 0));
+
+    editor.SendScintilla(QsciScintillaBase::SCI_INSERTTEXT, ulong(commentStart), "/*");
+
+    QVERIFY(editor.SendScintilla(QsciScintillaBase::SCI_GETENDSTYLED) <= commentStart);
+    QVERIFY(editor.SendScintilla(QsciScintillaBase::SCI_GETENDSTYLED) > 0);
+
+    QByteArray commentedStyles = styles(&editor);
+
+    QCOMPARE(commentedStyles, referenceStyles(editor.text()));
+    QCOMPARE(commentedStyles.left(commentStart), originalStyles.left(commentStart));
+
+    for (int i = commentStart, iMax = commentedStyles.length(); i < iMax; ++i) {
+        QCOMPARE(int(commentedStyles[i]), int(OpenCOR::CellMLTextView::CellmlTextViewLexer::Style::MultilineComment));
+    }
+
+    // Close our comment at the end of the fourth line and make sure that the
+    // lines that follow it are back to their original styles
+
+    int commentEnd = int(editor.SendScintilla(QsciScintillaBase::SCI_GETLINEENDPOSITION, 3));
+
+    editor.SendScintilla(QsciScintillaBase::SCI_INSERTTEXT, ulong(commentEnd), "*/");
+
+    QByteArray closedCommentStyles = styles(&editor);
+    int afterCommentEnd = commentEnd+2;
+
+    QCOMPARE(closedCommentStyles, referenceStyles(editor.text()));
+    QCOMPARE(int(closedCommentStyles[afterCommentEnd-1]), int(OpenCOR::CellMLTextView::CellmlTextViewLexer::Style::MultilineComment));
+    QCOMPARE(closedCommentStyles.mid(afterCommentEnd), originalStyles.mid(afterCommentEnd-4));
+
+    // Remove the start of our comment, which leaves a lone */, and then its
+    // end, and make sure that we are back to our original styles
+
+    editor.SendScintilla(QsciScintillaBase::SCI_DELETERANGE, ulong(commentStart), 2L);
+
+    QCOMPARE(styles(&editor), referenceStyles(editor.text()));
+
+    editor.SendScintilla(QsciScintillaBase::SCI_DELETERANGE, ulong(commentEnd-2), 2L);
+
+    QCOMPARE(editor.text(), Text);
+    QCOMPARE(styles(&editor), originalStyles);
+}
+
+//==============================================================================
+
+QTEST_MAIN(LexerTests)
+
+//==============================================================================
+// End of file
+//==============================================================================
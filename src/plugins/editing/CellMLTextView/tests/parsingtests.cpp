@@ -28,6 +28,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 #include "cellmlfile.h"
 #include "cellmltextviewconverter.h"
 #include "cellmltextviewparser.h"
+#include "cellmltextviewwidget.h"
 #include "corecliutils.h"
 #include "parsingtests.h"
 
@@ -2915,6 +2916,66 @@ void ParsingTests::mapTests()
 
 //==============================================================================
 
+void ParsingTests::canceledParsingTests()
+{
+    static const QString Contents = "def model my_model as\n"
+                                    "    def comp my_component as\n"
+                                    "        var x: dimensionless {init: 1};\n"
+                                    "        ode(x, t) = -x;\n"
+                                    "    enddef;\n"
+                                    "enddef;";
+
+    // Make sure that a canceled parsing stops and fails, even though the CellML
+    // Text it was given is valid
+
+    OpenCOR::CellMLTextView::CellmlTextViewParser parser;
+    QAtomicInt canceled = 1;
+
+    QVERIFY(!parser.execute(Contents,
+                            OpenCOR::CellMLSupport::CellmlFile::Version::Cellml_1_0,
+                            &canceled));
+
+    canceled.storeRelease(0);
+
+    QVERIFY(parser.execute(Contents,
+                           OpenCOR::CellMLSupport::CellmlFile::Version::Cellml_1_0,
+                           &canceled));
+
+    // Make sure that the result of a canceled background parsing is never
+    // considered to be the parsing of its contents, so that it gets discarded
+
+    OpenCOR::CellMLTextView::CellmlTextViewWidgetParsing canceledParsing("my_model.cellml", Contents,
+                                                                         OpenCOR::CellMLSupport::CellmlFile::Version::Cellml_1_0);
+
+    canceled.storeRelease(1);
+
+    canceledParsing.execute(&canceled);
+
+    QVERIFY(!canceledParsing.isDone());
+    QVERIFY(!canceledParsing.isSuccessful());
+    QVERIFY(!canceledParsing.isFor(Contents, OpenCOR::CellMLSupport::CellmlFile::Version::Cellml_1_0));
+
+    // Make sure that the result of a complete background parsing is only
+    // considered to be the parsing of the contents and CellML version for which
+    // it was done, so that it gets discarded if the contents have been
+    // modified (or the CellML version changed) in the meantime
+
+    OpenCOR::CellMLTextView::CellmlTextViewWidgetParsing parsing("my_model.cellml", Contents,
+                                                                 OpenCOR::CellMLSupport::CellmlFile::Version::Cellml_1_0);
+
+    canceled.storeRelease(0);
+
+    parsing.execute(&canceled);
+
+    QVERIFY(parsing.isDone());
+    QVERIFY(parsing.isSuccessful());
+    QVERIFY(parsing.isFor(Contents, OpenCOR::CellMLSupport::CellmlFile::Version::Cellml_1_0));
+    QVERIFY(!parsing.isFor(Contents+"\n", OpenCOR::CellMLSupport::CellmlFile::Version::Cellml_1_0));
+    QVERIFY(!parsing.isFor(Contents, OpenCOR::CellMLSupport::CellmlFile::Version::Cellml_1_1));
+}
+
+//==============================================================================
+
 QTEST_APPLESS_MAIN(ParsingTests)
 
 //==============================================================================
@@ -49,6 +49,7 @@ private slots:
     void componentTests09();
     void groupTests();
     void mapTests();
+    void canceledParsingTests();
 };
 
 //==============================================================================
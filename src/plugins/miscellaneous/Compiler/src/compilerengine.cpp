@@ -33,9 +33,21 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+//==============================================================================
+
 #include "llvmclangbegin.h"
+    #include "llvm/Config/llvm-config.h"
     #include "llvm/ExecutionEngine/ExecutionEngine.h"
+    #include "llvm/ExecutionEngine/ObjectCache.h"
+    #include "llvm/Object/ObjectFile.h"
     #include "llvm/Support/Host.h"
+    #include "llvm/Support/MemoryBuffer.h"
     #include "llvm/Support/TargetSelect.h"
 
     #include "llvm-c/Core.h"
@@ -51,6 +63,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <memory>
 #include <string>
 
 //==============================================================================
@@ -60,6 +73,62 @@ namespace Compiler {
 
 //==============================================================================
 
+static qint64 CacheMaxSize = 128*1024*1024;   // 128 MB
+
+//==============================================================================
+
+class CompilerObjectCache : public llvm::ObjectCache
+{
+public:
+    explicit CompilerObjectCache(const QString &pFileName);
+
+    void notifyObjectCompiled(const llvm::Module *pModule,
+                              llvm::MemoryBufferRef pObject) override;
+    std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *pModule) override;
+
+private:
+    QString mFileName;
+};
+
+//==============================================================================
+
+CompilerObjectCache::CompilerObjectCache(const QString &pFileName) :
+    mFileName(pFileName)
+{
+}
+
+//==============================================================================
+
+void CompilerObjectCache::notifyObjectCompiled(const llvm::Module *pModule,
+                                               llvm::MemoryBufferRef pObject)
+{
+    Q_UNUSED(pModule)
+
+    // Keep a copy of the given object code in our cache, if possible
+    // Note: Core::writeFile() writes to a temporary file that it then renames,
+    //       so another instance of OpenCOR cannot end up reading a partially
+    //       written object file...
+
+    if (QDir().mkpath(QFileInfo(mFileName).path())) {
+        Core::writeFile(mFileName, QByteArray(pObject.getBufferStart(),
+                                              int(pObject.getBufferSize())));
+    }
+}
+
+//==============================================================================
+
+std::unique_ptr<llvm::MemoryBuffer> CompilerObjectCache::getObject(const llvm::Module *pModule)
+{
+    Q_UNUSED(pModule)
+
+    // We never provide any object code since we only get used when our code
+    // has not been found in our cache (see CompilerEngine::compileCode())
+
+    return nullptr;
+}
+
+//==============================================================================
+
 CompilerEngine::~CompilerEngine()
 {
     // Delete some internal objects
@@ -69,6 +138,36 @@ CompilerEngine::~CompilerEngine()
 
 //==============================================================================
 
+QString CompilerEngine::cacheDirName()
+{
+    // Return the name of the directory where we cache compiled code
+
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)+"/CompiledCode";
+}
+
+//==============================================================================
+
+qint64 CompilerEngine::cacheMaxSize()
+{
+    // Return the maximum size of our cache
+
+    return CacheMaxSize;
+}
+
+//==============================================================================
+
+void CompilerEngine::setCacheMaxSize(qint64 pCacheMaxSize)
+{
+    // Set the maximum size of our cache, i.e. the amount of disk space (in
+    // bytes) that its object files may use
+    // Note: our cache gets trimmed the next time that some code gets compiled
+    //       and cached (see trimCache())...
+
+    CacheMaxSize = pCacheMaxSize;
+}
+
+//==============================================================================
+
 bool CompilerEngine::hasError() const
 {
     // Return whether an error occurred
@@ -98,6 +197,20 @@ inline std::string functionName(const char *pFunctionName)
 
 //==============================================================================
 
+void CompilerEngine::addExternalSymbol(const QString &pName, void *pAddress)
+{
+    // Keep track of the given external symbol, so that it can be mapped to the
+    // given address when compiling our code
+    // Note: unlike llvm::sys::DynamicLibrary::AddSymbol(), this is specific to
+    //       our execution engine, which means that the same symbol can be
+    //       mapped to different addresses by different compiler engines, and
+    //       that the code that uses it can still be cached...
+
+    mExternalSymbols.insert(pName, pAddress);
+}
+
+//==============================================================================
+
 bool CompilerEngine::compileCode(const QString &pCode)
 {
     // Reset ourselves
@@ -167,16 +280,7 @@ bool CompilerEngine::compileCode(const QString &pCode)
                     "\n"
                    +pCode;
 
-    // Get a driver to compile our code
-
-    auto diagnosticOptions = new clang::DiagnosticOptions();
-    clang::DiagnosticsEngine diagnosticsEngine(llvm::IntrusiveRefCntPtr<clang::DiagnosticIDs>(new clang::DiagnosticIDs()),
-                                               &*diagnosticOptions);
-    clang::driver::Driver driver("clang", llvm::sys::getProcessTriple(), diagnosticsEngine);
-
-    driver.setCheckInputsExist(false);
-
-    // Get a compilation object to which we pass some arguments
+    // Determine the arguments needed to compile our code
 
     llvm::StringRef dummyFileName("dummyFile.c");
     llvm::SmallVector<const char *, 16> compilationArguments;
@@ -193,6 +297,51 @@ bool CompilerEngine::compileCode(const QString &pCode)
     compilationArguments.emplace_back("-Werror");
     compilationArguments.emplace_back(dummyFileName.data());
 
+    // Initialise the native target (and its ASM printer), so not only can we
+    // then create an execution engine, but more importantly its data layout
+    // will match that of our target platform
+
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    // Check whether our code has already been compiled, in which case we load
+    // its object code from our cache rather than compile it again
+    // Note: the name of a cached object file is based on everything that may
+    //       affect its contents, i.e. our code, our compilation arguments, our
+    //       target and our version of LLVM...
+
+    QByteArray codeByteArray = code.toUtf8();
+    QByteArray cacheKey = codeByteArray;
+
+    for (auto compilationArgument : compilationArguments) {
+        cacheKey += QByteArray("\n")+compilationArgument;
+    }
+
+    cacheKey += QByteArray("\n")+llvm::sys::getProcessTriple().c_str()
+               +"\n"+llvm::sys::getHostCPUName().str().c_str()
+               +"\n"+LLVM_VERSION_STRING;
+
+    QString cachedObjectFileName = cacheDirName()+"/"+Core::sha1(cacheKey)+".o";
+
+    if (loadCachedObject(cachedObjectFileName)) {
+        mapExternalFunctions();
+
+        mExecutionEngine->finalizeObject();
+
+        return true;
+    }
+
+    // Get a driver to compile our code
+
+    auto diagnosticOptions = new clang::DiagnosticOptions();
+    clang::DiagnosticsEngine diagnosticsEngine(llvm::IntrusiveRefCntPtr<clang::DiagnosticIDs>(new clang::DiagnosticIDs()),
+                                               &*diagnosticOptions);
+    clang::driver::Driver driver("clang", llvm::sys::getProcessTriple(), diagnosticsEngine);
+
+    driver.setCheckInputsExist(false);
+
+    // Get a compilation object to which we pass our arguments
+
     std::unique_ptr<clang::driver::Compilation> compilation(driver.BuildCompilation(compilationArguments));
 
     if (!compilation) {
@@ -237,8 +386,6 @@ bool CompilerEngine::compileCode(const QString &pCode)
 
     // Map our dummy file to a memory buffer
 
-    QByteArray codeByteArray = code.toUtf8();
-
     compilerInvocation->getPreprocessorOpts().addRemappedFile(dummyFileName, llvm::MemoryBuffer::getMemBuffer(codeByteArray.constData()).release());
 
     // Create a compiler instance to handle the actual work
@@ -277,13 +424,6 @@ bool CompilerEngine::compileCode(const QString &pCode)
         return false;
     }
 
-    // Initialise the native target (and its ASM printer), so not only can we
-    // then create an execution engine, but more importantly its data layout
-    // will match that of our target platform
-
-    llvm::InitializeNativeTarget();
-    llvm::InitializeNativeTargetAsmPrinter();
-
     // Create and keep track of an execution engine
 
     mExecutionEngine = llvm::EngineBuilder(std::move(module)).setEngineKind(llvm::EngineKind::JIT).create();
@@ -299,6 +439,114 @@ bool CompilerEngine::compileCode(const QString &pCode)
     // Map all the external functions that may, or not, be needed by the given
     // code
 
+    mapExternalFunctions();
+
+    // Generate the object code for our module and keep a copy of it in our
+    // cache, so that we don't have to compile our code next time
+    // Note: the object cache is only needed while generating the object code,
+    //       hence we unset it straightaway...
+
+    CompilerObjectCache objectCache(cachedObjectFileName);
+
+    mExecutionEngine->setObjectCache(&objectCache);
+    mExecutionEngine->finalizeObject();
+    mExecutionEngine->setObjectCache(nullptr);
+
+    // Make sure that our cache doesn't get too big now that it has a new
+    // object file
+
+    trimCache(cachedObjectFileName);
+
+    return true;
+}
+
+//==============================================================================
+
+bool CompilerEngine::loadCachedObject(const QString &pFileName)
+{
+    // Try to create an execution engine from the given cached object file
+
+    QByteArray object;
+
+    if (!QFile::exists(pFileName) || !Core::readFile(pFileName, object)) {
+        return false;
+    }
+
+    std::unique_ptr<llvm::MemoryBuffer> objectBuffer = llvm::MemoryBuffer::getMemBufferCopy(llvm::StringRef(object.constData(), size_t(object.size())));
+    llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> objectFile = llvm::object::ObjectFile::createObjectFile(objectBuffer->getMemBufferRef());
+
+    if (!objectFile) {
+        // The cached object file is not valid (e.g. it got corrupted), so
+        // remove it
+
+        llvm::consumeError(objectFile.takeError());
+
+        QFile::remove(pFileName);
+
+        return false;
+    }
+
+    // Create an execution engine with an empty module and add our object file
+    // to it
+    // Note: an execution engine cannot be created without a module, hence our
+    //       empty module...
+
+    mExecutionEngine = llvm::EngineBuilder(std::make_unique<llvm::Module>(QFileInfo(pFileName).baseName().toStdString(), *llvm::unwrap(LLVMGetGlobalContext()))).setEngineKind(llvm::EngineKind::JIT).create();
+
+    if (mExecutionEngine == nullptr) {
+        return false;
+    }
+
+    mExecutionEngine->addObjectFile(llvm::object::OwningBinary<llvm::object::ObjectFile>(std::move(*objectFile), std::move(objectBuffer)));
+
+    // Let our cache know that our object file has just been used (see
+    // trimCache())
+
+    QFile file(pFileName);
+
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        file.close();
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+void CompilerEngine::trimCache(const QString &pFileName)
+{
+    // Make sure that our cache doesn't use more than its maximum size by
+    // removing its least recently used object files, but not the given one,
+    // which we have just compiled
+    // Note #1: the modification time of an object file is updated whenever it
+    //          gets loaded (see loadCachedObject()), so it tells us when it was
+    //          last used...
+    // Note #2: this also means that the object files that were compiled using
+    //          a different version of OpenCOR, LLVM, etc. are never used again
+    //          and therefore end up being removed...
+
+    QDir cacheDir(cacheDirName());
+    const QFileInfoList fileInfos = cacheDir.entryInfoList(QStringList() << "*.o",
+                                                           QDir::Files, QDir::Time);
+    qint64 cacheSize = 0;
+
+    for (const auto &fileInfo : fileInfos) {
+        cacheSize += fileInfo.size();
+
+        if (   (cacheSize > CacheMaxSize)
+            && (fileInfo.absoluteFilePath() != QFileInfo(pFileName).absoluteFilePath())) {
+            QFile::remove(fileInfo.absoluteFilePath());
+        }
+    }
+}
+
+//==============================================================================
+
+void CompilerEngine::mapExternalFunctions()
+{
+    // Map all the external functions that may, or not, be needed by our code
+
     mExecutionEngine->addGlobalMapping(functionName("fabs"), reinterpret_cast<quint64>(compiler_fabs));
 
     mExecutionEngine->addGlobalMapping(functionName("log"), reinterpret_cast<quint64>(compiler_log));
@@ -349,7 +597,12 @@ bool CompilerEngine::compileCode(const QString &pCode)
     mExecutionEngine->addGlobalMapping(functionName("gcd_multi"), reinterpret_cast<quint64>(compiler_gcd_multi));
     mExecutionEngine->addGlobalMapping(functionName("lcm_multi"), reinterpret_cast<quint64>(compiler_lcm_multi));
 
-    return true;
+    // Map all the external symbols that we were given
+
+    for (auto externalSymbol = mExternalSymbols.constBegin(), externalSymbolEnd = mExternalSymbols.constEnd();
+         externalSymbol != externalSymbolEnd; ++externalSymbol) {
+        mExecutionEngine->addGlobalMapping(functionName(qPrintable(externalSymbol.key())), reinterpret_cast<quint64>(externalSymbol.value()));
+    }
 }
 
 //==============================================================================
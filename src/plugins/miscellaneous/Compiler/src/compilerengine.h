@@ -29,6 +29,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QMap>
 #include <QObject>
 #include <QString>
 
@@ -52,9 +53,16 @@ class COMPILER_EXPORT CompilerEngine : public QObject
 public:
     ~CompilerEngine() override;
 
+    static QString cacheDirName();
+
+    static qint64 cacheMaxSize();
+    static void setCacheMaxSize(qint64 pCacheMaxSize);
+
     bool hasError() const;
     QString error() const;
 
+    void addExternalSymbol(const QString &pName, void *pAddress);
+
     bool compileCode(const QString &pCode);
 
     void * getFunction(const QString &pFunctionName);
@@ -63,6 +71,14 @@ private:
     llvm::ExecutionEngine *mExecutionEngine = nullptr;
 
     QString mError;
+
+    QMap<QString, void *> mExternalSymbols;
+
+    bool loadCachedObject(const QString &pFileName);
+
+    static void trimCache(const QString &pFileName);
+
+    void mapExternalFunctions();
 };
 
 //==============================================================================
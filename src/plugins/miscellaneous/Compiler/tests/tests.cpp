@@ -23,6 +23,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 #include "compilerengine.h"
 #include "compilermath.h"
+#include "corecliutils.h"
 #include "tests.h"
 
 //==============================================================================
@@ -37,6 +38,10 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 void Tests::initTestCase()
 {
+    // Make sure that we don't use the user's cache for compiled code
+
+    QStandardPaths::setTestModeEnabled(true);
+
     // Create our compiler engine
 
     mCompilerEngine = new OpenCOR::Compiler::CompilerEngine();
@@ -126,6 +131,128 @@ void Tests::basicTests()
 
 //==============================================================================
 
+void Tests::cacheTests()
+{
+    // Start from an empty cache
+
+    QDir cacheDir(OpenCOR::Compiler::CompilerEngine::cacheDirName());
+
+    QVERIFY(cacheDir.removeRecursively());
+
+    // Compile some code, which should result in it being cached
+
+    static const char *Code = "double function(double pNb)\n"
+                              "{\n"
+                              "    return exp(pNb);\n"
+                              "}";
+
+    QVERIFY(mCompilerEngine->compileCode(Code));
+    QVERIFY(qFuzzyCompare(reinterpret_cast<double (*)(double)>(mCompilerEngine->getFunction("function"))(mA),
+                          compiler_exp(mA)));
+    QCOMPARE(cacheDir.entryList(QDir::Files).count(), 1);
+
+    // Compile the same code again, which should result in it being loaded from
+    // our cache
+
+    QVERIFY(mCompilerEngine->compileCode(Code));
+    QVERIFY(qFuzzyCompare(reinterpret_cast<double (*)(double)>(mCompilerEngine->getFunction("function"))(mA),
+                          compiler_exp(mA)));
+    QCOMPARE(cacheDir.entryList(QDir::Files).count(), 1);
+
+    // Make sure that invalid code doesn't get cached
+
+    QVERIFY(!mCompilerEngine->compileCode("double function() { return 3.0*/a; }"));
+    QCOMPARE(cacheDir.entryList(QDir::Files).count(), 1);
+
+    // Corrupt our cached object file and make sure that our code gets compiled
+    // (and cached) again
+
+    QString cachedObjectFileName = cacheDir.filePath(cacheDir.entryList(QDir::Files).first());
+
+    QVERIFY(OpenCOR::Core::writeFile(cachedObjectFileName, QByteArray("Corrupted object file")));
+    QVERIFY(mCompilerEngine->compileCode(Code));
+    QVERIFY(qFuzzyCompare(reinterpret_cast<double (*)(double)>(mCompilerEngine->getFunction("function"))(mA),
+                          compiler_exp(mA)));
+    QVERIFY(OpenCOR::Core::fileSha1(cachedObjectFileName) != OpenCOR::Core::sha1(QByteArray("Corrupted object file")));
+}
+
+//==============================================================================
+
+void Tests::cacheMaxSizeTests()
+{
+    // Start from an empty cache that can hold only one object file
+
+    QDir cacheDir(OpenCOR::Compiler::CompilerEngine::cacheDirName());
+    qint64 cacheMaxSize = OpenCOR::Compiler::CompilerEngine::cacheMaxSize();
+
+    QVERIFY(cacheDir.removeRecursively());
+
+    OpenCOR::Compiler::CompilerEngine::setCacheMaxSize(1);
+
+    // Compile two different pieces of code and make sure that only the object
+    // file of the second one is in our cache
+
+    QVERIFY(mCompilerEngine->compileCode("double function() { return 3.0; }"));
+    QCOMPARE(cacheDir.entryList(QDir::Files).count(), 1);
+
+    QString firstObjectFileName = cacheDir.entryList(QDir::Files).first();
+
+    QVERIFY(mCompilerEngine->compileCode("double function() { return 5.0; }"));
+    QCOMPARE(reinterpret_cast<double (*)()>(mCompilerEngine->getFunction("function"))(), 5.0);
+    QCOMPARE(cacheDir.entryList(QDir::Files).count(), 1);
+    QVERIFY(cacheDir.entryList(QDir::Files).first() != firstObjectFileName);
+
+    // Allow our cache to be big enough for both object files and make sure
+    // that it can hold them both
+
+    OpenCOR::Compiler::CompilerEngine::setCacheMaxSize(cacheMaxSize);
+
+    QVERIFY(mCompilerEngine->compileCode("double function() { return 3.0; }"));
+    QCOMPARE(cacheDir.entryList(QDir::Files).count(), 2);
+}
+
+//==============================================================================
+
+void Tests::externalSymbolTests()
+{
+    // Compile the same code using two compiler engines that map the same
+    // external symbol to different addresses, the second compiler engine
+    // loading the code from our cache
+
+    static const char *Code = "extern double externalValue;\n"
+                              "\n"
+                              "double function()\n"
+                              "{\n"
+                              "    return externalValue;\n"
+                              "}";
+
+    double externalValueA = 123.0;
+    double externalValueB = 456.0;
+    OpenCOR::Compiler::CompilerEngine compilerEngineA;
+    OpenCOR::Compiler::CompilerEngine compilerEngineB;
+
+    compilerEngineA.addExternalSymbol("externalValue", &externalValueA);
+    compilerEngineB.addExternalSymbol("externalValue", &externalValueB);
+
+    QVERIFY(compilerEngineA.compileCode(Code));
+    QVERIFY(compilerEngineB.compileCode(Code));
+
+    QCOMPARE(reinterpret_cast<double (*)()>(compilerEngineA.getFunction("function"))(),
+             externalValueA);
+    QCOMPARE(reinterpret_cast<double (*)()>(compilerEngineB.getFunction("function"))(),
+             externalValueB);
+
+    // Make sure that our compiler engines keep using the addresses they were
+    // given
+
+    externalValueA = 789.0;
+
+    QCOMPARE(reinterpret_cast<double (*)()>(compilerEngineA.getFunction("function"))(),
+             externalValueA);
+}
+
+//==============================================================================
+
 void Tests::voidFunctionTests()
 {
     std::array<double, 3> arrayA = {};
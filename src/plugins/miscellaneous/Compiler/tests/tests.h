@@ -59,6 +59,9 @@ private slots:
     void cleanupTestCase();
 
     void basicTests();
+    void cacheTests();
+    void cacheMaxSizeTests();
+    void externalSymbolTests();
 
     void voidFunctionTests();
 
@@ -542,7 +542,7 @@ void doNothing(quint64 pMax)
     #pragma optimize("", off)
 #endif
 
-void doNothing(const quint64 *pMax, const bool *pStopped)
+void doNothing(const quint64 *pMax, const QAtomicInt *pStopped)
 {
     // A silly function, which aim is simply to do nothing
     // Note #1: this function came about because there is no way, on Windows, to
@@ -556,7 +556,7 @@ void doNothing(const quint64 *pMax, const bool *pStopped)
     //          takes forever...
 
     for (quint64 i = 0; i < 1000**pMax; ++i) {
-        if ((pStopped != nullptr) && *pStopped) {
+        if ((pStopped != nullptr) && (pStopped->loadAcquire() != 0)) {
             break;
         }
 
@@ -34,6 +34,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 //==============================================================================
 
 #include <QAbstractMessageHandler>
+#include <QAtomicInt>
 #include <QByteArray>
 #include <QCoreApplication>
 #include <QDomDocument>
@@ -148,7 +149,8 @@ bool CORE_EXPORT isDirectory(const QString &pDirName);
 bool CORE_EXPORT isEmptyDirectory(const QString &pDirName);
 
 void CORE_EXPORT doNothing(quint64 pMax);
-void CORE_EXPORT doNothing(const quint64 *pMax, const bool *pStopped = nullptr);
+void CORE_EXPORT doNothing(const quint64 *pMax,
+                           const QAtomicInt *pStopped = nullptr);
 
 QString CORE_EXPORT cliOpenFile(const QString &pFileName,
                                 File::Type pType = File::Type::Local,
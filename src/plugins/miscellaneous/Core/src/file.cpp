@@ -26,6 +26,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QDateTime>
 #include <QFile>
 #include <QFileDevice>
 #include <QFileInfo>
@@ -87,6 +88,7 @@ bool File::setFileName(const QString &pFileName)
     if (pFileName != mFileName) {
         mFileName = pFileName;
 
+        mStamp = stamp(mFileName);
         mSha1 = sha1();
         // Note: we will typically set our file name when we have been saved
         //       under a new name, meaning that our SHA-1 value may end up being
@@ -103,6 +105,35 @@ bool File::setFileName(const QString &pFileName)
 
 File::Status File::check()
 {
+    // Check ourselves, computing our SHA-1 value and that of our dependencies,
+    // but only if we and/or our dependencies may have changed
+
+    if (!mayHaveChanged()) {
+        return check(mStamp, mSha1, mDependenciesStamps, mDependenciesSha1);
+    }
+
+    QString newStamp = stamp(mFileName);
+    QStringList newDependenciesStamps = dependenciesStamps();
+    QStringList newDependenciesSha1;
+
+    for (const auto &dependency : qAsConst(mDependencies)) {
+        newDependenciesSha1 << sha1(dependency);
+    }
+
+    return check(newStamp, sha1(), newDependenciesStamps, newDependenciesSha1);
+}
+
+//==============================================================================
+
+File::Status File::check(const QString &pStamp, const QString &pSha1,
+                         const QStringList &pDependenciesStamps,
+                         const QStringList &pDependenciesSha1)
+{
+    // Check ourselves using the given stamps and SHA-1 values
+    // Note: the stamps must have been retrieved before the SHA-1 values were
+    //       computed, so that we cannot miss a change that would happen while
+    //       computing them...
+
     // Always consider ourselves unchanged if we are a remote file
 
     if (!mUrl.isEmpty()) {
@@ -120,17 +151,10 @@ File::Status File::check()
         return Status::DependenciesModified;
     }
 
-    // Retrieve our 'new' SHA-1 value and that of our dependencies (if any), and
-    // check whether they are different from the one(s) we currently have
-
-    QString newSha1 = sha1();
-    QStringList newDependenciesSha1;
-
-    for (const auto &dependency : qAsConst(mDependencies)) {
-        newDependenciesSha1 << sha1(dependency);
-    }
+    // Check whether our 'new' SHA-1 value and that of our dependencies (if any)
+    // are different from the one(s) we currently have
 
-    if (newSha1.isEmpty()) {
+    if (pSha1.isEmpty()) {
         // Our SHA-1 value is now empty, which means that either we have been
         // deleted or that we are unreadable (which, in effect, means that we
         // have been changed)
@@ -141,10 +165,45 @@ File::Status File::check()
     // Our SHA-1 value and/or that of one or several of our dependencies is
     // different from our stored value, which means that we and/or one or
     // several of our dependencies has changed
+    // Note: if neither we nor our dependencies have changed, then it means
+    //       that we and/or our dependencies were only touched, so update our
+    //       stamps so that we don't recompute our SHA-1 values next time
+    //       round...
+
+    bool changed = pSha1 != mSha1;
+    bool dependenciesChanged = pDependenciesSha1 != mDependenciesSha1;
 
-    return (newSha1 != mSha1)?
-               (newDependenciesSha1 != mDependenciesSha1)?Status::AllChanged:Status::Changed:
-               (newDependenciesSha1 != mDependenciesSha1)?Status::DependenciesChanged:Status::Unchanged;
+    if (!changed && !dependenciesChanged) {
+        mStamp = pStamp;
+        mDependenciesStamps = pDependenciesStamps;
+    }
+
+    return changed?
+               dependenciesChanged?Status::AllChanged:Status::Changed:
+               dependenciesChanged?Status::DependenciesChanged:Status::Unchanged;
+}
+
+//==============================================================================
+
+bool File::mayHaveChanged() const
+{
+    // Return whether we and/or our dependencies may have changed, i.e. whether
+    // our stamp and/or that of our dependencies is different from the one(s)
+    // we currently have
+    // Note #1: this is much cheaper than computing our SHA-1 value and that of
+    //          our dependencies, although it may give false positives (e.g. if
+    //          we have only been touched), hence the SHA-1 values must still be
+    //          compared when this returns true...
+    // Note #2: there is no need to compare anything if we are a remote file or
+    //          if we and/or our dependencies are known to have been modified
+    //          (see check())...
+
+    if (!mUrl.isEmpty() || mModified || mDependenciesModified) {
+        return false;
+    }
+
+    return    (stamp(mFileName) != mStamp)
+           || (dependenciesStamps() != mDependenciesStamps);
 }
 
 //==============================================================================
@@ -167,10 +226,43 @@ QString File::sha1() const
 
 //==============================================================================
 
+QString File::stamp(const QString &pFileName)
+{
+    // Return the stamp of the given file, i.e. its last modification time and
+    // size, or an empty string if it doesn't exist
+
+    QFileInfo fileInfo(pFileName);
+
+    if (!fileInfo.exists()) {
+        return {};
+    }
+
+    return QString("%1|%2").arg(fileInfo.lastModified().toMSecsSinceEpoch())
+                           .arg(fileInfo.size());
+}
+
+//==============================================================================
+
+QStringList File::dependenciesStamps() const
+{
+    // Return the stamp of our dependencies
+
+    QStringList res;
+
+    for (const auto &dependency : mDependencies) {
+        res << stamp(dependency);
+    }
+
+    return res;
+}
+
+//==============================================================================
+
 void File::reset(bool pResetDependencies)
 {
-    // Reset our modified state, new index and SHA-1 value
+    // Reset our modified state, new index, SHA-1 value and stamp
 
+    mStamp = stamp(mFileName);
     mSha1 = sha1();
 
     mNewIndex = 0;
@@ -180,6 +272,7 @@ void File::reset(bool pResetDependencies)
     if (pResetDependencies) {
         mDependencies.clear();
         mDependenciesSha1.clear();
+        mDependenciesStamps.clear();
 
         mDependenciesModified = false;
     }
@@ -299,6 +392,7 @@ bool File::setModified(bool pModified)
         //       value will be out-of-date, hence we need to update it...
 
         if (!pModified) {
+            mStamp = stamp(mFileName);
             mSha1 = sha1();
         }
 
@@ -408,6 +502,7 @@ bool File::setDependencies(const QStringList &pDependencies)
     if (pDependencies != mDependencies) {
         mDependencies = pDependencies;
 
+        mDependenciesStamps = dependenciesStamps();
         mDependenciesSha1.clear();
 
         for (const auto &dependency : pDependencies) {
@@ -73,8 +73,14 @@ public:
     bool setFileName(const QString &pFileName);
 
     Status check();
+    Status check(const QString &pStamp, const QString &pSha1,
+                 const QStringList &pDependenciesStamps,
+                 const QStringList &pDependenciesSha1);
+
+    bool mayHaveChanged() const;
 
     static QString sha1(const QString &pFileName);
+    static QString stamp(const QString &pFileName);
 
     QString sha1() const;
 
@@ -112,6 +118,7 @@ private:
     QString mFileName;
     QString mUrl;
     QString mSha1;
+    QString mStamp;
 
     int mNewIndex;
 
@@ -119,8 +126,11 @@ private:
 
     QStringList mDependencies;
     QStringList mDependenciesSha1;
+    QStringList mDependenciesStamps;
 
     bool mDependenciesModified = false;
+
+    QStringList dependenciesStamps() const;
 };
 
 //==============================================================================
@@ -29,8 +29,10 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 #include <QApplication>
 #include <QFile>
+#include <QFileSystemWatcher>
 #include <QTimer>
 #include <QWindow>
+#include <QtConcurrent/QtConcurrent>
 
 //==============================================================================
 
@@ -41,14 +43,38 @@ namespace Core {
 
 FileManager::FileManager()
 {
-    // Create our timer
+    // Create our timers
+    // Note: our main timer is only used to poll the files that we cannot
+    //       watch (see updateWatchedFiles()) while our other timer is used to
+    //       coalesce the changes that get reported to us by our file system
+    //       watcher, since saving a file often results in several of them...
 
     mTimer = new QTimer(this);
+    mCheckFilesTimer = new QTimer(this);
 
-    // A connection to handle the timing out of our timer
+    mCheckFilesTimer->setSingleShot(true);
+    mCheckFilesTimer->setInterval(100);
+
+    // Create our file system watcher and our watcher for checking our files
+    // in a separate thread
+
+    mFileSystemWatcher = new QFileSystemWatcher(this);
+    mCheckFilesWatcher = new QFutureWatcher<StampsSha1>(this);
+
+    // Some connections to handle the timing out of our timers, the changes
+    // reported by our file system watcher and the completion of our checking
+    // of files
 
     connect(mTimer, &QTimer::timeout,
             this, &FileManager::checkFiles);
+    connect(mCheckFilesTimer, &QTimer::timeout,
+            this, &FileManager::checkFiles);
+
+    connect(mFileSystemWatcher, &QFileSystemWatcher::fileChanged,
+            this, &FileManager::fileSystemChanged);
+
+    connect(mCheckFilesWatcher, &QFutureWatcher<StampsSha1>::finished,
+            this, &FileManager::checkFilesFinished);
 
     // Keep track of when OpenCOR gets/loses the focus
 
@@ -62,6 +88,10 @@ FileManager::FileManager()
 
 FileManager::~FileManager()
 {
+    // Wait for the checking of our files to be finished, if needed
+
+    mCheckFilesWatcher->waitForFinished();
+
     // Remove all the managed files
 
     for (auto file : qAsConst(mFiles)) {
@@ -73,18 +103,19 @@ FileManager::~FileManager()
 
 void FileManager::startStopTimer()
 {
-    // Start our timer if OpenCOR is active and we have files, or stop it if
-    // either OpenCOR is not active or we don't have files anymore
-    // Note #1: if we are to start our timer, then we check files first since
-    //          waiting one second may seem long to a user (when some files have
-    //          changed and after having reactivated OpenCOR)...
+    // Check our files if OpenCOR has become active and we have files, and
+    // start our timer if we also have files that we cannot watch, or stop it if
+    // either OpenCOR is not active or we don't have files to poll anymore
+    // Note #1: we check files when OpenCOR becomes active since our files may
+    //          have been changed while OpenCOR was not active...
     // Note #2: checking files may result in a message box being shown and,
     //          therefore, in a focusWindowChanged() signal being emitted. To
     //          handle that signal would result in reentry, so we temporarily
     //          disable our handling of it...
 
-    if (   !mTimer->isActive()
-        &&  opencorActive() && !mFiles.isEmpty()) {
+    bool active = opencorActive() && !mFiles.isEmpty();
+
+    if (active && !mActive) {
         disconnect(qApp, &QApplication::focusWindowChanged,
                    this, &FileManager::focusWindowChanged);
 
@@ -92,16 +123,68 @@ void FileManager::startStopTimer()
 
         connect(qApp, &QApplication::focusWindowChanged,
                 this, &FileManager::focusWindowChanged);
+    }
 
+    mActive = active;
+
+    if (   !mTimer->isActive()
+        &&  mActive && !mUnwatchedFiles.isEmpty()) {
         mTimer->start(1000);
     } else if (   mTimer->isActive()
-               && (!opencorActive() || mFiles.isEmpty())) {
+               && (!mActive || mUnwatchedFiles.isEmpty())) {
         mTimer->stop();
     }
 }
 
 //==============================================================================
 
+void FileManager::updateWatchedFiles()
+{
+    // Watch our local files and their dependencies, and stop watching those
+    // that we don't manage anymore
+    // Note #1: a file that gets saved by replacing it (as many editors do) is
+    //          not watched anymore, hence we (try to) watch it again...
+    // Note #2: a file that doesn't exist (e.g. a missing import) or that cannot
+    //          be watched (e.g. because we have reached the system's limit) is
+    //          polled instead (see startStopTimer())...
+
+    QSet<QString> fileNames;
+
+    for (auto file : qAsConst(mFiles)) {
+        if (file->isLocal()) {
+            fileNames << file->fileName();
+
+            const QStringList dependencies = file->dependencies();
+
+            for (const auto &dependency : dependencies) {
+                fileNames << dependency;
+            }
+        }
+    }
+
+    QSet<QString> watchedFiles = mFileSystemWatcher->files().toSet();
+
+    for (const auto &watchedFile : qAsConst(watchedFiles)) {
+        if (!fileNames.contains(watchedFile)) {
+            mFileSystemWatcher->removePath(watchedFile);
+        }
+    }
+
+    mUnwatchedFiles.clear();
+
+    for (const auto &fileName : qAsConst(fileNames)) {
+        if (   !watchedFiles.contains(fileName)
+            && (   !QFile::exists(fileName)
+                || !mFileSystemWatcher->addPath(fileName))) {
+            mUnwatchedFiles << fileName;
+        }
+    }
+
+    startStopTimer();
+}
+
+//==============================================================================
+
 FileManager * FileManager::instance()
 {
     // Return the 'global' instance of our file manager class
@@ -136,7 +219,7 @@ FileManager::Status FileManager::manage(const QString &pFileName,
 
         mFileNameFiles.insert(fileName, file);
 
-        startStopTimer();
+        updateWatchedFiles();
 
         emit fileManaged(fileName);
 
@@ -163,7 +246,7 @@ FileManager::Status FileManager::unmanage(const QString &pFileName)
 
         delete file;
 
-        startStopTimer();
+        updateWatchedFiles();
 
         emit fileUnmanaged(fileName);
 
@@ -509,8 +592,8 @@ void FileManager::setDependencies(const QString &pFileName,
 
     File *file = FileManager::file(canonicalFileName(pFileName));
 
-    if (file != nullptr) {
-        file->setDependencies(pDependencies);
+    if ((file != nullptr) && file->setDependencies(pDependencies)) {
+        updateWatchedFiles();
     }
 }
 
@@ -545,6 +628,8 @@ void FileManager::reload(const QString &pFileName)
 
         file->reset();
 
+        updateWatchedFiles();
+
         emit fileReloaded(fileName);
 
         // Reset our modified state and let people know about it, if needed
@@ -626,6 +711,8 @@ FileManager::Status FileManager::rename(const QString &pOldFileName,
             mFileNameFiles.insert(newFileName, file);
             mFileNameFiles.remove(oldFileName);
 
+            updateWatchedFiles();
+
             emit fileRenamed(oldFileName, newFileName);
 
             return Status::Renamed;
@@ -688,6 +775,8 @@ void FileManager::save(const QString &pFileName)
 
         file->reset(false);
 
+        updateWatchedFiles();
+
         emit fileSaved(fileName);
     }
 }
@@ -718,9 +807,17 @@ void FileManager::emitFilePermissionsChanged(const QString &pFileName)
 
 void FileManager::setCheckFilesEnabled(bool pCheckFilesEnabled)
 {
-    // Specify whether we can check files
+    // Specify whether we can check files and, if we can again, check them if
+    // we were asked to do so while we couldn't
+    // Note: we may be called while checking our files (e.g. when a message box
+    //       asks the user whether to reload a file), so we check our files
+    //       shortly rather than straight away...
 
     mCheckFilesEnabled = pCheckFilesEnabled;
+
+    if (mCheckFilesEnabled && mCheckFilesNeeded) {
+        mCheckFilesTimer->start();
+    }
 }
 
 //==============================================================================
@@ -734,6 +831,73 @@ void FileManager::focusWindowChanged()
 
 //==============================================================================
 
+void FileManager::fileSystemChanged()
+{
+    // One of our files (or one of their dependencies) has changed, been
+    // replaced or been deleted, so make sure that we still watch it (see
+    // updateWatchedFiles()) and check our files shortly
+
+    updateWatchedFiles();
+
+    mCheckFilesTimer->start();
+}
+
+//==============================================================================
+
+FileManager::StampsSha1 FileManager::stampsSha1(const QStringList &pFileNames)
+{
+    // Return the stamp and SHA-1 value of the given files
+    // Note #1: this is run in a separate thread, hence it must not access any
+    //          of our members...
+    // Note #2: we retrieve the stamp of a file before computing its SHA-1
+    //          value (see File::check())...
+
+    StampsSha1 res;
+
+    for (const auto &fileName : pFileNames) {
+        QString stamp = File::stamp(fileName);
+
+        res.insert(fileName, { stamp, File::sha1(fileName) });
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+void FileManager::checkFile(const QString &pFileName, File::Status pFileStatus)
+{
+    // Let people know about the given file having changed or been deleted, or
+    // check whether its permissions have changed
+
+    if (   (pFileStatus == File::Status::Changed)
+        || (pFileStatus == File::Status::DependenciesChanged)
+        || (pFileStatus == File::Status::AllChanged)) {
+        // The file and/or one or several of its dependencies has changed, so
+        // let people know about it
+
+        emit fileChanged(pFileName,
+                         (pFileStatus == File::Status::Changed) || (pFileStatus == File::Status::AllChanged),
+                         (pFileStatus == File::Status::DependenciesChanged) || (pFileStatus == File::Status::AllChanged));
+    } else if (pFileStatus == File::Status::Unchanged) {
+        // The file has neither changed nor been deleted, so check whether its
+        // permissions have changed
+
+        if (    (mFilesReadable.value(pFileName, false) != isReadable(pFileName))
+            ||  (mFilesWritable.value(pFileName, false) != isWritable(pFileName))
+            || !(   mFilesReadable.contains(pFileName)
+                 && mFilesWritable.contains(pFileName))) {
+            emitFilePermissionsChanged(pFileName);
+        }
+    } else if (pFileStatus == File::Status::Deleted) {
+        // The file has been deleted, so let people know about it
+
+        emit fileDeleted(pFileName);
+    }
+}
+
+//==============================================================================
+
 void FileManager::checkFiles()
 {
     // Make sure that OpenCOR is active
@@ -743,15 +907,44 @@ void FileManager::checkFiles()
     //       means that we can't enable/disable our timer in those acses, hence
     //       our checking that OpenCOR is really active indeed...
 
-    if (!opencorActive() || !mCheckFilesEnabled) {
+    if (!opencorActive()) {
         return;
     }
 
+    // Make sure that we can check files, in which case we will check them once
+    // we can again (see setCheckFilesEnabled())
+
+    if (!mCheckFilesEnabled) {
+        mCheckFilesNeeded = true;
+
+        return;
+    }
+
+    // Make sure that we are not already checking some files, in which case we
+    // will check our files again once we are done
+
+    if (mCheckFilesWatcher->isRunning()) {
+        mCheckFilesNeeded = true;
+
+        return;
+    }
+
+    mCheckFilesNeeded = false;
+
     // Check our various files, after making sure that they are still being
     // managed
-    // Note: indeed, some files may get added/removed while we are checking
-    //       them, and to check a file that has been removed will crash
-    //       OpenCOR...
+    // Note #1: indeed, some files may get added/removed while we are checking
+    //          them, and to check a file that has been removed will crash
+    //          OpenCOR...
+    // Note #2: we only compute the SHA-1 value of the files (and of their
+    //          dependencies) that may have changed, based on their stamp, and
+    //          we do so in a separate thread since it means reading the whole
+    //          of those files. The other files can be checked straight
+    //          away...
+
+    QStringList fileNames;
+
+    mCheckedFiles.clear();
 
     for (auto file : qAsConst(mFiles)) {
         if (!mFiles.contains(file)) {
@@ -759,33 +952,85 @@ void FileManager::checkFiles()
         }
 
         QString fileName = file->fileName();
-        File::Status fileStatus = file->check();
-
-        if (   (fileStatus == File::Status::Changed)
-            || (fileStatus == File::Status::DependenciesChanged)
-            || (fileStatus == File::Status::AllChanged)) {
-            // The file and/or one or several of its dependencies has changed,
-            // so let people know about it
-
-            emit fileChanged(fileName,
-                             (fileStatus == File::Status::Changed) || (fileStatus == File::Status::AllChanged),
-                             (fileStatus == File::Status::DependenciesChanged) || (fileStatus == File::Status::AllChanged));
-        } else if (fileStatus == File::Status::Unchanged) {
-            // The file has neither changed nor been deleted, so check whether
-            // its permissions have changed
-
-            if (    (mFilesReadable.value(fileName, false) != isReadable(fileName))
-                ||  (mFilesWritable.value(fileName, false) != isWritable(fileName))
-                || !(   mFilesReadable.contains(fileName)
-                     && mFilesWritable.contains(fileName))) {
-                emitFilePermissionsChanged(fileName);
+
+        if (file->mayHaveChanged()) {
+            mCheckedFiles << fileName;
+
+            fileNames << fileName << file->dependencies();
+        } else {
+            checkFile(fileName, file->check());
+        }
+    }
+
+    if (!mCheckedFiles.isEmpty()) {
+        fileNames.removeDuplicates();
+
+        mCheckFilesWatcher->setFuture(QtConcurrent::run(&FileManager::stampsSha1, fileNames));
+    }
+}
+
+//==============================================================================
+
+void FileManager::checkFilesFinished()
+{
+    // We are done computing the stamp and SHA-1 value of the files that may
+    // have changed, so check them, but only if they are still managed and
+    // OpenCOR is still active (otherwise, they will be checked again when
+    // OpenCOR becomes active again) and we can still check files (otherwise,
+    // they will be checked again once we can, see setCheckFilesEnabled())
+
+    if (!mCheckFilesEnabled) {
+        mCheckFilesNeeded = true;
+    } else if (opencorActive()) {
+        StampsSha1 stampsSha1 = mCheckFilesWatcher->result();
+
+        for (const auto &fileName : qAsConst(mCheckedFiles)) {
+            File *file = FileManager::file(fileName);
+
+            if (file == nullptr) {
+                continue;
+            }
+
+            // Retrieve the stamp and SHA-1 value of our file and of its
+            // dependencies, unless its dependencies have changed in the
+            // meantime, in which case we will need to check it again
+
+            const QStringList dependencies = file->dependencies();
+            QStringList dependenciesStamps;
+            QStringList dependenciesSha1;
+            bool checkFileNeeded = true;
+
+            for (const auto &dependency : dependencies) {
+                if (!stampsSha1.contains(dependency)) {
+                    checkFileNeeded = false;
+
+                    break;
+                }
+
+                dependenciesStamps << stampsSha1.value(dependency).first;
+                dependenciesSha1 << stampsSha1.value(dependency).second;
             }
-        } else if (fileStatus == File::Status::Deleted) {
-            // The file has been deleted, so let people know about it
 
-            emit fileDeleted(fileName);
+            if (!checkFileNeeded) {
+                mCheckFilesNeeded = true;
+
+                continue;
+            }
+
+            checkFile(fileName,
+                      file->check(stampsSha1.value(fileName).first,
+                                  stampsSha1.value(fileName).second,
+                                  dependenciesStamps, dependenciesSha1));
         }
     }
+
+    mCheckedFiles.clear();
+
+    // Check our files again, if needed and if we can
+
+    if (mCheckFilesNeeded && mCheckFilesEnabled) {
+        checkFiles();
+    }
 }
 
 //==============================================================================
@@ -30,11 +30,15 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QFutureWatcher>
 #include <QMap>
 #include <QObject>
+#include <QPair>
+#include <QSet>
 
 //==============================================================================
 
+class QFileSystemWatcher;
 class QTimer;
 
 //==============================================================================
@@ -149,7 +153,17 @@ public:
     void setCheckFilesEnabled(bool pCheckFilesEnabled);
 
 private:
+    using StampsSha1 = QMap<QString, QPair<QString, QString>>;
+
     QTimer *mTimer;
+    QTimer *mCheckFilesTimer;
+
+    QFileSystemWatcher *mFileSystemWatcher;
+    QSet<QString> mUnwatchedFiles;
+
+    QFutureWatcher<StampsSha1> *mCheckFilesWatcher;
+    QStringList mCheckedFiles;
+    bool mCheckFilesNeeded = false;
 
     QList<File *> mFiles;
     QMap<QString, File *> mFileNameFiles;
@@ -158,9 +172,16 @@ private:
     QMap<QString, bool> mFilesWritable;
 
     bool mCheckFilesEnabled = true;
+    bool mActive = false;
 
     void startStopTimer();
 
+    void updateWatchedFiles();
+
+    static StampsSha1 stampsSha1(const QStringList &pFileNames);
+
+    void checkFile(const QString &pFileName, File::Status pFileStatus);
+
     bool newFile(QString &pFileName,
                  const QByteArray &pContents = {});
 
@@ -188,7 +209,10 @@ signals:
 private slots:
     void focusWindowChanged();
 
+    void fileSystemChanged();
+
     void checkFiles();
+    void checkFilesFinished();
 };
 
 //==============================================================================
@@ -27,6 +27,10 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QStandardPaths>
+
+//==============================================================================
+
 namespace OpenCOR {
 namespace Core {
 
@@ -57,11 +61,29 @@ MathmlConverter::~MathmlConverter()
 void MathmlConverter::convert(const QString &pContentMathml)
 {
     // Convert the given Content MathML to Presentation MathML through an XSL
-    // transformation
+    // transformation, which output is to be cached on disk using a file name
+    // based on both our XSL and the given Content MathML
+    // Note: this means that the same Content MathML will only ever get
+    //       converted once, even across sessions...
 
     static const QString CtopXsl = resource(":/Core/web-xslt/ctopff.xsl");
+    static const QString CtopXslSha1 = sha1(CtopXsl);
+    static const QString CacheDirName = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)+"/PresentationMathml";
+
+    mXslTransformer->transform(pContentMathml, CtopXsl,
+                               CacheDirName+"/"+sha1(CtopXslSha1+pContentMathml)+".xml");
+}
+
+//==============================================================================
+
+void MathmlConverter::convert(const QStringList &pContentMathmlList)
+{
+    // Convert the given Content MathML list to Presentation MathML, letting our
+    // XSL transformer spread the different conversions over its threads
 
-    mXslTransformer->transform(pContentMathml, CtopXsl);
+    for (const auto &contentMathml : pContentMathmlList) {
+        convert(contentMathml);
+    }
 }
 
 //==============================================================================
@@ -31,6 +31,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 #include <QDomElement>
 #include <QObject>
+#include <QStringList>
 
 //==============================================================================
 
@@ -52,6 +53,7 @@ public:
     ~MathmlConverter() override;
 
     void convert(const QString &pContentMathml);
+    void convert(const QStringList &pContentMathmlList);
 
 private:
     XslTransformer *mXslTransformer;
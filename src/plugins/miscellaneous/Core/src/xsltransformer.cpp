@@ -26,7 +26,17 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
-#include <QThread>
+#include <QCache>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QThreadStorage>
 #include <QXmlQuery>
 
 //==============================================================================
@@ -36,69 +46,257 @@ namespace Core {
 
 //==============================================================================
 
-XslTransformerWorker::XslTransformerWorker(const QString &pInput,
-                                           const QString &pXsl) :
-    mInput(pInput),
+XslTransformerQuery::XslTransformerQuery(const QString &pXsl) :
+    mMessageHandler(new DummyMessageHandler()),
+    mXmlQuery(new QXmlQuery(QXmlQuery::XSLT20)),
     mXsl(pXsl)
 {
+    // Customise our XML query object
+
+    mXmlQuery->setMessageHandler(mMessageHandler);
 }
 
 //==============================================================================
 
-void XslTransformerWorker::run()
+XslTransformerQuery::~XslTransformerQuery()
 {
-    // Create our XML query object
+    // Delete some internal objects
+
+    delete mXmlQuery;
+    delete mMessageHandler;
+}
 
-    QXmlQuery xmlQuery(QXmlQuery::XSLT20);
-    DummyMessageHandler dummyMessageHandler;
+//==============================================================================
 
-    xmlQuery.setMessageHandler(&dummyMessageHandler);
+QString XslTransformerQuery::transform(const QString &pInput)
+{
+    // Transform the given input using our XSL, which we only need to compile
+    // the first time round
+    // Note: the focus needs to be set before our XSL gets compiled, after which
+    //       only the focus needs to be updated...
 
-    // Customise our XML query object
+    mXmlQuery->setFocus(pInput);
 
-    xmlQuery.setFocus(mInput);
-    xmlQuery.setQuery(mXsl);
+    if (mCompilationsCount == 0) {
+        mXmlQuery->setQuery(mXsl);
 
-    // Do the XSL transformation
+        ++mCompilationsCount;
+    }
 
     QString output;
 
-    if (!xmlQuery.evaluateTo(&output)) {
+    if (!mXmlQuery->evaluateTo(&output)) {
         output = QString();
     }
 
-    // Let people know that our XSL transformation is done
+    return output;
+}
+
+//==============================================================================
 
-    emit done(mInput, output);
+int XslTransformerQuery::compilationsCount() const
+{
+    // Return the number of times that our XSL has been compiled
+
+    return mCompilationsCount;
 }
 
 //==============================================================================
 
-void XslTransformer::transform(const QString &pInput, const QString &pXsl)
+using XslTransformerQueries = QHash<QString, QSharedPointer<XslTransformerQuery>>;
+
+//==============================================================================
+
+static QThreadPool * xslTransformerThreadPool()
 {
-    // Create and move our worker to a thread
+    // Return our thread pool, which threads we keep alive so that the XSL they
+    // have compiled can be reused
 
-    auto thread = new QThread();
-    auto worker = new XslTransformerWorker(pInput, pXsl);
+    static QThreadPool threadPool;
+    static bool initialized = false;
 
-    worker->moveToThread(thread);
+    if (!initialized) {
+        threadPool.setExpiryTimeout(-1);
 
-    connect(thread, &QThread::started,
-            worker, &XslTransformerWorker::run);
+        initialized = true;
+    }
 
-    connect(worker, &XslTransformerWorker::done,
-            this, &XslTransformer::done);
-    connect(worker, &XslTransformerWorker::done,
-            thread, &QThread::quit);
-    connect(worker, &XslTransformerWorker::done,
-            worker, &XslTransformerWorker::deleteLater);
+    return &threadPool;
+}
+
+//==============================================================================
+
+static const int MaximumCachedOutputsCount = 10000;
+static const qint64 MaximumCacheDirSize = 64*1024*1024;   // 64 MB
+static const int CacheDirTrimInterval = 1000;
+
+//==============================================================================
+
+static void trimCacheDir(const QString &pCacheFileName, bool pCachedFileAdded)
+{
+    // Make sure that the directory where the given cache file is doesn't use
+    // more than its maximum size by removing its least recently used files
+    // Note #1: going through a cache directory is not cheap, so we only do it
+    //          the first time that we come across it and then once in a while,
+    //          as files get added to it...
+    // Note #2: the modification time of a cache file is updated whenever it
+    //          gets read (see XslTransformerWorker::run()), so it tells us when
+    //          it was last used...
+
+    static QMutex cacheDirsMutex;
+    static QSet<QString> cacheDirs;
+    static int cachedFilesAddedCount = 0;
+
+    QString cacheDirName = QFileInfo(pCacheFileName).path();
+
+    {
+        QMutexLocker locker(&cacheDirsMutex);
+
+        if (pCachedFileAdded && (++cachedFilesAddedCount%CacheDirTrimInterval == 0)) {
+            cacheDirs.remove(cacheDirName);
+        }
+
+        if (cacheDirs.contains(cacheDirName)) {
+            return;
+        }
+
+        cacheDirs << cacheDirName;
+    }
+
+    const QFileInfoList fileInfos = QDir(cacheDirName).entryInfoList(QDir::Files, QDir::Time);
+    qint64 cacheDirSize = 0;
+
+    for (const auto &fileInfo : fileInfos) {
+        cacheDirSize += fileInfo.size();
+
+        if (cacheDirSize > MaximumCacheDirSize) {
+            QFile::remove(fileInfo.absoluteFilePath());
+        }
+    }
+}
+
+//==============================================================================
+
+XslTransformerWorker::XslTransformerWorker(const QString &pInput,
+                                           const QString &pXsl,
+                                           const QString &pCacheFileName) :
+    mInput(pInput),
+    mXsl(pXsl),
+    mCacheFileName(pCacheFileName)
+{
+    // We will delete ourselves once our XSL transformation is done
+
+    setAutoDelete(false);
+}
+
+//==============================================================================
+
+void XslTransformerWorker::run()
+{
+    // Check whether our XSL transformation has already been done, i.e. whether
+    // its output is cached, be it in memory or on disk
+    // Note: our in-memory cache is shared by all our workers, hence it is
+    //       protected by a mutex...
+
+    static QMutex cachedOutputsMutex;
+    static QCache<QString, QString> cachedOutputs(MaximumCachedOutputsCount);
+
+    QString output;
+    bool cachedOutput = false;
+
+    if (!mCacheFileName.isEmpty()) {
+        QMutexLocker locker(&cachedOutputsMutex);
+        QString *memoryCachedOutput = cachedOutputs.object(mCacheFileName);
+
+        if (memoryCachedOutput != nullptr) {
+            output = *memoryCachedOutput;
+
+            cachedOutput = true;
+        }
+    }
+
+    if (!mCacheFileName.isEmpty()) {
+        trimCacheDir(mCacheFileName, false);
+    }
+
+    if (   !cachedOutput && !mCacheFileName.isEmpty()
+        &&  QFile::exists(mCacheFileName) && readFile(mCacheFileName, output)) {
+        {
+            QMutexLocker locker(&cachedOutputsMutex);
+
+            cachedOutputs.insert(mCacheFileName, new QString(output));
+        }
+
+        // Let our cache directory know that our cache file has just been used
+        // (see trimCacheDir())
+
+        QFile file(mCacheFileName);
+
+        if (file.open(QIODevice::ReadWrite)) {
+            file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+            file.close();
+        }
 
-    connect(thread, &QThread::finished,
-            thread, &QThread::deleteLater);
+        cachedOutput = true;
+    }
+
+    if (!cachedOutput) {
+        // Do the XSL transformation using the query, for our XSL, that was
+        // compiled by our thread, creating it if needed
+
+        static QThreadStorage<XslTransformerQueries> queries;
+
+        XslTransformerQueries &threadQueries = queries.localData();
+        QSharedPointer<XslTransformerQuery> query = threadQueries.value(mXsl);
+
+        if (query.isNull()) {
+            query = QSharedPointer<XslTransformerQuery>::create(mXsl);
+
+            threadQueries.insert(mXsl, query);
+        }
+
+        output = query->transform(mInput);
+
+        // Cache our output, if needed
+
+        if (!output.isEmpty() && !mCacheFileName.isEmpty()) {
+            {
+                QMutexLocker locker(&cachedOutputsMutex);
+
+                cachedOutputs.insert(mCacheFileName, new QString(output));
+            }
+
+            if (   QDir().mkpath(QFileInfo(mCacheFileName).path())
+                && writeFile(mCacheFileName, output)) {
+                trimCacheDir(mCacheFileName, true);
+            }
+        }
+    }
 
-    // Start our worker by starting the thread in which it is
+    // Let people know that our XSL transformation is done and delete ourselves
+
+    emit done(mInput, output);
+
+    deleteLater();
+}
+
+//==============================================================================
+
+void XslTransformer::transform(const QString &pInput, const QString &pXsl,
+                               const QString &pCacheFileName)
+{
+    // Create a worker for our XSL transformation and have it run by our thread
+    // pool
+    // Note: if a cache file name is given, then the output of our XSL
+    //       transformation will be cached both in memory and on disk (using
+    //       that file name)...
+
+    auto worker = new XslTransformerWorker(pInput, pXsl, pCacheFileName);
+
+    connect(worker, &XslTransformerWorker::done,
+            this, &XslTransformer::done);
 
-    thread->start();
+    xslTransformerThreadPool()->start(worker);
 }
 
 //==============================================================================
@@ -29,11 +29,13 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
-#include <QList>
-#include <QMutex>
 #include <QObject>
+#include <QRunnable>
 #include <QString>
-#include <QWaitCondition>
+
+//==============================================================================
+
+class QXmlQuery;
 
 //==============================================================================
 
@@ -42,18 +44,45 @@ namespace Core {
 
 //==============================================================================
 
-class XslTransformerWorker : public QObject
+class DummyMessageHandler;
+
+//==============================================================================
+
+class CORE_EXPORT XslTransformerQuery
+{
+public:
+    explicit XslTransformerQuery(const QString &pXsl);
+    ~XslTransformerQuery();
+
+    QString transform(const QString &pInput);
+
+    int compilationsCount() const;
+
+private:
+    Q_DISABLE_COPY(XslTransformerQuery)
+
+    DummyMessageHandler *mMessageHandler;
+    QXmlQuery *mXmlQuery;
+    QString mXsl;
+    int mCompilationsCount = 0;
+};
+
+//==============================================================================
+
+class XslTransformerWorker : public QObject, public QRunnable
 {
     Q_OBJECT
 
 public:
-    explicit XslTransformerWorker(const QString &pInput, const QString &pXsl);
+    explicit XslTransformerWorker(const QString &pInput, const QString &pXsl,
+                                  const QString &pCacheFileName);
 
-    void run();
+    void run() override;
 
 private:
     QString mInput;
     QString mXsl;
+    QString mCacheFileName;
 
 signals:
     void done(const QString &pInput, const QString &pOutput);
@@ -66,7 +95,8 @@ class CORE_EXPORT XslTransformer : public QObject
     Q_OBJECT
 
 public:
-    void transform(const QString &pInput, const QString &pXsl);
+    void transform(const QString &pInput, const QString &pXsl,
+                   const QString &pCacheFileName = {});
 
 signals:
     void done(const QString &pInput, const QString &pOutput);
@@ -27,6 +27,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 #include "clitests.h"
 #include "corecliutils.h"
+#include "pluginmanager.h"
 
 //==============================================================================
 
@@ -67,6 +68,88 @@ void CliTests::cliCommandTests()
 
 //==============================================================================
 
+void CliTests::cliCommandPluginsTests()
+{
+    // Some information about some of our plugins, including the CLI plugins
+    // that rely on Python and some solvers
+
+    QMap<QString, OpenCOR::PluginInfo *> pluginsInfo;
+
+    auto addPluginInfo = [&](const QString &pName,
+                             OpenCOR::PluginInfo::Category pCategory,
+                             bool pCliSupport,
+                             const QStringList &pDependencies) {
+        pluginsInfo.insert(pName, new OpenCOR::PluginInfo(pCategory, false, pCliSupport, pDependencies, {}));
+    };
+
+    addPluginInfo("CellMLAPI", OpenCOR::PluginInfo::Category::ThirdParty, false, {});
+    addPluginInfo("CellMLSupport", OpenCOR::PluginInfo::Category::Support, false, { "CellMLAPI", "Compiler", "StandardSupport" });
+    addPluginInfo("CellMLTools", OpenCOR::PluginInfo::Category::Tools, true, { "CellMLSupport" });
+    addPluginInfo("COMBINESupport", OpenCOR::PluginInfo::Category::Support, false, {});
+    addPluginInfo("Compiler", OpenCOR::PluginInfo::Category::Miscellaneous, false, { "Core", "LLVMClang" });
+    addPluginInfo("Core", OpenCOR::PluginInfo::Category::Miscellaneous, false, {});
+    addPluginInfo("CVODESolver", OpenCOR::PluginInfo::Category::Solver, false, { "SUNDIALS" });
+    addPluginInfo("DataStore", OpenCOR::PluginInfo::Category::DataStore, false, {});
+    addPluginInfo("ForwardEulerSolver", OpenCOR::PluginInfo::Category::Solver, false, {});
+    addPluginInfo("JupyterKernel", OpenCOR::PluginInfo::Category::Miscellaneous, true, { "Core", "SimulationSupport" });
+    addPluginInfo("LLVMClang", OpenCOR::PluginInfo::Category::ThirdParty, false, {});
+    addPluginInfo("Python", OpenCOR::PluginInfo::Category::ThirdParty, false, {});
+    addPluginInfo("PythonPackages", OpenCOR::PluginInfo::Category::ThirdParty, false, {});
+    addPluginInfo("PythonQt", OpenCOR::PluginInfo::Category::ThirdParty, false, {});
+    addPluginInfo("PythonQtSupport", OpenCOR::PluginInfo::Category::Support, false, { "PythonQt", "PythonSupport" });
+    addPluginInfo("PythonShell", OpenCOR::PluginInfo::Category::Miscellaneous, true, { "Core", "PythonQtSupport", "SimulationSupport" });
+    addPluginInfo("PythonSupport", OpenCOR::PluginInfo::Category::Support, false, { "Python", "PythonPackages" });
+    addPluginInfo("SimulationSupport", OpenCOR::PluginInfo::Category::Support, false, { "COMBINESupport", "DataStore", "PythonQtSupport", "ToolBarWidget" });
+    addPluginInfo("StandardSupport", OpenCOR::PluginInfo::Category::Support, false, { "Core" });
+    addPluginInfo("SUNDIALS", OpenCOR::PluginInfo::Category::ThirdParty, false, {});
+    addPluginInfo("ToolBarWidget", OpenCOR::PluginInfo::Category::Widget, false, {});
+
+    QStringList pluginNames = pluginsInfo.keys();
+    QStringList neededPlugins;
+
+    // Make sure that running a command of all our CLI plugins loads all of them
+    // (and their dependencies), as well as our solvers
+
+    QStringList plugins = OpenCOR::PluginManager::pluginsToLoad(pluginsInfo, pluginNames, false, {}, neededPlugins);
+
+    for (const auto &plugin : { "CellMLTools", "JupyterKernel", "PythonShell", "PythonQtSupport", "SimulationSupport", "CVODESolver", "ForwardEulerSolver" }) {
+        QVERIFY(plugins.contains(plugin));
+    }
+
+    // Make sure that running a command of a given CLI plugin (e.g. running
+    // -c CellMLTools::help) only loads that plugin and its dependencies, in the
+    // right order, as well as our solvers, i.e. neither the Python Shell nor
+    // the Jupyter kernel plugins, nor the Python plugins they rely on
+
+    plugins = OpenCOR::PluginManager::pluginsToLoad(pluginsInfo, pluginNames, false, { "CellMLTools" }, neededPlugins);
+
+    QCOMPARE(plugins.count(), 10);
+
+    for (const auto &plugin : { "CellMLAPI", "CellMLSupport", "CellMLTools", "Compiler", "Core", "CVODESolver", "ForwardEulerSolver", "LLVMClang", "StandardSupport", "SUNDIALS" }) {
+        QVERIFY(plugins.contains(plugin));
+    }
+
+    for (const auto &plugin : { "JupyterKernel", "PythonShell", "PythonQtSupport", "PythonSupport", "Python", "SimulationSupport" }) {
+        QVERIFY(!plugins.contains(plugin));
+    }
+
+    QVERIFY(plugins.indexOf("Core") < plugins.indexOf("Compiler"));
+    QVERIFY(plugins.indexOf("Compiler") < plugins.indexOf("CellMLSupport"));
+    QVERIFY(plugins.indexOf("CellMLSupport") < plugins.indexOf("CellMLTools"));
+    QVERIFY(plugins.indexOf("SUNDIALS") < plugins.indexOf("CVODESolver"));
+
+    // Make sure that running a command of an unknown plugin only loads our
+    // solvers (and their dependencies)
+
+    plugins = OpenCOR::PluginManager::pluginsToLoad(pluginsInfo, pluginNames, false, { "Unknown" }, neededPlugins);
+
+    QCOMPARE(plugins, QStringList({ "SUNDIALS", "CVODESolver", "ForwardEulerSolver" }));
+
+    qDeleteAll(pluginsInfo);
+}
+
+//==============================================================================
+
 void CliTests::cliExcludeTests()
 {
     // Exclude some plugins
@@ -39,6 +39,7 @@ private:
 private slots:
     void cliAboutTests();
     void cliCommandTests();
+    void cliCommandPluginsTests();
     void cliExcludeTests();
     void cliHelpTests();
     void cliIncludeTests();
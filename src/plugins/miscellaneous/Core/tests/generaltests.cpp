@@ -22,6 +22,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 //==============================================================================
 
 #include "corecliutils.h"
+#include "file.h"
 #include "generaltests.h"
 
 //==============================================================================
@@ -464,6 +465,93 @@ void GeneralTests::checkFileNameOrUrl()
 
 //==============================================================================
 
+static void updateFile(const QString &pFileName, const QByteArray &pContents,
+                       int pSecondsOffset)
+{
+    // Update the contents of the given file and its modification time, making
+    // sure that the latter is different from the one it had
+
+    QVERIFY(OpenCOR::Core::writeFile(pFileName, pContents));
+
+    QFile file(pFileName);
+
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.setFileTime(QDateTime::currentDateTime().addSecs(pSecondsOffset),
+                             QFileDevice::FileModificationTime));
+
+    file.close();
+}
+
+//==============================================================================
+
+void GeneralTests::fileCheckTests()
+{
+    // Create a file with a dependency
+
+    QString fileName = OpenCOR::Core::temporaryFileName();
+    QString dependencyFileName = OpenCOR::Core::temporaryFileName();
+
+    updateFile(fileName, "A", 0);
+    updateFile(dependencyFileName, "B", 0);
+
+    OpenCOR::Core::File file(fileName, OpenCOR::Core::File::Type::Local, QString());
+
+    file.setDependencies({ dependencyFileName });
+
+    QVERIFY(!file.mayHaveChanged());
+    QVERIFY(file.check() == OpenCOR::Core::File::Status::Unchanged);
+
+    // Touch our file, i.e. change its stamp, but not its contents, and make
+    // sure that it may have changed, but that its SHA-1 value tells us that it
+    // hasn't, after which it shouldn't be considered as possibly changed
+    // anymore
+
+    updateFile(fileName, "A", 10);
+
+    QVERIFY(file.mayHaveChanged());
+    QVERIFY(file.check(OpenCOR::Core::File::stamp(fileName),
+                       OpenCOR::Core::File::sha1(fileName),
+                       { OpenCOR::Core::File::stamp(dependencyFileName) },
+                       { OpenCOR::Core::File::sha1(dependencyFileName) }) == OpenCOR::Core::File::Status::Unchanged);
+    QVERIFY(!file.mayHaveChanged());
+
+    // Change the contents of our file, but not its size, and make sure that it
+    // is seen as changed
+
+    updateFile(fileName, "C", 20);
+
+    QVERIFY(file.mayHaveChanged());
+    QVERIFY(file.check(OpenCOR::Core::File::stamp(fileName),
+                       OpenCOR::Core::File::sha1(fileName),
+                       { OpenCOR::Core::File::stamp(dependencyFileName) },
+                       { OpenCOR::Core::File::sha1(dependencyFileName) }) == OpenCOR::Core::File::Status::Changed);
+
+    file.reset(false);
+
+    QVERIFY(!file.mayHaveChanged());
+
+    // Change the contents of our dependency and make sure that it is seen as
+    // changed
+
+    updateFile(dependencyFileName, "D", 30);
+
+    QVERIFY(file.mayHaveChanged());
+    QVERIFY(file.check() == OpenCOR::Core::File::Status::DependenciesChanged);
+
+    // Delete our file and make sure that it is seen as deleted
+
+    QFile::remove(fileName);
+
+    QVERIFY(file.mayHaveChanged());
+    QVERIFY(file.check() == OpenCOR::Core::File::Status::Deleted);
+
+    // Clean up after ourselves
+
+    QFile::remove(dependencyFileName);
+}
+
+//==============================================================================
+
 QTEST_GUILESS_MAIN(GeneralTests)
 
 //==============================================================================
@@ -48,6 +48,7 @@ private slots:
     void stringLineColumnAsPositionTests();
     void newFileNameTests();
     void checkFileNameOrUrl();
+    void fileCheckTests();
 };
 
 //==============================================================================
@@ -27,6 +27,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 #include "corecliutils.h"
 #include "mathmltests.h"
+#include "xsltransformer.h"
 
 //==============================================================================
 
@@ -285,6 +286,32 @@ void MathmlTests::trigonometricTests()
 
 //==============================================================================
 
+void MathmlTests::compiledQueryTests()
+{
+    // Convert some Content MathML to Presentation MathML using the same XSL
+    // transformer query, i.e. making sure that our XSL only needs to be
+    // compiled once
+
+    OpenCOR::Core::XslTransformerQuery xslTransformerQuery(mQuery);
+
+    for (const auto &category : QStringList() << "plus" << "minus" << "times" << "divide") {
+        QString dirName = OpenCOR::dirName("src/plugins/miscellaneous/Core/tests/data")+"/"+category+"/";
+        const QStringList fileNames = QDir(dirName).entryList({ "*.in" });
+
+        for (const auto &fileName : fileNames) {
+            QString actualOutput = xslTransformerQuery.transform(OpenCOR::rawFileContents(dirName+fileName));
+
+            QVERIFY(!actualOutput.isEmpty());
+            QCOMPARE(OpenCOR::Core::formatXml(OpenCOR::Core::cleanPresentationMathml(actualOutput)),
+                     OpenCOR::rawFileContents(QString(dirName+fileName).replace(".in", ".out")));
+        }
+    }
+
+    QCOMPARE(xslTransformerQuery.compilationsCount(), 1);
+}
+
+//==============================================================================
+
 QTEST_GUILESS_MAIN(MathmlTests)
 
 //==============================================================================
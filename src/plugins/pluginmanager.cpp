@@ -32,7 +32,12 @@ along with this program. If not, see <https://gnu.org/licenses>.
 //==============================================================================
 
 #include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
 
 //==============================================================================
 
@@ -40,7 +45,269 @@ namespace OpenCOR {
 
 //==============================================================================
 
-PluginManager::PluginManager(bool pGuiMode) :
+static const quint32 PluginManifestMagicNumber = 0x4f43504d;   // OCPM
+static const qint32 PluginManifestVersion = 1;
+
+//==============================================================================
+
+static QString pluginManifestFileName()
+{
+    // Return the name of the file where we keep our plugin manifest
+
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)+"/Plugins.manifest";
+}
+
+//==============================================================================
+
+static QString pluginManifestKey()
+{
+    // Return the key of our plugin manifest, which is based on both our version
+    // of PluginInfo and our executable
+    // Note: this means that our plugin manifest gets invalidated whenever a new
+    //       version of OpenCOR gets installed...
+
+    QFileInfo fileInfo(QCoreApplication::applicationFilePath());
+
+    return  QString::number(pluginInfoVersion())
+           +"|"+fileInfo.canonicalFilePath()
+           +"|"+QString::number(fileInfo.lastModified().toMSecsSinceEpoch())
+           +"|"+QString::number(fileInfo.size());
+}
+
+//==============================================================================
+
+static QDataStream & operator<<(QDataStream &pStream,
+                                const PluginManifestEntry &pEntry)
+{
+    // Write the given plugin manifest entry to the given stream
+
+    pStream << pEntry.lastModified << pEntry.size << pEntry.hasInfo
+            << pEntry.category << pEntry.selectable << pEntry.cliSupport
+            << pEntry.dependencies << pEntry.descriptions << pEntry.loadBefore
+            << pEntry.errorMessage;
+
+    return pStream;
+}
+
+//==============================================================================
+
+static QDataStream & operator>>(QDataStream &pStream,
+                                PluginManifestEntry &pEntry)
+{
+    // Read a plugin manifest entry from the given stream
+
+    pStream >> pEntry.lastModified >> pEntry.size >> pEntry.hasInfo
+            >> pEntry.category >> pEntry.selectable >> pEntry.cliSupport
+            >> pEntry.dependencies >> pEntry.descriptions >> pEntry.loadBefore
+            >> pEntry.errorMessage;
+
+    return pStream;
+}
+
+//==============================================================================
+
+PluginManifest PluginManager::pluginManifest()
+{
+    // Retrieve our plugin manifest, if it exists and is still valid
+
+    QFile file(pluginManifestFileName());
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    QDataStream stream(&file);
+    quint32 magicNumber;
+    qint32 version;
+    QString key;
+
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    stream >> magicNumber >> version >> key;
+
+    if (   (stream.status() != QDataStream::Ok)
+        || (magicNumber != PluginManifestMagicNumber)
+        || (version != PluginManifestVersion)
+        || (key != pluginManifestKey())) {
+        return {};
+    }
+
+    PluginManifest res;
+
+    stream >> res;
+
+    if (stream.status() != QDataStream::Ok) {
+        return {};
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+void PluginManager::setPluginManifest(const PluginManifest &pManifest)
+{
+    // Save our plugin manifest
+    // Note: we use a QSaveFile object so that another instance of OpenCOR
+    //       cannot end up reading a partially written plugin manifest...
+
+    QString fileName = pluginManifestFileName();
+
+    if (!QDir().mkpath(QFileInfo(fileName).path())) {
+        return;
+    }
+
+    QSaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    stream << PluginManifestMagicNumber << PluginManifestVersion
+           << pluginManifestKey() << pManifest;
+
+    if (stream.status() == QDataStream::Ok) {
+        file.commit();
+    } else {
+        file.cancelWriting();
+    }
+}
+
+//==============================================================================
+
+PluginManifestEntry PluginManager::pluginManifestEntry(const QString &pFileName)
+{
+    // Retrieve the information about the given plugin, something that requires
+    // loading it
+
+    QFileInfo fileInfo(pFileName);
+    PluginManifestEntry res;
+
+    res.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    res.size = fileInfo.size();
+
+    if (Plugin::pluginInfoVersion(pFileName) == pluginInfoVersion()) {
+        PluginInfo *pluginInfo = Plugin::info(pFileName, &res.errorMessage);
+
+        if (pluginInfo != nullptr) {
+            res.hasInfo = true;
+            res.category = qint32(pluginInfo->category());
+            res.selectable = pluginInfo->isSelectable();
+            res.cliSupport = pluginInfo->hasCliSupport();
+            res.dependencies = pluginInfo->dependencies();
+            res.descriptions = pluginInfo->descriptions();
+            res.loadBefore = pluginInfo->loadBefore();
+
+            delete pluginInfo;
+        }
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+QStringList PluginManager::fullDependencies(const QMap<QString, PluginInfo *> &pPluginsInfo,
+                                            const QString &pName, int pLevel)
+{
+    // Return the given plugin's full dependencies
+    // Note: this is similar to Plugin::fullDependencies(), except that we rely
+    //       on the plugin information we already have rather than on loading
+    //       the plugin and its dependencies...
+
+    QStringList res;
+
+    // Recursively look for the plugin's full dependencies
+
+    PluginInfo *pluginInfo = pPluginsInfo.value(pName);
+
+    if (pluginInfo == nullptr) {
+        return res;
+    }
+
+    const QStringList dependencies = pluginInfo->dependencies();
+
+    for (const auto &plugin : dependencies) {
+        res << fullDependencies(pPluginsInfo, plugin, pLevel+1);
+    }
+
+    // Add the current plugin to the list, but only if it is not the original
+    // plugin, otherwise remove any duplicates
+
+    if (pLevel != 0) {
+        res << pName;
+    } else {
+        res.removeDuplicates();
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+QStringList PluginManager::pluginsToLoad(const QMap<QString, PluginInfo *> &pPluginsInfo,
+                                         const QStringList &pSortedPluginNames,
+                                         bool pGuiMode,
+                                         const QStringList &pCliPlugins,
+                                         QStringList &pNeededPlugins)
+{
+    // Determine which plugins, if any, are needed by others and which, if any,
+    // are selectable
+
+    QStringList wantedPlugins;
+
+    pNeededPlugins.clear();
+
+    for (const auto &pluginName : pSortedPluginNames) {
+        PluginInfo *pluginInfo = pPluginsInfo.value(pluginName);
+
+        if (pluginInfo != nullptr) {
+            // Keep track of the plugin itself, should it be selectable and
+            // requested by the user (if we are in GUI mode), or have CLI
+            // support (or be one of the CLI plugins we were asked for) or is a
+            // solver (if we are in CLI mode)
+            // Note: asking for specific CLI plugins means that a command sent
+            //       to one of them doesn't require loading all our other CLI
+            //       plugins (and their dependencies)...
+
+            if (   ( pGuiMode && pluginInfo->isSelectable() && Plugin::load(pluginName))
+                || (   !pGuiMode
+                    && (   (pCliPlugins.isEmpty() && pluginInfo->hasCliSupport())
+                        || pCliPlugins.contains(pluginName)
+                        || (pluginInfo->category() == PluginInfo::Category::Solver)))) {
+                // Keep track of the plugin's dependencies
+
+                pNeededPlugins << fullDependencies(pPluginsInfo, pluginName);
+
+                // Also keep track of the plugin itself
+
+                wantedPlugins << pluginName;
+            }
+        }
+    }
+
+    // We now have all our needed and wanted plugins with our needed plugins
+    // nicely sorted based on their dependencies with one another
+
+    QStringList res = pNeededPlugins+wantedPlugins;
+
+    res.removeDuplicates();
+    // Note: if anything, there should only be duplicates in pNeededPlugins,
+    //       and not between pNeededPlugins and wantedPlugins. Then again, we
+    //       better be safe than sorry since a selectable plugin (i.e. listed in
+    //       wantedPlugins) might be (wrongly) needed by another plugin (i.e.
+    //       listed in pNeededPlugins)...
+
+    return res;
+}
+
+//==============================================================================
+
+PluginManager::PluginManager(bool pGuiMode, const QStringList &pCliPlugins) :
     mGuiMode(pGuiMode)
 {
     // Retrieve OpenCOR's plugins directory
@@ -60,28 +327,63 @@ PluginManager::PluginManager(bool pGuiMode) :
         fileNames << fileInfo.canonicalFilePath();
     }
 
-    // Retrieve and initialise some information about the plugins
-
+    // Retrieve and initialise some information about the plugins, using our
+    // manifest whenever possible, so that we don't have to load a plugin to
+    // retrieve its information unless it was added or modified since we last
+    // retrieved it
+    // Note: a plugin that couldn't be loaded may be loadable next time (e.g.
+    //       if one of the libraries it needs has since been installed) without
+    //       it having been modified, so we never keep track of such a plugin in
+    //       our manifest, i.e. we always load it to retrieve its information...
+
+    PluginManifest manifest = pluginManifest();
+    PluginManifest newManifest;
+    bool manifestChanged = false;
     QMap<QString, PluginInfo *> pluginsInfo;
     QMap<QString, QString> pluginsError;
 
     for (const auto &fileName : fileNames) {
+        QFileInfo fileInfo(fileName);
+        PluginManifestEntry entry = manifest.value(fileName);
+
+        if (   !manifest.contains(fileName)
+            || (entry.lastModified != fileInfo.lastModified().toMSecsSinceEpoch())
+            || (entry.size != fileInfo.size())) {
+            entry = pluginManifestEntry(fileName);
+
+            manifestChanged = manifestChanged || entry.errorMessage.isEmpty();
+        }
+
+        if (entry.errorMessage.isEmpty()) {
+            newManifest.insert(fileName, entry);
+        }
+
         QString pluginName = Plugin::name(fileName);
-        QString pluginError;
-        PluginInfo *pluginInfo = (Plugin::pluginInfoVersion(fileName) == pluginInfoVersion())?
-                                     Plugin::info(fileName, &pluginError):
-                                     nullptr;
 
-        pluginsInfo.insert(pluginName, pluginInfo);
-        pluginsError.insert(pluginName, pluginError);
+        pluginsInfo.insert(pluginName, entry.hasInfo?
+                                           new PluginInfo(PluginInfo::Category(entry.category),
+                                                          entry.selectable,
+                                                          entry.cliSupport,
+                                                          entry.dependencies,
+                                                          entry.descriptions,
+                                                          entry.loadBefore):
+                                           nullptr);
+        pluginsError.insert(pluginName, entry.errorMessage);
+    }
 
-        // Keep track of the plugin's full dependencies, if possible
-        // Note: if there is some plugin information, then it will get owned by
-        //       the plugin itself. So, it will be the plugin's responsibility
-        //       to delete it (see Plugin::~Plugin())...
+    if (manifestChanged || (newManifest.count() != manifest.count())) {
+        setPluginManifest(newManifest);
+    }
 
-        if (pluginInfo != nullptr) {
-            pluginInfo->setFullDependencies(Plugin::fullDependencies(mPluginsDir, pluginName));
+    // Keep track of the plugins' full dependencies
+    // Note: if there is some plugin information, then it will get owned by the
+    //       plugin itself. So, it will be the plugin's responsibility to delete
+    //       it (see Plugin::~Plugin())...
+
+    for (auto pluginInfo = pluginsInfo.constBegin(), pluginInfoEnd = pluginsInfo.constEnd();
+         pluginInfo != pluginInfoEnd; ++pluginInfo) {
+        if (pluginInfo.value() != nullptr) {
+            pluginInfo.value()->setFullDependencies(fullDependencies(pluginsInfo, pluginInfo.key()));
         }
     }
 
@@ -108,48 +410,19 @@ PluginManager::PluginManager(bool pGuiMode) :
         }
     }
 
-    // Determine which plugins, if any, are needed by others and which, if any,
-    // are selectable
+    // Determine which plugins we need and want, and retrieve their file name
 
-    QStringList neededPlugins;
-    QStringList wantedPlugins;
+    QStringList sortedPluginNames;
 
     for (const auto &fileName : sortedFileNames) {
-        QString pluginName = Plugin::name(fileName);
-        PluginInfo *pluginInfo = pluginsInfo.value(pluginName);
-
-        if (pluginInfo != nullptr) {
-            // Keep track of the plugin itself, should it be selectable and
-            // requested by the user (if we are in GUI mode), or have CLI
-            // support or is a solver (if we are in CLI mode)
-
-            if (   ( pGuiMode && pluginInfo->isSelectable() && Plugin::load(pluginName))
-                || (!pGuiMode && (pluginInfo->hasCliSupport() || (pluginInfo->category() == PluginInfo::Category::Solver)))) {
-                // Keep track of the plugin's dependencies
-
-                neededPlugins << pluginsInfo.value(pluginName)->fullDependencies();
-
-                // Also keep track of the plugin itself
-
-                wantedPlugins << pluginName;
-            }
-        }
+        sortedPluginNames << Plugin::name(fileName);
     }
 
-    // We now have all our needed and wanted plugins with our needed plugins
-    // nicely sorted based on their dependencies with one another, so retrieve
-    // their file name
-
-    QStringList plugins = neededPlugins+wantedPlugins;
+    QStringList neededPlugins;
+    QStringList plugins = pluginsToLoad(pluginsInfo, sortedPluginNames,
+                                        pGuiMode, pCliPlugins, neededPlugins);
     QStringList pluginFileNames;
 
-    plugins.removeDuplicates();
-    // Note: if anything, there should only be duplicates in neededPlugins, and
-    //       not between neededPlugins and wantedPlugins. Then again, we better
-    //       be safe than sorry since a selectable plugin (i.e. listed in
-    //       wantedPlugins) might be (wrongly) needed by another plugin (i.e.
-    //       listed in neededPlugins)...
-
     for (const auto &plugin : plugins) {
         pluginFileNames << Plugin::fileName(mPluginsDir, plugin);
     }
@@ -30,6 +30,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QMap>
 #include <QObject>
 
 //==============================================================================
@@ -42,12 +43,35 @@ namespace OpenCOR {
 
 //==============================================================================
 
+struct PluginManifestEntry
+{
+    qint64 lastModified = 0;
+    qint64 size = 0;
+
+    bool hasInfo = false;
+    qint32 category = qint32(PluginInfo::Category::Invalid);
+    bool selectable = false;
+    bool cliSupport = false;
+    QStringList dependencies;
+    Descriptions descriptions;
+    QStringList loadBefore;
+
+    QString errorMessage;
+};
+
+//==============================================================================
+
+using PluginManifest = QMap<QString, PluginManifestEntry>;
+
+//==============================================================================
+
 class PluginManager : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit PluginManager(bool pGuiMode = true);
+    explicit PluginManager(bool pGuiMode = true,
+                           const QStringList &pCliPlugins = {});
     ~PluginManager() override;
 
     bool guiMode() const;
@@ -61,6 +85,12 @@ public:
     Plugin * plugin(const QString &pName) const;
     Plugin * corePlugin() const;
 
+    static QStringList pluginsToLoad(const QMap<QString, PluginInfo *> &pPluginsInfo,
+                                     const QStringList &pSortedPluginNames,
+                                     bool pGuiMode,
+                                     const QStringList &pCliPlugins,
+                                     QStringList &pNeededPlugins);
+
 private:
     bool mGuiMode;
 
@@ -70,6 +100,13 @@ private:
     Plugins mLoadedPlugins;
 
     Plugin *mCorePlugin = nullptr;
+
+    static PluginManifest pluginManifest();
+    static void setPluginManifest(const PluginManifest &pManifest);
+    static PluginManifestEntry pluginManifestEntry(const QString &pFileName);
+
+    static QStringList fullDependencies(const QMap<QString, PluginInfo *> &pPluginsInfo,
+                                        const QString &pName, int pLevel = 0);
 };
 
 //==============================================================================
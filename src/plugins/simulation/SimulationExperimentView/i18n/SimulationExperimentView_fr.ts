@@ -297,6 +297,10 @@
         <source>Legend</source>
         <translation>Légende</translation>
     </message>
+    <message>
+        <source>Plotted variables only</source>
+        <translation>Variables tracées uniquement</translation>
+    </message>
     <message>
         <source>Line</source>
         <translation>Ligne</translation>
@@ -636,6 +640,14 @@
         <source>%1 using %2</source>
         <translation>%1 avec %2</translation>
     </message>
+    <message>
+        <source>NLA system #%1:</source>
+        <translation>Système NLA n°%1 :</translation>
+    </message>
+    <message>
+        <source>%1 solves, %2 iterations, %3 Jacobian evaluations, maximum residual norm of %4</source>
+        <translation>%1 résolutions, %2 itérations, %3 évaluations de la jacobienne, norme maximale du résidu de %4</translation>
+    </message>
     <message>
         <source>Error:</source>
         <translation>Erreur :</translation>
@@ -1435,6 +1435,15 @@ void SimulationExperimentViewSimulationWidget::runPauseResumeSimulation()
         if (mSimulation->isPaused()) {
             mSimulation->resume();
         } else {
+            // Determine which variables should be recorded, i.e. either all of
+            // them or only those that are plotted, if requested
+
+            mSimulation->results()->setRecordedVariables(PreferencesInterface::preference(PluginName,
+                                                                                          SettingsPreferencesGraphPanelPlottedOnly,
+                                                                                          SettingsPreferencesGraphPanelPlottedOnlyDefault).toBool()?
+                                                             mViewWidget->plottedVariables(mSimulation->fileName()):
+                                                             QStringList());
+
             // Try to allocate all the memory we need by adding a run to our
             // simulation and, if successful, run our simulation
 
@@ -3144,6 +3153,22 @@ void SimulationExperimentViewSimulationWidget::simulationDone(qint64 pElapsedTim
 
         output(QString(QString()+OutputTab+"<strong>"+tr("Simulation time:")+"</strong> <span "+OutputInfo+">"+tr("%1 using %2").arg(Core::formatTime(pElapsedTime),
                                                                                                                                     solversInformation)+"</span>."+OutputBrLn));
+
+        // Output some statistics about the NLA systems that were solved, if
+        // any
+
+        const Solver::NlaSolver::Statistics nlaSolverStatistics = mSimulation->nlaSolverStatistics();
+
+        for (int i = 0, iMax = nlaSolverStatistics.count(); i < iMax; ++i) {
+            const Solver::NlaSystemStatistics &nlaSystemStatistics = nlaSolverStatistics[i];
+
+            if (nlaSystemStatistics.solvesCount() != 0) {
+                output(QString(QString()+OutputTab+"<strong>"+tr("NLA system #%1:").arg(i+1)+"</strong> <span "+OutputInfo+">"+tr("%1 solves, %2 iterations, %3 Jacobian evaluations, maximum residual norm of %4").arg(nlaSystemStatistics.solvesCount())
+                                                                                                                                                                                                          .arg(nlaSystemStatistics.iterationsCount())
+                                                                                                                                                                                                          .arg(nlaSystemStatistics.jacobianEvaluationsCount())
+                                                                                                                                                                                                          .arg(nlaSystemStatistics.maximumResidualNorm())+"</span>."+OutputBrLn));
+            }
+        }
     }
 
     // Update our parameters and simulation mode
@@ -3702,6 +3727,32 @@ double * SimulationExperimentViewSimulationWidget::data(SimulationSupport::Simul
 
 //==============================================================================
 
+QStringList SimulationExperimentViewSimulationWidget::plottedVariables(const QString &pFileName) const
+{
+    // Return the URI of the variables, from the given file, that are plotted
+    // by any of our valid graphs
+
+    QStringList res;
+
+    for (auto plot : qAsConst(mPlots)) {
+        const GraphPanelWidget::GraphPanelPlotGraphs graphs = plot->graphs();
+
+        for (auto graph : graphs) {
+            if (graph->isValid() && (graph->fileName() == pFileName)) {
+                auto parameterX = static_cast<CellMLSupport::CellmlFileRuntimeParameter *>(graph->parameterX());
+                auto parameterY = static_cast<CellMLSupport::CellmlFileRuntimeParameter *>(graph->parameterY());
+
+                res << SimulationSupport::SimulationResults::uri(parameterX->componentHierarchy(), parameterX->formattedName())
+                    << SimulationSupport::SimulationResults::uri(parameterY->componentHierarchy(), parameterY->formattedName());
+            }
+        }
+    }
+
+    return res;
+}
+
+//==============================================================================
+
 void SimulationExperimentViewSimulationWidget::updateGraphData(GraphPanelWidget::GraphPanelPlotGraph *pGraph,
                                                                quint64 pSize,
                                                                int pRun)
@@ -3768,6 +3819,19 @@ void SimulationExperimentViewSimulationWidget::updateSimulationResults(Simulatio
 
     if (simulation == mSimulation) {
         simulationDataModified(simulation->data()->isModified());
+
+        // Update our parameters every so often, if our simulation is running
+        // Note: our simulation worker recomputes our rates and algebraic
+        //       variables at the same rate, should our simulation results not
+        //       need them (see SimulationWorker::run())...
+
+        if (   simulation->isRunning()
+            && (   !mParametersTimer.isValid()
+                || (mParametersTimer.elapsed() >= SimulationSupport::VariablesRefreshInterval))) {
+            mContentsWidget->informationWidget()->parametersWidget()->updateParameters(simulation->currentPoint());
+
+            mParametersTimer.start();
+        }
     }
 
     // Update all the graphs of all our plots, but only if we are visible
@@ -3835,31 +3899,48 @@ void SimulationExperimentViewSimulationWidget::updateSimulationResults(Simulatio
                     // plot's viewport since we last came here (e.g. by panning
                     // the plot's contents)
 
+                    // Note: our graph's run keeps track of its bounding
+                    //       rectangle, which is extended with every new
+                    //       segment. So, if it fits within our plot's current
+                    //       viewport, then so does our new segment, and there
+                    //       is no need to scan it. Otherwise, we must still scan
+                    //       our new segment since our plot's current viewport
+                    //       may not contain our previous segments (e.g. if its
+                    //       axes have fixed ranges)...
+
                     if (!plot->hasDirtyAxes()) {
-                        double minX = plotMinX;
-                        double maxX = plotMaxX;
-                        double minY = plotMinY;
-                        double maxY = plotMaxY;
-
-                        for (quint64 i = (oldDataSize != 0)?oldDataSize-1:0;
-                             i < pSimulationResultsSize; ++i) {
-                            double valX = graph->data(pSimulationRun)->sample(i).x();
-                            double valY = graph->data(pSimulationRun)->sample(i).y();
-
-                            if (   !qIsInf(valX) && !qIsNaN(valX)
-                                && !qIsInf(valY) && !qIsNaN(valY)) {
-                                minX = qMin(minX, valX);
-                                maxX = qMax(maxX, valX);
-                                minY = qMin(minY, valY);
-                                maxY = qMax(maxY, valY);
+                        QRectF boundingRect = graph->boundingRect(pSimulationRun);
+
+                        if (   (boundingRect.width() < 0.0)
+                            || (boundingRect.left() < plotMinX)
+                            || (boundingRect.left()+boundingRect.width() > plotMaxX)
+                            || (boundingRect.top() < plotMinY)
+                            || (boundingRect.top()+boundingRect.height() > plotMaxY)) {
+                            double minX = plotMinX;
+                            double maxX = plotMaxX;
+                            double minY = plotMinY;
+                            double maxY = plotMaxY;
+
+                            for (quint64 i = (oldDataSize != 0)?oldDataSize-1:0;
+                                 i < pSimulationResultsSize; ++i) {
+                                double valX = graph->data(pSimulationRun)->sample(i).x();
+                                double valY = graph->data(pSimulationRun)->sample(i).y();
+
+                                if (   !qIsInf(valX) && !qIsNaN(valX)
+                                    && !qIsInf(valY) && !qIsNaN(valY)) {
+                                    minX = qMin(minX, valX);
+                                    maxX = qMax(maxX, valX);
+                                    minY = qMin(minY, valY);
+                                    maxY = qMax(maxY, valY);
+                                }
                             }
-                        }
 
-                        // Update our plot, if our graph segment cannot fit
-                        // within our plot's current viewport
+                            // Update our plot, if our graph segment cannot fit
+                            // within our plot's current viewport
 
-                        needFullUpdatePlot =    (minX < plotMinX) || (maxX > plotMaxX)
-                                             || (minY < plotMinY) || (maxY > plotMaxY);
+                            needFullUpdatePlot =    (minX < plotMinX) || (maxX > plotMaxX)
+                                                 || (minY < plotMinY) || (maxY > plotMaxY);
+                        }
                     }
 
                     if (!needFullUpdatePlot) {
@@ -33,6 +33,10 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QElapsedTimer>
+
+//==============================================================================
+
 class QFrame;
 class QLabel;
 class QMenu;
@@ -179,6 +183,8 @@ public:
 
     void resetSimulationProgress();
 
+    QStringList plottedVariables(const QString &pFileName) const;
+
 protected:
     void changeEvent(QEvent *pEvent) override;
     void dragEnterEvent(QDragEnterEvent *pEvent) override;
@@ -288,6 +294,8 @@ private:
 
     QHash<GraphPanelWidget::GraphPanelPlotGraph *, quint64> mOldDataSizes;
 
+    QElapsedTimer mParametersTimer;
+
     QMap<QString, FileTypeInterface *> mFileTypeInterfaces;
 
     QString styledOutput();
@@ -518,6 +518,24 @@ quint64 SimulationExperimentViewWidget::simulationResultsSize(const QString &pFi
 
 //==============================================================================
 
+QStringList SimulationExperimentViewWidget::plottedVariables(const QString &pFileName) const
+{
+    // Return the URI of the variables, from the given file, that are plotted by
+    // any of our simulation widgets
+
+    QStringList res;
+
+    for (auto simulationWidget : mSimulationWidgets) {
+        res << simulationWidget->plottedVariables(pFileName);
+    }
+
+    res.removeDuplicates();
+
+    return res;
+}
+
+//==============================================================================
+
 void SimulationExperimentViewWidget::checkSimulationResults(const QString &pFileName,
                                                             SimulationExperimentViewSimulationWidget::Task pTask)
 {
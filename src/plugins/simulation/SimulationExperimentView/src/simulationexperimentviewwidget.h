@@ -98,6 +98,8 @@ public:
 
     quint64 simulationResultsSize(const QString &pFileName) const;
 
+    QStringList plottedVariables(const QString &pFileName) const;
+
     void checkSimulationResults(const QString &pFileName,
                                 SimulationExperimentViewSimulationWidget::Task pTask = SimulationExperimentViewSimulationWidget::Task::None);
 
@@ -41,6 +41,12 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+//==============================================================================
+
 namespace OpenCOR {
 namespace CVODESolver {
 
@@ -62,6 +68,173 @@ int rhsFunction(double pVoi, N_Vector pStates, N_Vector pRates, void *pUserData)
 
 //==============================================================================
 
+int rootsFunction(double pVoi, N_Vector pStates, double *pRoots,
+                  void *pUserData)
+{
+    // Compute the roots function
+    // Note: our roots may depend on algebraic variables that are computed
+    //       alongside our rates, so we need a rates array, but not our model's
+    //       one since CVODES may evaluate our roots at any point of its
+    //       current step, hence we use a scratch array instead...
+
+    auto userData = static_cast<CvodeSolverUserData *>(pUserData);
+
+    userData->computeRoots()(pVoi, userData->constants(), userData->rootsRates(),
+                             N_VGetArrayPointer_Serial(pStates),
+                             userData->algebraic(), pRoots);
+
+    return 0;
+}
+
+//==============================================================================
+
+int jacobianFunction(double pVoi, N_Vector pStates, N_Vector pRates,
+                     SUNMatrix pJacobian, void *pUserData, N_Vector pTemp1,
+                     N_Vector pTemp2, N_Vector pTemp3)
+{
+    // Compute the Jacobian using finite differences, like CVODES would do (see
+    // cvLsDenseDQJac()), except that we perturb several states at once, i.e.
+    // all the states that belong to the same group of columns
+    // Note: columns belong to the same group if none of their rows (i.e. none
+    //       of the rates that depend on their state) are shared, so a group of
+    //       columns requires only one call to our compute rates function rather
+    //       than one call per column...
+
+    auto userData = static_cast<CvodeSolverUserData *>(pUserData);
+    const QVector<QVector<int>> columnsGroups = userData->columnsGroups();
+    const QVector<QVector<int>> columnsRows = userData->columnsRows();
+
+    // Retrieve what we need to determine our increments
+
+    static const double UnitRoundoff = std::numeric_limits<double>::epsilon();
+    static const double SqrtUnitRoundoff = std::sqrt(UnitRoundoff);
+
+    double step;
+
+    CVodeGetCurrentStep(userData->solver(), &step);
+    CVodeGetErrWeights(userData->solver(), pTemp1);
+
+    double ratesNorm = N_VWrmsNorm(pRates, pTemp1);
+    double minimumIncrement = (ratesNorm != 0.0)?
+                                  1000.0*std::abs(step)*UnitRoundoff*N_VGetLength_Serial(pStates)*ratesNorm:
+                                  1.0;
+
+    // Compute our Jacobian, one group of columns at a time
+
+    double *states = N_VGetArrayPointer_Serial(pStates);
+    double *rates = N_VGetArrayPointer_Serial(pRates);
+    double *errorWeights = N_VGetArrayPointer_Serial(pTemp1);
+    double *perturbedRates = N_VGetArrayPointer_Serial(pTemp2);
+    double *perturbedStates = N_VGetArrayPointer_Serial(pTemp3);
+
+    N_VScale(1.0, pStates, pTemp3);
+
+    SUNMatZero(pJacobian);
+
+    for (const auto &columnsGroup : columnsGroups) {
+        for (auto column : columnsGroup) {
+            perturbedStates[column] += qMax(SqrtUnitRoundoff*std::abs(states[column]),
+                                            minimumIncrement/errorWeights[column]);
+        }
+
+        userData->computeRates()(pVoi, userData->constants(), perturbedRates,
+                                 perturbedStates, userData->algebraic());
+
+        for (auto column : columnsGroup) {
+            double oneOverIncrement = 1.0/(perturbedStates[column]-states[column]);
+            double *jacobianColumn = SUNDenseMatrix_Column(pJacobian, column);
+
+            for (auto row : columnsRows[column]) {
+                jacobianColumn[row] = oneOverIncrement*(perturbedRates[row]-rates[row]);
+            }
+
+            perturbedStates[column] = states[column];
+        }
+    }
+
+    return 0;
+}
+
+//==============================================================================
+
+int sensitivitiesRhsFunction(int pSensitivitiesCount, double pVoi,
+                             N_Vector pStates, N_Vector pRates,
+                             int pSensitivity, N_Vector pStatesSensitivity,
+                             N_Vector pRatesSensitivity, void *pUserData,
+                             N_Vector pTemp1, N_Vector pTemp2)
+{
+    Q_UNUSED(pSensitivitiesCount)
+
+    // Compute the right-hand side of the given sensitivity equation, i.e.
+    // J*s+df/dp, using difference quotients, like CVODES would do (see
+    // cvSensRhs1InternalDQ()), except that we recompute our computed constants
+    // whenever we perturb our sensitivity parameter, since some of them may
+    // depend on it
+    // Note #1: computing our computed constants may also compute the initial
+    //          value of some of our states, hence we give it a copy of our
+    //          states and some scratch rates...
+    // Note #2: we restore our computed constants once we are done, so that our
+    //          other functions keep using the right values...
+
+    static const double SqrtUnitRoundoff = std::sqrt(std::numeric_limits<double>::epsilon());
+
+    auto userData = static_cast<CvodeSolverUserData *>(pUserData);
+    double *constants = userData->constants();
+    double *algebraic = userData->algebraic();
+    double *scratchStates = N_VGetArrayPointer_Serial(pTemp1);
+    double *scratchRates = N_VGetArrayPointer_Serial(pTemp2);
+
+    // Compute J*s, perturbing our states in the direction of our sensitivity
+
+    double scale = userData->sensitivityParametersScales()[pSensitivity];
+
+    CVodeGetErrWeights(userData->solver(), pTemp1);
+
+    double statesIncrement = 1.0/qMax(N_VWrmsNorm(pStatesSensitivity, pTemp1),
+                                      1.0/(SqrtUnitRoundoff*scale));
+
+    N_VLinearSum(1.0, pStates, statesIncrement, pStatesSensitivity, pTemp1);
+
+    userData->computeRates()(pVoi, constants,
+                             N_VGetArrayPointer_Serial(pRatesSensitivity),
+                             scratchStates, algebraic);
+
+    N_VLinearSum(1.0/statesIncrement, pRatesSensitivity,
+                 -1.0/statesIncrement, pRates, pRatesSensitivity);
+
+    // Add df/dp, perturbing our sensitivity parameter and recomputing our
+    // computed constants
+
+    int parameter = userData->sensitivityParameters()[pSensitivity];
+    double parameterValue = constants[parameter];
+    double parameterIncrement = SqrtUnitRoundoff*scale;
+
+    constants[parameter] = parameterValue+parameterIncrement;
+
+    N_VScale(1.0, pStates, pTemp1);
+
+    userData->computeComputedConstants()(pVoi, constants, scratchRates,
+                                         scratchStates, algebraic);
+    userData->computeRates()(pVoi, constants, scratchRates,
+                             N_VGetArrayPointer_Serial(pStates), algebraic);
+
+    N_VLinearSum(1.0, pRatesSensitivity, 1.0/parameterIncrement, pTemp2,
+                 pRatesSensitivity);
+    N_VLinearSum(1.0, pRatesSensitivity, -1.0/parameterIncrement, pRates,
+                 pRatesSensitivity);
+
+    constants[parameter] = parameterValue;
+
+    N_VScale(1.0, pStates, pTemp1);
+
+    userData->computeComputedConstants()(pVoi, constants, scratchRates,
+                                         scratchStates, algebraic);
+
+    return 0;
+}
+
+//==============================================================================
+
 void errorHandler(int pErrorCode, const char *pModule, const char *pFunction,
                   char *pErrorMessage, void *pUserData)
 {
@@ -77,12 +250,30 @@ void errorHandler(int pErrorCode, const char *pModule, const char *pFunction,
 
 //==============================================================================
 
-CvodeSolverUserData::CvodeSolverUserData(double *pConstants, double *pAlgebraic,
-                                         Solver::OdeSolver::ComputeRatesFunction pComputeRates) :
+CvodeSolverUserData::CvodeSolverUserData(double *pConstants,
+                                         double *pAlgebraic,
+                                         int pRatesStatesCount,
+                                         Solver::OdeSolver::ComputeRatesFunction pComputeRates,
+                                         Solver::OdeSolver::ComputeRootsFunction pComputeRoots) :
     mConstants(pConstants),
     mAlgebraic(pAlgebraic),
-    mComputeRates(pComputeRates)
+    mComputeRates(pComputeRates),
+    mComputeRoots(pComputeRoots)
+{
+    // Create our roots rates array, if needed
+
+    if (pComputeRoots != nullptr) {
+        mRootsRates = new double[pRatesStatesCount] {};
+    }
+}
+
+//==============================================================================
+
+CvodeSolverUserData::~CvodeSolverUserData()
 {
+    // Delete some internal objects
+
+    delete[] mRootsRates;
 }
 
 //==============================================================================
@@ -105,6 +296,15 @@ double * CvodeSolverUserData::algebraic() const
 
 //==============================================================================
 
+double * CvodeSolverUserData::rootsRates() const
+{
+    // Return our roots rates array
+
+    return mRootsRates;
+}
+
+//==============================================================================
+
 Solver::OdeSolver::ComputeRatesFunction CvodeSolverUserData::computeRates() const
 {
     // Return our compute rates function
@@ -114,6 +314,104 @@ Solver::OdeSolver::ComputeRatesFunction CvodeSolverUserData::computeRates() cons
 
 //==============================================================================
 
+Solver::OdeSolver::ComputeRootsFunction CvodeSolverUserData::computeRoots() const
+{
+    // Return our compute roots function
+
+    return mComputeRoots;
+}
+
+//==============================================================================
+
+void * CvodeSolverUserData::solver() const
+{
+    // Return our solver
+
+    return mSolver;
+}
+
+//==============================================================================
+
+void CvodeSolverUserData::setSolver(void *pSolver)
+{
+    // Set our solver
+
+    mSolver = pSolver;
+}
+
+//==============================================================================
+
+QVector<QVector<int>> CvodeSolverUserData::columnsGroups() const
+{
+    // Return our groups of Jacobian columns
+
+    return mColumnsGroups;
+}
+
+//==============================================================================
+
+QVector<QVector<int>> CvodeSolverUserData::columnsRows() const
+{
+    // Return the non-zero rows of our Jacobian columns
+
+    return mColumnsRows;
+}
+
+//==============================================================================
+
+void CvodeSolverUserData::setColumns(const QVector<QVector<int>> &pColumnsGroups,
+                                     const QVector<QVector<int>> &pColumnsRows)
+{
+    // Set our groups of Jacobian columns and the non-zero rows of our Jacobian
+    // columns
+
+    mColumnsGroups = pColumnsGroups;
+    mColumnsRows = pColumnsRows;
+}
+
+//==============================================================================
+
+Solver::OdeSolver::ComputeComputedConstantsFunction CvodeSolverUserData::computeComputedConstants() const
+{
+    // Return our compute computed constants function
+
+    return mComputeComputedConstants;
+}
+
+//==============================================================================
+
+QVector<int> CvodeSolverUserData::sensitivityParameters() const
+{
+    // Return our sensitivity parameters
+
+    return mSensitivityParameters;
+}
+
+//==============================================================================
+
+QVector<double> CvodeSolverUserData::sensitivityParametersScales() const
+{
+    // Return the scaling factors of our sensitivity parameters
+
+    return mSensitivityParametersScales;
+}
+
+//==============================================================================
+
+void CvodeSolverUserData::setSensitivities(Solver::OdeSolver::ComputeComputedConstantsFunction pComputeComputedConstants,
+                                           const QVector<int> &pSensitivityParameters,
+                                           const QVector<double> &pSensitivityParametersScales)
+{
+    // Set what we need to compute the right-hand side of our sensitivity
+    // equations (see sensitivitiesRhsFunction())
+
+    mComputeComputedConstants = pComputeComputedConstants;
+    mSensitivityParameters = pSensitivityParameters;
+    mSensitivityParametersScales = pSensitivityParametersScales;
+}
+
+//==============================================================================
+
 CvodeSolver::~CvodeSolver()
 {
     // Make sure that the solver has been initialised
@@ -125,8 +423,14 @@ CvodeSolver::~CvodeSolver()
     // Delete some internal objects
 
     N_VDestroy_Serial(mStatesVector);
+
+    if (mSensitivitiesVectors != nullptr) {
+        N_VDestroyVectorArray(mSensitivitiesVectors, mSensitivitiesCount);
+    }
+
     SUNLinSolFree(mLinearSolver);
     SUNNonlinSolFree(mNonLinearSolver);
+    SUNNonlinSolFree(mSensitivitiesNonLinearSolver);
     SUNMatDestroy(mMatrix);
 
     CVodeFree(&mSolver);
@@ -309,10 +613,25 @@ void CvodeSolver::initialize(double pVoi, int pRatesStatesCount,
 
     // Set our user data
 
-    mUserData = new CvodeSolverUserData(pConstants, pAlgebraic, pComputeRates);
+    mUserData = new CvodeSolverUserData(pConstants, pAlgebraic,
+                                        pRatesStatesCount, pComputeRates,
+                                        mComputeRoots);
+
+    mUserData->setSolver(mSolver);
 
     CVodeSetUserData(mSolver, mUserData);
 
+    // Locate the discontinuities of our model, if any, so that we can stop
+    // exactly at them rather than step over them
+    // Note: a root function may be identically zero at the beginning of our
+    //       simulation (e.g. a stimulus that starts straight away), which is
+    //       fine, hence we don't want to be warned about it...
+
+    if ((mRootsCount != 0) && (mComputeRoots != nullptr)) {
+        CVodeRootInit(mSolver, mRootsCount, rootsFunction);
+        CVodeSetNoInactiveRootWarn(mSolver);
+    }
+
     // Set our maximum step
 
     CVodeSetMaxStep(mSolver, maximumStep);
@@ -329,6 +648,10 @@ void CvodeSolver::initialize(double pVoi, int pRatesStatesCount,
             mLinearSolver = SUNLinSol_Dense(mStatesVector, mMatrix);
 
             CVodeSetLinearSolver(mSolver, mLinearSolver, mMatrix);
+
+            if (setJacobianColumns(pRatesStatesCount)) {
+                CVodeSetJacFn(mSolver, jacobianFunction);
+            }
         } else if (linearSolver == BandedLinearSolver) {
             mMatrix = SUNBandMatrix(pRatesStatesCount, upperHalfBandwidth,
                                                        lowerHalfBandwidth);
@@ -373,15 +696,181 @@ void CvodeSolver::initialize(double pVoi, int pRatesStatesCount,
     // Set our relative and absolute tolerances
 
     CVodeSStolerances(mSolver, relativeTolerance, absoluteTolerance);
+
+    // Compute the sensitivities of our states with respect to some of our
+    // constants, if requested
+    // Note #1: we compute the right-hand side of our sensitivity equations
+    //          ourselves rather than let CVODES do it, since CVODES would
+    //          perturb our constants without recomputing our computed
+    //          constants, some of which may depend on them (see
+    //          sensitivitiesRhsFunction()). Still, CVODES needs the scaling
+    //          factors of our constants, i.e. their magnitude or one if they
+    //          are zero, for its error control...
+    // Note #2: our initial sensitivities are those that we were given, which
+    //          account for states whose initial value depends on a constant
+    //          with respect to which we compute sensitivities (see
+    //          SimulationData::initializeSensitivities()), or which are those
+    //          from where we left off if we are continuing a simulation...
+
+    if (   !mSensitivityParameters.isEmpty() && (mSensitivities != nullptr)
+        && (mComputeComputedConstants != nullptr)) {
+        mSensitivitiesCount = mSensitivityParameters.count();
+        mSensitivitiesVectors = N_VCloneVectorArray(mSensitivitiesCount,
+                                                    mStatesVector);
+
+        setSensitivitiesVectors();
+
+        QVector<double> parametersScales(mSensitivitiesCount);
+
+        for (int i = 0; i < mSensitivitiesCount; ++i) {
+            double parameter = pConstants[mSensitivityParameters[i]];
+
+            parametersScales[i] = qFuzzyIsNull(parameter)?1.0:std::abs(parameter);
+        }
+
+        mUserData->setSensitivities(mComputeComputedConstants,
+                                    mSensitivityParameters, parametersScales);
+
+        CVodeSensInit1(mSolver, mSensitivitiesCount, CV_STAGGERED,
+                       sensitivitiesRhsFunction, mSensitivitiesVectors);
+        CVodeSetSensParams(mSolver, nullptr, parametersScales.data(), nullptr);
+        CVodeSensEEtolerances(mSolver);
+        CVodeSetSensErrCon(mSolver, SUNTRUE);
+
+        // Our sensitivities are to be solved in the same way as our states,
+        // which means that we need our own fixed point solver for them if we
+        // are not using a Newton iteration
+
+        if (!newtonIteration) {
+            mSensitivitiesNonLinearSolver = SUNNonlinSol_FixedPointSens(mSensitivitiesCount,
+                                                                        mStatesVector, 0);
+
+            CVodeSetNonlinearSolverSensStg(mSolver, mSensitivitiesNonLinearSolver);
+        }
+    }
+}
+
+//==============================================================================
+
+bool CvodeSolver::setJacobianColumns(int pRatesStatesCount)
+{
+    // Determine the non-zero rows of each column of our Jacobian, using the
+    // states on which each of our rates depends, if known
+
+    if (mStatesDependencies.count() != pRatesStatesCount) {
+        return false;
+    }
+
+    QVector<QVector<int>> columnsRows(pRatesStatesCount);
+
+    for (int i = 0; i < pRatesStatesCount; ++i) {
+        for (auto state : mStatesDependencies[i]) {
+            if ((state < 0) || (state >= pRatesStatesCount)) {
+                return false;
+            }
+
+            columnsRows[state] << i;
+        }
+    }
+
+    // Group the columns of our Jacobian that don't share any non-zero row, so
+    // that they can be computed together (see jacobianFunction())
+    // Note: we use a greedy approach, which is not optimal, but good enough
+    //       for the kind of sparsity patterns we get from CellML models...
+
+    QVector<QVector<int>> columnsGroups;
+    QVector<QVector<bool>> groupsRows;
+
+    for (int i = 0; i < pRatesStatesCount; ++i) {
+        if (columnsRows[i].isEmpty()) {
+            continue;
+        }
+
+        int group = 0;
+
+        for (int iMax = columnsGroups.count(); group < iMax; ++group) {
+            bool sharedRow = false;
+
+            for (auto row : columnsRows[i]) {
+                if (groupsRows[group][row]) {
+                    sharedRow = true;
+
+                    break;
+                }
+            }
+
+            if (!sharedRow) {
+                break;
+            }
+        }
+
+        if (group == columnsGroups.count()) {
+            columnsGroups << QVector<int>();
+            groupsRows << QVector<bool>(pRatesStatesCount, false);
+        }
+
+        columnsGroups[group] << i;
+
+        for (auto row : columnsRows[i]) {
+            groupsRows[group][row] = true;
+        }
+    }
+
+    // Only use our groups of columns if they mean fewer calls to our compute
+    // rates function than CVODES would otherwise need
+
+    if (columnsGroups.count() >= pRatesStatesCount) {
+        return false;
+    }
+
+    mUserData->setColumns(columnsGroups, columnsRows);
+
+    return true;
 }
 
 //==============================================================================
 
 void CvodeSolver::reinitialize(double pVoi)
 {
-    // Reinitialise our CVODES object
+    // Reinitialise our CVODES object, as well as our sensitivities, if any,
+    // since our states may have been reset
+    // Note: our sensitivities array is either the one that got initialised
+    //       when our states got reset (see
+    //       SimulationData::initializeSensitivities()) or the one from where
+    //       we left off, so we reinitialise CVODES using it rather than using
+    //       zero sensitivities...
 
     CVodeReInit(mSolver, pVoi, mStatesVector);
+
+    if (mSensitivitiesVectors != nullptr) {
+        setSensitivitiesVectors();
+
+        CVodeSensReInit(mSolver, CV_STAGGERED, mSensitivitiesVectors);
+    }
+}
+
+//==============================================================================
+
+void CvodeSolver::setSensitivitiesVectors() const
+{
+    // Set our CVODES sensitivities from our sensitivities array
+
+    for (int i = 0; i < mSensitivitiesCount; ++i) {
+        memcpy(N_VGetArrayPointer_Serial(mSensitivitiesVectors[i]),
+               mSensitivities+i*mRatesStatesCount,
+               size_t(mRatesStatesCount)*sizeof(double));
+    }
+}
+
+//==============================================================================
+
+void CvodeSolver::retrieveSensitivities() const
+{
+    // Retrieve our sensitivities from CVODES
+
+    realtype voi;
+
+    CVodeGetSens(mSolver, &voi, mSensitivitiesVectors);
 }
 
 //==============================================================================
@@ -389,12 +878,64 @@ void CvodeSolver::reinitialize(double pVoi)
 void CvodeSolver::solve(double &pVoi, double pVoiEnd) const
 {
     // Solve the model
+    // Note #1: CVODES stops whenever a discontinuity of our model is crossed
+    //          (see initialize()), in which case we reinitialise it, since its
+    //          history (e.g. its step size and order) is not valid across a
+    //          discontinuity, and carry on from there...
+    // Note #2: a model may have a condition that keeps switching (e.g. a
+    //          condition that depends on a state that it also drives towards
+    //          its threshold), in which case we would keep reinitialising
+    //          CVODES, making little or no progress. So, if we come across too
+    //          many discontinuities before reaching pVoiEnd, we stop looking
+    //          for them until then...
+
+    static const int MaximumRootsCount = 100;
+
+    int rootsCount = 0;
+
+    forever {
+        if (!mInterpolateSolution) {
+            CVodeSetStopTime(mSolver, pVoiEnd);
+        }
+
+        if (CVode(mSolver, pVoiEnd, mStatesVector, &pVoi, CV_NORMAL) != CV_ROOT_RETURN) {
+            break;
+        }
+
+        if (++rootsCount == MaximumRootsCount) {
+            CVodeRootInit(mSolver, 0, nullptr);
+
+            continue;
+        }
+
+        CVodeReInit(mSolver, pVoi, mStatesVector);
+
+        if (mSensitivitiesVectors != nullptr) {
+            retrieveSensitivities();
 
-    if (!mInterpolateSolution) {
-        CVodeSetStopTime(mSolver, pVoiEnd);
+            CVodeSensReInit(mSolver, CV_STAGGERED, mSensitivitiesVectors);
+        }
+    }
+
+    // Look for discontinuities again, if we stopped doing so
+
+    if (rootsCount >= MaximumRootsCount) {
+        CVodeRootInit(mSolver, mRootsCount, rootsFunction);
+        CVodeSetNoInactiveRootWarn(mSolver);
     }
 
-    CVode(mSolver, pVoiEnd, mStatesVector, &pVoi, CV_NORMAL);
+    // Retrieve our sensitivities, if any, and copy them to where they are
+    // expected
+
+    if (mSensitivitiesVectors != nullptr) {
+        retrieveSensitivities();
+
+        for (int i = 0; i < mSensitivitiesCount; ++i) {
+            memcpy(mSensitivities+i*mRatesStatesCount,
+                   N_VGetArrayPointer_Serial(mSensitivitiesVectors[i]),
+                   size_t(mRatesStatesCount)*sizeof(double));
+        }
+    }
 
     // Compute the rates one more time to get up to date values for the rates
     // Note: another way of doing this would be to copy the contents of the
@@ -409,6 +950,15 @@ void CvodeSolver::solve(double &pVoi, double pVoiEnd) const
 
 //==============================================================================
 
+bool CvodeSolver::supportsSensitivities() const
+{
+    // We can compute sensitivities
+
+    return true;
+}
+
+//==============================================================================
+
 } // namespace CVODESolver
 } // namespace OpenCOR
 
@@ -114,18 +114,49 @@ class CvodeSolverUserData
 {
 public:
     explicit CvodeSolverUserData(double *pConstants, double *pAlgebraic,
-                                 Solver::OdeSolver::ComputeRatesFunction pComputeRates);
+                                 int pRatesStatesCount,
+                                 Solver::OdeSolver::ComputeRatesFunction pComputeRates,
+                                 Solver::OdeSolver::ComputeRootsFunction pComputeRoots);
+    ~CvodeSolverUserData();
 
     double * constants() const;
     double * algebraic() const;
+    double * rootsRates() const;
 
     Solver::OdeSolver::ComputeRatesFunction computeRates() const;
+    Solver::OdeSolver::ComputeRootsFunction computeRoots() const;
+
+    void * solver() const;
+    void setSolver(void *pSolver);
+
+    QVector<QVector<int>> columnsGroups() const;
+    QVector<QVector<int>> columnsRows() const;
+    void setColumns(const QVector<QVector<int>> &pColumnsGroups,
+                    const QVector<QVector<int>> &pColumnsRows);
+
+    Solver::OdeSolver::ComputeComputedConstantsFunction computeComputedConstants() const;
+    QVector<int> sensitivityParameters() const;
+    QVector<double> sensitivityParametersScales() const;
+    void setSensitivities(Solver::OdeSolver::ComputeComputedConstantsFunction pComputeComputedConstants,
+                          const QVector<int> &pSensitivityParameters,
+                          const QVector<double> &pSensitivityParametersScales);
 
 private:
     double *mConstants;
     double *mAlgebraic;
+    double *mRootsRates = nullptr;
 
     Solver::OdeSolver::ComputeRatesFunction mComputeRates;
+    Solver::OdeSolver::ComputeRootsFunction mComputeRoots;
+
+    void *mSolver = nullptr;
+
+    QVector<QVector<int>> mColumnsGroups;
+    QVector<QVector<int>> mColumnsRows;
+
+    Solver::OdeSolver::ComputeComputedConstantsFunction mComputeComputedConstants = nullptr;
+    QVector<int> mSensitivityParameters;
+    QVector<double> mSensitivityParametersScales;
 };
 
 //==============================================================================
@@ -144,11 +175,17 @@ public:
 
     void solve(double &pVoi, double pVoiEnd) const override;
 
+    bool supportsSensitivities() const override;
+
 private:
     void *mSolver = nullptr;
 
     N_Vector mStatesVector = nullptr;
 
+    int mSensitivitiesCount = 0;
+    N_Vector *mSensitivitiesVectors = nullptr;
+    SUNNonlinearSolver mSensitivitiesNonLinearSolver = nullptr;
+
     SUNMatrix mMatrix = nullptr;
     SUNLinearSolver mLinearSolver = nullptr;
     SUNNonlinearSolver mNonLinearSolver = nullptr;
@@ -156,6 +193,11 @@ private:
     CvodeSolverUserData *mUserData = nullptr;
 
     bool mInterpolateSolution = InterpolateSolutionDefaultValue;
+
+    bool setJacobianColumns(int pRatesStatesCount);
+
+    void setSensitivitiesVectors() const;
+    void retrieveSensitivities() const;
 };
 
 //==============================================================================
@@ -0,0 +1,207 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// CVODE solver tests
+//==============================================================================
+
+#include "cvodesolver.h"
+#include "tests.h"
+
+//==============================================================================
+
+#include <QtTest/QtTest>
+
+//==============================================================================
+
+#include <cmath>
+
+//==============================================================================
+
+// Our test model is dx/dt = -c*x with c = 2*k and x(0) = x0, i.e. a model with
+// a computed constant (c) that depends on a constant (k) and a state (x) whose
+// initial value is a constant (x0), which means that x(t) = x0*exp(-2*k*t),
+// d(x)/d(k) = -2*t*x0*exp(-2*k*t) and d(x)/d(x0) = exp(-2*k*t)
+
+static const double K = 0.5;
+static const double X0 = 2.0;
+
+//==============================================================================
+
+static void computeComputedConstants(double pVoi, double *pConstants,
+                                     double *pRates, double *pStates,
+                                     double *pAlgebraic)
+{
+    Q_UNUSED(pVoi)
+    Q_UNUSED(pRates)
+    Q_UNUSED(pAlgebraic)
+
+    // Compute our computed constants and the initial value of our state
+
+    pConstants[2] = 2.0*pConstants[0];
+    pStates[0] = pConstants[1];
+}
+
+//==============================================================================
+
+static void computeRates(double pVoi, double *pConstants, double *pRates,
+                         double *pStates, double *pAlgebraic)
+{
+    Q_UNUSED(pVoi)
+    Q_UNUSED(pAlgebraic)
+
+    // Compute our rates
+
+    pRates[0] = -pConstants[2]*pStates[0];
+}
+
+//==============================================================================
+
+static OpenCOR::Solver::Solver::Properties solverProperties()
+{
+    // Return the properties to use for our CVODE solver
+
+    OpenCOR::Solver::Solver::Properties res;
+
+    res.insert(OpenCOR::CVODESolver::MaximumStepId, OpenCOR::CVODESolver::MaximumStepDefaultValue);
+    res.insert(OpenCOR::CVODESolver::MaximumNumberOfStepsId, OpenCOR::CVODESolver::MaximumNumberOfStepsDefaultValue);
+    res.insert(OpenCOR::CVODESolver::IntegrationMethodId, OpenCOR::CVODESolver::IntegrationMethodDefaultValue);
+    res.insert(OpenCOR::CVODESolver::IterationTypeId, OpenCOR::CVODESolver::IterationTypeDefaultValue);
+    res.insert(OpenCOR::CVODESolver::LinearSolverId, OpenCOR::CVODESolver::LinearSolverDefaultValue);
+    res.insert(OpenCOR::CVODESolver::PreconditionerId, OpenCOR::CVODESolver::PreconditionerDefaultValue);
+    res.insert(OpenCOR::CVODESolver::UpperHalfBandwidthId, OpenCOR::CVODESolver::UpperHalfBandwidthDefaultValue);
+    res.insert(OpenCOR::CVODESolver::LowerHalfBandwidthId, OpenCOR::CVODESolver::LowerHalfBandwidthDefaultValue);
+    res.insert(OpenCOR::CVODESolver::RelativeToleranceId, 1.0e-9);
+    res.insert(OpenCOR::CVODESolver::AbsoluteToleranceId, 1.0e-9);
+    res.insert(OpenCOR::CVODESolver::InterpolateSolutionId, OpenCOR::CVODESolver::InterpolateSolutionDefaultValue);
+
+    return res;
+}
+
+//==============================================================================
+
+static void checkSensitivities(double pVoi, double pVoiStart,
+                               const double *pStates,
+                               const double *pSensitivities)
+{
+    // Check our state and its sensitivities against their analytical values
+
+    double t = pVoi-pVoiStart;
+    double exponential = std::exp(-2.0*K*t);
+
+    QVERIFY(std::abs(pStates[0]-X0*exponential) < 1.0e-6);
+    QVERIFY(std::abs(pSensitivities[0]+2.0*t*X0*exponential) < 1.0e-4);
+    QVERIFY(std::abs(pSensitivities[1]-exponential) < 1.0e-4);
+}
+
+//==============================================================================
+
+void Tests::sensitivitiesTests()
+{
+    // Check that the sensitivities with respect to a constant on which a
+    // computed constant depends are correct, i.e. that our computed constants
+    // get recomputed when perturbing that constant
+    // Note: our sensitivities are seeded with those of the initial value of our
+    //       state, i.e. 0 with respect to k and 1 with respect to x0...
+
+    double constants[] = { K, X0, 0.0 };
+    double rates[] = { 0.0 };
+    double states[] = { 0.0 };
+    double algebraic[] = { 0.0 };
+    double sensitivities[] = { 0.0, 1.0 };
+
+    computeComputedConstants(0.0, constants, rates, states, algebraic);
+
+    OpenCOR::CVODESolver::CvodeSolver solver;
+
+    solver.setProperties(solverProperties());
+    solver.setSensitivities({ 0, 1 }, sensitivities, computeComputedConstants);
+    solver.initialize(0.0, 1, constants, rates, states, algebraic, computeRates);
+
+    double voi = 0.0;
+
+    for (int i = 1; i <= 10; ++i) {
+        solver.solve(voi, 0.5*i);
+
+        checkSensitivities(voi, 0.0, states, sensitivities);
+    }
+
+    // Make sure that our computed constant got restored
+
+    QCOMPARE(constants[2], 2.0*K);
+}
+
+//==============================================================================
+
+void Tests::reinitializedSensitivitiesTests()
+{
+    // Check that our sensitivities are not lost when our solver gets
+    // reinitialised, i.e. that we carry on from the sensitivities we have been
+    // given, which is what happens when a simulation is reset while running
+    // (see SimulationData::initializeSensitivities() and
+    // SimulationWorker::run())
+
+    double constants[] = { K, X0, 0.0 };
+    double rates[] = { 0.0 };
+    double states[] = { 0.0 };
+    double algebraic[] = { 0.0 };
+    double sensitivities[] = { 0.0, 1.0 };
+
+    computeComputedConstants(0.0, constants, rates, states, algebraic);
+
+    OpenCOR::CVODESolver::CvodeSolver solver;
+
+    solver.setProperties(solverProperties());
+    solver.setSensitivities({ 0, 1 }, sensitivities, computeComputedConstants);
+    solver.initialize(0.0, 1, constants, rates, states, algebraic, computeRates);
+
+    double voi = 0.0;
+
+    solver.solve(voi, 1.0);
+
+    // Reset our state and its sensitivities, and reinitialise our solver
+
+    computeComputedConstants(voi, constants, rates, states, algebraic);
+
+    sensitivities[0] = 0.0;
+    sensitivities[1] = 1.0;
+
+    solver.reinitialize(voi);
+
+    // Our first output sensitivities should not be zero and should match their
+    // analytical values
+
+    solver.solve(voi, 1.1);
+
+    QVERIFY(sensitivities[1] > 0.5);
+
+    checkSensitivities(voi, 1.0, states, sensitivities);
+
+    solver.solve(voi, 2.0);
+
+    checkSensitivities(voi, 1.0, states, sensitivities);
+}
+
+//==============================================================================
+
+QTEST_APPLESS_MAIN(Tests)
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -0,0 +1,518 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+
+//==============================================================================
+// Dormand-Prince solver
+//==============================================================================
+
+#include "dormandprincesolver.h"
+
+//==============================================================================
+
+#include <cmath>
+#include <limits>
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace DormandPrinceSolver {
+
+//==============================================================================
+
+DormandPrinceSolver::~DormandPrinceSolver()
+{
+    // Delete some internal objects
+
+    deleteArrays();
+}
+
+//==============================================================================
+
+void DormandPrinceSolver::deleteArrays()
+{
+    // Delete our various arrays
+
+    delete[] mY;
+    delete[] mNewY;
+    delete[] mYk;
+
+    delete[] mK1;
+    delete[] mK2;
+    delete[] mK3;
+    delete[] mK4;
+    delete[] mK5;
+    delete[] mK6;
+    delete[] mK7;
+
+    delete[] mDenseOutput1;
+    delete[] mDenseOutput2;
+    delete[] mDenseOutput3;
+    delete[] mDenseOutput4;
+    delete[] mDenseOutput5;
+}
+
+//==============================================================================
+
+void DormandPrinceSolver::initialize(double pVoi, int pRatesStatesCount,
+                                     double *pConstants, double *pRates,
+                                     double *pStates, double *pAlgebraic,
+                                     ComputeRatesFunction pComputeRates)
+{
+    // Retrieve the solver's properties
+
+    if (mProperties.contains(MaximumStepId)) {
+        mMaximumStep = mProperties.value(MaximumStepId).toDouble();
+    } else {
+        emit error(tr(R"(the "Maximum step" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(MaximumNumberOfStepsId)) {
+        mMaximumNumberOfSteps = mProperties.value(MaximumNumberOfStepsId).toInt();
+    } else {
+        emit error(tr(R"(the "Maximum number of steps" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(RelativeToleranceId)) {
+        mRelativeTolerance = mProperties.value(RelativeToleranceId).toDouble();
+    } else {
+        emit error(tr(R"(the "Relative tolerance" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(AbsoluteToleranceId)) {
+        mAbsoluteTolerance = mProperties.value(AbsoluteToleranceId).toDouble();
+    } else {
+        emit error(tr(R"(the "Absolute tolerance" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (qFuzzyIsNull(mRelativeTolerance) && qFuzzyIsNull(mAbsoluteTolerance)) {
+        emit error(tr(R"(the "Relative tolerance" and "Absolute tolerance" properties cannot both be equal to zero)"));
+
+        return;
+    }
+
+    if (mProperties.contains(InterpolateSolutionId)) {
+        mInterpolateSolution = mProperties.value(InterpolateSolutionId).toBool();
+    } else {
+        emit error(tr(R"(the "Interpolate solution" property value could not be retrieved)"));
+
+        return;
+    }
+
+    // Initialise the ODE solver itself
+
+    OdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates, pStates,
+                          pAlgebraic, pComputeRates);
+
+    // (Re)create our various arrays
+
+    deleteArrays();
+
+    mY = new double[pRatesStatesCount] {};
+    mNewY = new double[pRatesStatesCount] {};
+    mYk = new double[pRatesStatesCount] {};
+
+    mK1 = new double[pRatesStatesCount] {};
+    mK2 = new double[pRatesStatesCount] {};
+    mK3 = new double[pRatesStatesCount] {};
+    mK4 = new double[pRatesStatesCount] {};
+    mK5 = new double[pRatesStatesCount] {};
+    mK6 = new double[pRatesStatesCount] {};
+    mK7 = new double[pRatesStatesCount] {};
+
+    mDenseOutput1 = new double[pRatesStatesCount] {};
+    mDenseOutput2 = new double[pRatesStatesCount] {};
+    mDenseOutput3 = new double[pRatesStatesCount] {};
+    mDenseOutput4 = new double[pRatesStatesCount] {};
+    mDenseOutput5 = new double[pRatesStatesCount] {};
+
+    // Start integrating from the given point and states, letting our first
+    // step be estimated
+
+    mStep = 0.0;
+
+    reinitialize(pVoi);
+}
+
+//==============================================================================
+
+void DormandPrinceSolver::reinitialize(double pVoi)
+{
+    // Restart integrating from the given point and our current states
+    // Note: we keep our current step since it is likely to still be a good
+    //       step, but our rates and dense output are no longer valid...
+
+    mVoi = pVoi;
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mY[i] = mStates[i];
+    }
+
+    mNeedRates = true;
+
+    mDenseOutputStep = 0.0;
+}
+
+//==============================================================================
+
+double DormandPrinceSolver::errorNorm(const double *pValues, const double *pY,
+                                      const double *pNewY) const
+{
+    // Return the root mean square of the given values, scaled using our
+    // tolerances and the given old and new states
+
+    double res = 0.0;
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        double value = pValues[i]/(mAbsoluteTolerance+mRelativeTolerance*qMax(std::fabs(pY[i]), std::fabs(pNewY[i])));
+
+        res += value*value;
+    }
+
+    return std::sqrt(res/mRatesStatesCount);
+}
+
+//==============================================================================
+
+double DormandPrinceSolver::initialStep() const
+{
+    // Estimate our initial step (see E. Hairer, S.P. Nørsett and G. Wanner,
+    // Solving Ordinary Differential Equations I, Springer, 1993, page 169)
+    // Note: mK1 contains our rates at our current point...
+
+    double d0 = errorNorm(mY, mY, mY);
+    double d1 = errorNorm(mK1, mY, mY);
+    double step = ((d0 < 1.0e-5) || (d1 < 1.0e-5))?1.0e-6:0.01*d0/d1;
+
+    if (mMaximumStep > 0.0) {
+        step = qMin(step, mMaximumStep);
+    }
+
+    // Take an explicit Euler step and use it to estimate our second derivative
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mYk[i] = mY[i]+step*mK1[i];
+    }
+
+    mComputeRates(mVoi+step, mConstants, mK2, mYk, mAlgebraic);
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mK2[i] -= mK1[i];
+    }
+
+    double d2 = errorNorm(mK2, mY, mY)/step;
+    double maxD = qMax(d1, d2);
+    double otherStep = (maxD <= 1.0e-15)?
+                           qMax(1.0e-6, 1.0e-3*step):
+                           std::pow(0.01/maxD, 0.2);
+
+    step = qMin(100.0*step, otherStep);
+
+    if (mMaximumStep > 0.0) {
+        step = qMin(step, mMaximumStep);
+    }
+
+    return step;
+}
+
+//==============================================================================
+
+void DormandPrinceSolver::solve(double &pVoi, double pVoiEnd) const
+{
+    // Solve our model using the Dormand-Prince 5(4) method, i.e. an embedded
+    // Runge-Kutta method with error control and step size control, which
+    // ensures that we take as few steps as possible for a given accuracy (see
+    // E. Hairer, S.P. Nørsett and G. Wanner, Solving Ordinary Differential
+    // Equations I, Springer, 1993)
+    // Note #1: the method is "first same as last" (FSAL), i.e. the rates
+    //          computed at the end of a step are those needed at the beginning
+    //          of the next step, so a step only needs six evaluations of our
+    //          rates...
+    // Note #2: if we are to interpolate our solution, then we may integrate
+    //          past pVoiEnd and then use the dense output of the last step to
+    //          compute our states at pVoiEnd (and at subsequent output points
+    //          that are within that step)...
+    // Note #3: solve() is const, but we need to update our integration state
+    //          (hence the mutable member variables) and to be able to report
+    //          errors (hence the const_cast)...
+
+    static const double C2 = 1.0/5.0;
+    static const double C3 = 3.0/10.0;
+    static const double C4 = 4.0/5.0;
+    static const double C5 = 8.0/9.0;
+
+    static const double A21 = 1.0/5.0;
+
+    static const double A31 = 3.0/40.0;
+    static const double A32 = 9.0/40.0;
+
+    static const double A41 = 44.0/45.0;
+    static const double A42 = -56.0/15.0;
+    static const double A43 = 32.0/9.0;
+
+    static const double A51 = 19372.0/6561.0;
+    static const double A52 = -25360.0/2187.0;
+    static const double A53 = 64448.0/6561.0;
+    static const double A54 = -212.0/729.0;
+
+    static const double A61 = 9017.0/3168.0;
+    static const double A62 = -355.0/33.0;
+    static const double A63 = 46732.0/5247.0;
+    static const double A64 = 49.0/176.0;
+    static const double A65 = -5103.0/18656.0;
+
+    static const double A71 = 35.0/384.0;
+    static const double A73 = 500.0/1113.0;
+    static const double A74 = 125.0/192.0;
+    static const double A75 = -2187.0/6784.0;
+    static const double A76 = 11.0/84.0;
+
+    static const double E1 = 71.0/57600.0;
+    static const double E3 = -71.0/16695.0;
+    static const double E4 = 71.0/1920.0;
+    static const double E5 = -17253.0/339200.0;
+    static const double E6 = 22.0/525.0;
+    static const double E7 = -1.0/40.0;
+
+    static const double D1 = -12715105075.0/11282082432.0;
+    static const double D3 = 87487479700.0/32700410799.0;
+    static const double D4 = -10690763975.0/1880347072.0;
+    static const double D5 = 701980252875.0/199316789632.0;
+    static const double D6 = -1453857185.0/822651844.0;
+    static const double D7 = 69997945.0/29380423.0;
+
+    static const double Safety = 0.9;
+    static const double MinimumFactor = 0.2;
+    static const double MaximumFactor = 10.0;
+
+    static const double Epsilon = std::numeric_limits<double>::epsilon();
+
+    // Make sure that we have the rates at our current point
+
+    if (mNeedRates) {
+        mComputeRates(mVoi, mConstants, mK1, mY, mAlgebraic);
+
+        mNeedRates = false;
+    }
+
+    // Estimate our initial step, if needed
+
+    if (mStep <= 0.0) {
+        mStep = initialStep();
+    }
+
+    // Integrate our model up to pVoiEnd (or past it, if we are to interpolate
+    // our solution)
+
+    int stepsCount = 0;
+    bool lastStepRejected = false;
+
+    while ((mVoi < pVoiEnd) && !qFuzzyCompare(mVoi, pVoiEnd)) {
+        // Make sure that we haven't taken too many steps
+
+        if (stepsCount == mMaximumNumberOfSteps) {
+            const_cast<DormandPrinceSolver *>(this)->emitError(tr("the maximum number of steps was reached before reaching %1").arg(pVoiEnd));
+
+            return;
+        }
+
+        ++stepsCount;
+
+        // Determine our step, making sure that it is not too small and that we
+        // don't integrate past pVoiEnd, unless we are to interpolate our
+        // solution
+
+        double step = mStep;
+
+        if (mMaximumStep > 0.0) {
+            step = qMin(step, mMaximumStep);
+        }
+
+        bool lastStep = mVoi+step >= pVoiEnd;
+
+        if (lastStep && !mInterpolateSolution) {
+            step = pVoiEnd-mVoi;
+        }
+
+        if (step <= 16.0*Epsilon*qMax(1.0, std::fabs(mVoi))) {
+            const_cast<DormandPrinceSolver *>(this)->emitError(tr("the step became too small at %1").arg(mVoi));
+
+            return;
+        }
+
+        // Compute our various stages
+
+        for (int i = 0; i < mRatesStatesCount; ++i) {
+            mYk[i] = mY[i]+step*A21*mK1[i];
+        }
+
+        mComputeRates(mVoi+C2*step, mConstants, mK2, mYk, mAlgebraic);
+
+        for (int i = 0; i < mRatesStatesCount; ++i) {
+            mYk[i] = mY[i]+step*(A31*mK1[i]+A32*mK2[i]);
+        }
+
+        mComputeRates(mVoi+C3*step, mConstants, mK3, mYk, mAlgebraic);
+
+        for (int i = 0; i < mRatesStatesCount; ++i) {
+            mYk[i] = mY[i]+step*(A41*mK1[i]+A42*mK2[i]+A43*mK3[i]);
+        }
+
+        mComputeRates(mVoi+C4*step, mConstants, mK4, mYk, mAlgebraic);
+
+        for (int i = 0; i < mRatesStatesCount; ++i) {
+            mYk[i] = mY[i]+step*(A51*mK1[i]+A52*mK2[i]+A53*mK3[i]+A54*mK4[i]);
+        }
+
+        mComputeRates(mVoi+C5*step, mConstants, mK5, mYk, mAlgebraic);
+
+        for (int i = 0; i < mRatesStatesCount; ++i) {
+            mYk[i] = mY[i]+step*(A61*mK1[i]+A62*mK2[i]+A63*mK3[i]+A64*mK4[i]+A65*mK5[i]);
+        }
+
+        mComputeRates(mVoi+step, mConstants, mK6, mYk, mAlgebraic);
+
+        // Compute our new states (fifth-order solution) and the rates at our
+        // new point, which are also the rates at the beginning of our next
+        // step
+
+        for (int i = 0; i < mRatesStatesCount; ++i) {
+            mNewY[i] = mY[i]+step*(A71*mK1[i]+A73*mK3[i]+A74*mK4[i]+A75*mK5[i]+A76*mK6[i]);
+        }
+
+        mComputeRates(mVoi+step, mConstants, mK7, mNewY, mAlgebraic);
+
+        // Estimate our local error, i.e. the difference between our fifth- and
+        // fourth-order solutions
+
+        for (int i = 0; i < mRatesStatesCount; ++i) {
+            mYk[i] = step*(E1*mK1[i]+E3*mK3[i]+E4*mK4[i]+E5*mK5[i]+E6*mK6[i]+E7*mK7[i]);
+        }
+
+        double error = errorNorm(mYk, mY, mNewY);
+
+        if (!qIsFinite(error)) {
+            // Our step is way too big, so reduce it drastically
+
+            mStep = MinimumFactor*step;
+
+            lastStepRejected = true;
+
+            continue;
+        }
+
+        // Compute our next step based on our error
+
+        double factor = qFuzzyIsNull(error)?
+                            MaximumFactor:
+                            qMin(MaximumFactor, qMax(MinimumFactor, Safety*std::pow(error, -0.2)));
+
+        if (error <= 1.0) {
+            // Our step is accepted, so compute our dense output, if it is
+            // going to be needed
+
+            if (lastStep && mInterpolateSolution) {
+                for (int i = 0; i < mRatesStatesCount; ++i) {
+                    double yDiff = mNewY[i]-mY[i];
+                    double bSpl = step*mK1[i]-yDiff;
+
+                    mDenseOutput1[i] = mY[i];
+                    mDenseOutput2[i] = yDiff;
+                    mDenseOutput3[i] = bSpl;
+                    mDenseOutput4[i] = yDiff-step*mK7[i]-bSpl;
+                    mDenseOutput5[i] = step*(D1*mK1[i]+D3*mK3[i]+D4*mK4[i]+D5*mK5[i]+D6*mK6[i]+D7*mK7[i]);
+                }
+
+                mDenseOutputVoi = mVoi;
+                mDenseOutputStep = step;
+            }
+
+            // Advance through time, making sure that we end up exactly at
+            // pVoiEnd if that's where we were supposed to end up
+
+            mVoi = (lastStep && !mInterpolateSolution)?pVoiEnd:mVoi+step;
+
+            for (int i = 0; i < mRatesStatesCount; ++i) {
+                mY[i] = mNewY[i];
+                mK1[i] = mK7[i];
+            }
+
+            // Update our next step, making sure that we don't increase it right
+            // after a rejected step and that we don't shrink it because we had
+            // to shorten our step to reach pVoiEnd
+
+            if (lastStepRejected) {
+                factor = qMin(factor, 1.0);
+            }
+
+            mStep = (lastStep && !mInterpolateSolution)?
+                        qMax(mStep, step*factor):
+                        step*factor;
+
+            lastStepRejected = false;
+        } else {
+            // Our step is rejected, so try again with a smaller step
+
+            mStep = step*factor;
+
+            lastStepRejected = true;
+        }
+    }
+
+    // Retrieve our states at pVoiEnd, either by interpolating them using the
+    // dense output of our last step or by copying them
+
+    if (    mInterpolateSolution && (mVoi > pVoiEnd) && !qFuzzyCompare(mVoi, pVoiEnd)
+        && (mDenseOutputStep > 0.0)) {
+        double theta = (pVoiEnd-mDenseOutputVoi)/mDenseOutputStep;
+        double oneMinusTheta = 1.0-theta;
+
+        for (int i = 0; i < mRatesStatesCount; ++i) {
+            mStates[i] = mDenseOutput1[i]+theta*(mDenseOutput2[i]+oneMinusTheta*(mDenseOutput3[i]+theta*(mDenseOutput4[i]+oneMinusTheta*mDenseOutput5[i])));
+        }
+    } else {
+        for (int i = 0; i < mRatesStatesCount; ++i) {
+            mStates[i] = mY[i];
+        }
+    }
+
+    pVoi = pVoiEnd;
+
+    // Compute the rates one more time to get up to date values for the rates
+    // and algebraic variables at pVoiEnd
+
+    mComputeRates(pVoiEnd, mConstants, mRates, mStates, mAlgebraic);
+}
+
+//==============================================================================
+
+} // namespace DormandPrinceSolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -0,0 +1,126 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+
+//==============================================================================
+// Dormand-Prince solver
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include "solverinterface.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace DormandPrinceSolver {
+
+//==============================================================================
+
+static const auto MaximumStepId          = QStringLiteral("MaximumStep");
+static const auto MaximumNumberOfStepsId = QStringLiteral("MaximumNumberOfSteps");
+static const auto RelativeToleranceId    = QStringLiteral("RelativeTolerance");
+static const auto AbsoluteToleranceId    = QStringLiteral("AbsoluteTolerance");
+static const auto InterpolateSolutionId  = QStringLiteral("InterpolateSolution");
+
+//==============================================================================
+
+// Default Dormand-Prince parameter values
+// Note #1: a maximum step of 0 means that there is no maximum step as such and
+//          that we can use whatever step we see fit...
+// Note #2: the maximum number of steps is the maximum number of steps that we
+//          can take between two output points, like with CVODES...
+
+static const double MaximumStepDefaultValue = 0.0;
+
+enum {
+    MaximumNumberOfStepsDefaultValue = 500
+};
+
+static const double RelativeToleranceDefaultValue = 1.0e-7;
+static const double AbsoluteToleranceDefaultValue = 1.0e-7;
+
+static const bool InterpolateSolutionDefaultValue = true;
+
+//==============================================================================
+
+class DormandPrinceSolver : public OpenCOR::Solver::OdeSolver
+{
+    Q_OBJECT
+
+public:
+    ~DormandPrinceSolver() override;
+
+    void initialize(double pVoi, int pRatesStatesCount, double *pConstants,
+                    double *pRates, double *pStates, double *pAlgebraic,
+                    ComputeRatesFunction pComputeRates) override;
+    void reinitialize(double pVoi) override;
+
+    void solve(double &pVoi, double pVoiEnd) const override;
+
+private:
+    double mMaximumStep = MaximumStepDefaultValue;
+    int mMaximumNumberOfSteps = MaximumNumberOfStepsDefaultValue;
+    double mRelativeTolerance = RelativeToleranceDefaultValue;
+    double mAbsoluteTolerance = AbsoluteToleranceDefaultValue;
+    bool mInterpolateSolution = InterpolateSolutionDefaultValue;
+
+    mutable double mVoi = 0.0;
+    mutable double mStep = 0.0;
+    mutable bool mNeedRates = true;
+
+    mutable double mDenseOutputVoi = 0.0;
+    mutable double mDenseOutputStep = 0.0;
+
+    double *mY = nullptr;
+    double *mNewY = nullptr;
+    double *mYk = nullptr;
+
+    double *mK1 = nullptr;
+    double *mK2 = nullptr;
+    double *mK3 = nullptr;
+    double *mK4 = nullptr;
+    double *mK5 = nullptr;
+    double *mK6 = nullptr;
+    double *mK7 = nullptr;
+
+    double *mDenseOutput1 = nullptr;
+    double *mDenseOutput2 = nullptr;
+    double *mDenseOutput3 = nullptr;
+    double *mDenseOutput4 = nullptr;
+    double *mDenseOutput5 = nullptr;
+
+    void deleteArrays();
+
+    double errorNorm(const double *pValues, const double *pY,
+                     const double *pNewY) const;
+
+    double initialStep() const;
+};
+
+//==============================================================================
+
+} // namespace DormandPrinceSolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -0,0 +1,161 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Dormand-Prince solver tests
+//==============================================================================
+
+#include "dormandprincesolver.h"
+#include "tests.h"
+
+//==============================================================================
+
+#include <QtTest/QtTest>
+
+//==============================================================================
+
+#include <cmath>
+
+//==============================================================================
+
+// Our test model is a harmonic oscillator, i.e. dx/dt = v and dv/dt = -x with
+// x(0) = 1 and v(0) = 0, which means that x(t) = cos(t) and v(t) = -sin(t)
+
+static int gComputeRatesCount = 0;
+
+//==============================================================================
+
+static void computeRates(double pVoi, double *pConstants, double *pRates,
+                         double *pStates, double *pAlgebraic)
+{
+    Q_UNUSED(pVoi)
+    Q_UNUSED(pConstants)
+    Q_UNUSED(pAlgebraic)
+
+    // Compute our rates and keep track of how many times we have done so
+
+    ++gComputeRatesCount;
+
+    pRates[0] = pStates[1];
+    pRates[1] = -pStates[0];
+}
+
+//==============================================================================
+
+static double maximumError(double pTolerance, double pPointInterval,
+                           bool pInterpolateSolution)
+{
+    // Solve our model from 0 to 10 using the given tolerance and point
+    // interval, and return the maximum error of our states at our output
+    // points
+
+    OpenCOR::Solver::Solver::Properties properties;
+
+    properties.insert(OpenCOR::DormandPrinceSolver::MaximumStepId, OpenCOR::DormandPrinceSolver::MaximumStepDefaultValue);
+    properties.insert(OpenCOR::DormandPrinceSolver::MaximumNumberOfStepsId, OpenCOR::DormandPrinceSolver::MaximumNumberOfStepsDefaultValue);
+    properties.insert(OpenCOR::DormandPrinceSolver::RelativeToleranceId, pTolerance);
+    properties.insert(OpenCOR::DormandPrinceSolver::AbsoluteToleranceId, pTolerance);
+    properties.insert(OpenCOR::DormandPrinceSolver::InterpolateSolutionId, pInterpolateSolution);
+
+    double rates[] = { 0.0, 0.0 };
+    double states[] = { 1.0, 0.0 };
+
+    OpenCOR::DormandPrinceSolver::DormandPrinceSolver solver;
+
+    solver.setProperties(properties);
+    solver.initialize(0.0, 2, nullptr, rates, states, nullptr, computeRates);
+
+    double voi = 0.0;
+    double res = 0.0;
+
+    for (int i = 1, iMax = int(std::round(10.0/pPointInterval)); i <= iMax; ++i) {
+        double voiEnd = i*pPointInterval;
+
+        solver.solve(voi, voiEnd);
+
+        res = qMax(res, qMax(std::abs(states[0]-std::cos(voiEnd)),
+                             std::abs(states[1]+std::sin(voiEnd))));
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+void Tests::toleranceTests()
+{
+    // Make sure that our tolerance is honoured, i.e. that the global error of
+    // our solution is within a small multiple of our tolerance and that it
+    // decreases with our tolerance, whether we interpolate our solution or not
+
+    double previousError = 1.0;
+
+    for (auto tolerance : { 1.0e-4, 1.0e-6, 1.0e-8, 1.0e-10 }) {
+        double error = maximumError(tolerance, 0.1, true);
+
+        QVERIFY(error < 10.0*tolerance);
+        QVERIFY(error < previousError);
+
+        QVERIFY(maximumError(tolerance, 0.1, false) < 10.0*tolerance);
+
+        previousError = error;
+    }
+}
+
+//==============================================================================
+
+void Tests::denseOutputTests()
+{
+    // Make sure that our output points that are between steps are computed
+    // using our dense output, i.e. that having many more output points doesn't
+    // require more steps and that those points are as accurate as our steps
+
+    gComputeRatesCount = 0;
+
+    double coarseError = maximumError(1.0e-8, 1.0, true);
+    int coarseComputeRatesCount = gComputeRatesCount;
+
+    gComputeRatesCount = 0;
+
+    double fineError = maximumError(1.0e-8, 0.01, true);
+    int fineComputeRatesCount = gComputeRatesCount;
+
+    QVERIFY(fineError < 1.0e-7);
+    QVERIFY(coarseError < 1.0e-7);
+
+    // Our solver computes our rates once more at each output point, so that
+    // our rates and algebraic variables are up to date, but otherwise we
+    // should have taken exactly the same steps and needed fewer evaluations of
+    // our rates than our 1,000 output points would need if each of them was
+    // reached by a step of its own (i.e. at least six evaluations per point)
+
+    fineComputeRatesCount -= 1000;
+    coarseComputeRatesCount -= 10;
+
+    QVERIFY(fineComputeRatesCount < 1000);
+    QCOMPARE(fineComputeRatesCount, coarseComputeRatesCount);
+}
+
+//==============================================================================
+
+QTEST_APPLESS_MAIN(Tests)
+
+//==============================================================================
+// End of file
+//==============================================================================
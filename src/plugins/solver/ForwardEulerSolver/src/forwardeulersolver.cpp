@@ -47,45 +47,21 @@ void ForwardEulerSolver::initialize(double pVoi, int pRatesStatesCount,
 
     // Initialise the ODE solver itself
 
-    OdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates, pStates,
-                          pAlgebraic, pComputeRates);
+    FixedStepOdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates,
+                                   pStates, pAlgebraic, pComputeRates);
 }
 
 //==============================================================================
 
-void ForwardEulerSolver::solve(double &pVoi, double pVoiEnd) const
+void ForwardEulerSolver::step(double pVoi, const double *pStates,
+                              const double *pRates, double *pNewStates) const
 {
-    // Y_n+1 = Y_n + h * f(t_n, Y_n)
-
-    double voiStart = pVoi;
-
-    int stepNumber = 0;
-    double realStep = mStep;
-
-    while (!qFuzzyCompare(pVoi, pVoiEnd)) {
-        // Check that the time step is correct
-
-        if (pVoi+realStep > pVoiEnd) {
-            realStep = pVoiEnd-pVoi;
-        }
+    Q_UNUSED(pVoi)
 
-        // Compute f(t_n, Y_n)
-
-        mComputeRates(pVoi, mConstants, mRates, mStates, mAlgebraic);
-
-        // Compute Y_n+1
-
-        for (int i = 0; i < mRatesStatesCount; ++i) {
-            mStates[i] += realStep*mRates[i];
-        }
-
-        // Advance through time
+    // Y_n+1 = Y_n + h * f(t_n, Y_n)
 
-        if (!qFuzzyCompare(realStep, mStep)) {
-            pVoi = pVoiEnd;
-        } else {
-            pVoi = voiStart+(++stepNumber)*mStep;
-        }
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        pNewStates[i] = pStates[i]+mStep*pRates[i];
     }
 }
 
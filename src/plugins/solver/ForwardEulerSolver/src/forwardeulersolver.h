@@ -42,7 +42,7 @@ static const double StepDefaultValue = 1.0;
 
 //==============================================================================
 
-class ForwardEulerSolver : public OpenCOR::Solver::OdeSolver
+class ForwardEulerSolver : public OpenCOR::Solver::FixedStepOdeSolver
 {
     Q_OBJECT
 
@@ -51,10 +51,9 @@ public:
                     double *pRates, double *pStates, double *pAlgebraic,
                     ComputeRatesFunction pComputeRates) override;
 
-    void solve(double &pVoi, double pVoiEnd) const override;
-
-private:
-    double mStep = StepDefaultValue;
+protected:
+    void step(double pVoi, const double *pStates, const double *pRates,
+              double *pNewStates) const override;
 };
 
 //==============================================================================
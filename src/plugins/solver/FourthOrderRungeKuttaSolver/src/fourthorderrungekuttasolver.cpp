@@ -34,7 +34,6 @@ FourthOrderRungeKuttaSolver::~FourthOrderRungeKuttaSolver()
 {
     // Delete some internal objects
 
-    delete[] mK1;
     delete[] mK23;
     delete[] mYk123;
 }
@@ -59,23 +58,23 @@ void FourthOrderRungeKuttaSolver::initialize(double pVoi, int pRatesStatesCount,
 
     // Initialise the ODE solver itself
 
-    OdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates, pStates,
-                          pAlgebraic, pComputeRates);
+    FixedStepOdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates,
+                                   pStates, pAlgebraic, pComputeRates);
 
     // (Re)create our various arrays
 
-    delete[] mK1;
     delete[] mK23;
     delete[] mYk123;
 
-    mK1 = new double[pRatesStatesCount] {};
     mK23 = new double[pRatesStatesCount] {};
     mYk123 = new double[pRatesStatesCount] {};
 }
 
 //==============================================================================
 
-void FourthOrderRungeKuttaSolver::solve(double &pVoi, double pVoiEnd) const
+void FourthOrderRungeKuttaSolver::step(double pVoi, const double *pStates,
+                                       const double *pRates,
+                                       double *pNewStates) const
 {
     // k1 = h * f(t_n, Y_n)
     // k2 = h * f(t_n + h / 2, Y_n + k1 / 2)
@@ -89,70 +88,46 @@ void FourthOrderRungeKuttaSolver::solve(double &pVoi, double pVoiEnd) const
     static const double OneOverThree = 1.0/3.0;
     static const double OneOverSix   = 1.0/6.0;
 
-    double voiStart = pVoi;
+    double halfStep = 0.5*mStep;
 
-    int stepNumber = 0;
-    double realStep = mStep;
-    double realHalfStep = 0.5*realStep;
+    // Compute k1 and Yk1
 
-    while (!qFuzzyCompare(pVoi, pVoiEnd)) {
-        // Check that the time step is correct
-
-        if (pVoi+realStep > pVoiEnd) {
-            realStep = pVoiEnd-pVoi;
-            realHalfStep = 0.5*realStep;
-        }
-
-        // Compute f(t_n, Y_n)
-
-        mComputeRates(pVoi, mConstants, mRates, mStates, mAlgebraic);
-
-        // Compute k1 and Yk1
-
-        for (int i = 0; i < mRatesStatesCount; ++i) {
-            mK1[i] = mRates[i];
-            mYk123[i] = mStates[i]+realHalfStep*mK1[i];
-        }
-
-        // Compute f(t_n + h / 2, Y_n + k1 / 2)
-
-        mComputeRates(pVoi+realHalfStep, mConstants, mRates, mYk123, mAlgebraic);
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mYk123[i] = pStates[i]+halfStep*pRates[i];
+    }
 
-        // Compute k2 and Yk2
+    // Compute f(t_n + h / 2, Y_n + k1 / 2)
 
-        for (int i = 0; i < mRatesStatesCount; ++i) {
-            mK23[i] = mRates[i];
-            mYk123[i] = mStates[i]+realHalfStep*mK23[i];
-        }
+    mComputeRates(pVoi+halfStep, mConstants, mRates, mYk123, mAlgebraic);
 
-        // Compute f(t_n + h / 2, Y_n + k2 / 2)
+    // Compute k2 and Yk2
 
-        mComputeRates(pVoi+realHalfStep, mConstants, mRates, mYk123, mAlgebraic);
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mK23[i] = mRates[i];
+        mYk123[i] = pStates[i]+halfStep*mRates[i];
+    }
 
-        // Compute k3 and Yk3
+    // Compute f(t_n + h / 2, Y_n + k2 / 2)
 
-        for (int i = 0; i < mRatesStatesCount; ++i) {
-            mK23[i] += mRates[i];
-            mYk123[i] = mStates[i]+realStep*mK23[i];
-        }
+    mComputeRates(pVoi+halfStep, mConstants, mRates, mYk123, mAlgebraic);
 
-        // Compute f(t_n + h, Y_n + k3)
+    // Compute k3 and Yk3
+    // Note: Yk3 is Y_n + k3 and not Y_n + k2 + k3, which is what mK23 holds at
+    //       this stage, or we would end up with a first-order method...
 
-        mComputeRates(pVoi+realStep, mConstants, mRates, mYk123, mAlgebraic);
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mK23[i] += mRates[i];
+        mYk123[i] = pStates[i]+mStep*mRates[i];
+    }
 
-        // Compute k4 and therefore Y_n+1
+    // Compute f(t_n + h, Y_n + k3)
 
-        for (int i = 0; i < mRatesStatesCount; ++i) {
-            mStates[i] += realStep*(OneOverSix*(mK1[i]+mRates[i])+OneOverThree*mK23[i]);
-        }
+    mComputeRates(pVoi+mStep, mConstants, mRates, mYk123, mAlgebraic);
 
-        // Advance through time
+    // Compute k4 and therefore Y_n+1
 
-        if (!qFuzzyCompare(realStep, mStep)) {
-            pVoi = pVoiEnd;
-        } else {
-            pVoi = voiStart+(++stepNumber)*mStep;
-        }
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        pNewStates[i] = pStates[i]+mStep*(OneOverSix*(pRates[i]+mRates[i])+OneOverThree*mK23[i]);
     }
 }
 
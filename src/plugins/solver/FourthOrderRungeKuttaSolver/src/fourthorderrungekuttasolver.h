@@ -42,7 +42,7 @@ static const double StepDefaultValue = 1.0;
 
 //==============================================================================
 
-class FourthOrderRungeKuttaSolver : public OpenCOR::Solver::OdeSolver
+class FourthOrderRungeKuttaSolver : public OpenCOR::Solver::FixedStepOdeSolver
 {
     Q_OBJECT
 
@@ -53,12 +53,11 @@ public:
                     double *pRates, double *pStates, double *pAlgebraic,
                     ComputeRatesFunction pComputeRates) override;
 
-    void solve(double &pVoi, double pVoiEnd) const override;
+protected:
+    void step(double pVoi, const double *pStates, const double *pRates,
+              double *pNewStates) const override;
 
 private:
-    double mStep = StepDefaultValue;
-
-    double *mK1 = nullptr;
     double *mK23 = nullptr;
     double *mYk123 = nullptr;
 };
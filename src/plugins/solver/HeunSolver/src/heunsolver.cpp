@@ -34,7 +34,6 @@ HeunSolver::~HeunSolver()
 {
     // Delete some internal objects
 
-    delete[] mK;
     delete[] mYk;
 }
 
@@ -57,67 +56,40 @@ void HeunSolver::initialize(double pVoi, int pRatesStatesCount,
 
     // Initialise the ODE solver itself
 
-    OdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates, pStates,
-                          pAlgebraic, pComputeRates);
+    FixedStepOdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates,
+                                   pStates, pAlgebraic, pComputeRates);
 
-    // (Re)create our various arrays
+    // (Re)create our mYk array
 
-    delete[] mK;
     delete[] mYk;
 
-    mK = new double[pRatesStatesCount] {};
     mYk = new double[pRatesStatesCount] {};
 }
 
 //==============================================================================
 
-void HeunSolver::solve(double &pVoi, double pVoiEnd) const
+void HeunSolver::step(double pVoi, const double *pStates, const double *pRates,
+                      double *pNewStates) const
 {
     // k = h * f(t_n, Y_n)
     // Y_n+1 = Y_n + h / 2 * ( f(t_n, Y_n) + f(t_n + h, Y_n + k) )
 
-    double voiStart = pVoi;
+    double halfStep = 0.5*mStep;
 
-    int stepNumber = 0;
-    double realStep = mStep;
-    double realHalfStep = 0.5*realStep;
+    // Compute k and Yk
 
-    while (!qFuzzyCompare(pVoi, pVoiEnd)) {
-        // Check that the time step is correct
-
-        if (pVoi+realStep > pVoiEnd) {
-            realStep = pVoiEnd-pVoi;
-            realHalfStep = 0.5*realStep;
-        }
-
-        // Compute f(t_n, Y_n)
-
-        mComputeRates(pVoi, mConstants, mRates, mStates, mAlgebraic);
-
-        // Compute k and Yk
-
-        for (int i = 0; i < mRatesStatesCount; ++i) {
-            mK[i] = mRates[i];
-            mYk[i] = mStates[i]+realStep*mRates[i];
-        }
-
-        // Compute f(t_n + h, Y_n + k)
-
-        mComputeRates(pVoi+realStep, mConstants, mRates, mYk, mAlgebraic);
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mYk[i] = pStates[i]+mStep*pRates[i];
+    }
 
-        // Compute Y_n+1
+    // Compute f(t_n + h, Y_n + k)
 
-        for (int i = 0; i < mRatesStatesCount; ++i) {
-            mStates[i] += realHalfStep*(mK[i]+mRates[i]);
-        }
+    mComputeRates(pVoi+mStep, mConstants, mRates, mYk, mAlgebraic);
 
-        // Advance through time
+    // Compute Y_n+1
 
-        if (!qFuzzyCompare(realStep, mStep)) {
-            pVoi = pVoiEnd;
-        } else {
-            pVoi = voiStart+(++stepNumber)*mStep;
-        }
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        pNewStates[i] = pStates[i]+halfStep*(pRates[i]+mRates[i]);
     }
 }
 
@@ -42,7 +42,7 @@ static const double StepDefaultValue = 1.0;
 
 //==============================================================================
 
-class HeunSolver : public OpenCOR::Solver::OdeSolver
+class HeunSolver : public OpenCOR::Solver::FixedStepOdeSolver
 {
     Q_OBJECT
 
@@ -53,12 +53,11 @@ public:
                     double *pRates, double *pStates, double *pAlgebraic,
                     ComputeRatesFunction pComputeRates) override;
 
-    void solve(double &pVoi, double pVoiEnd) const override;
+protected:
+    void step(double pVoi, const double *pStates, const double *pRates,
+              double *pNewStates) const override;
 
 private:
-    double mStep = StepDefaultValue;
-
-    double *mK = nullptr;
     double *mYk = nullptr;
 };
 
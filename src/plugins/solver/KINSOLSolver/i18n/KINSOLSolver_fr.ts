@@ -27,5 +27,21 @@
         <source>the &quot;Linear solver&quot; property value could not be retrieved</source>
         <translation>la valeur de la propriété &quot;Solveur linéaire&quot; n&apos;a pas pu être retrouvée</translation>
     </message>
+    <message>
+        <source>the &quot;Reuse Jacobian&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Réutiliser la jacobienne&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
+    <message>
+        <source>the &quot;Jacobian refresh interval&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Intervalle de mise à jour de la jacobienne&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
+    <message>
+        <source>the &quot;Convergence rate threshold&quot; property must have a value between 0 and 1</source>
+        <translation>la propriété &quot;Seuil du taux de convergence&quot; doit avoir une valeur comprise entre 0 et 1</translation>
+    </message>
+    <message>
+        <source>the &quot;Convergence rate threshold&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Seuil du taux de convergence&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
 </context>
 </TS>
@@ -38,6 +38,10 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <cmath>
+
+//==============================================================================
+
 namespace OpenCOR {
 namespace KINSOLSolver {
 
@@ -57,10 +61,21 @@ int systemFunction(N_Vector pY, N_Vector pF, void *pUserData)
     //       solver is badly set up (e.g. Forward Euler with an integration step
     //       that is too big)...
 
+    double residualNorm = 0.0;
+
     for (qint64 i = 0, iMax = static_cast<N_VectorContent_Serial>(pF->content)->length; i < iMax; ++i) {
         if (!qIsFinite(f[i])) {
             return 1;
         }
+
+        residualNorm += f[i]*f[i];
+    }
+
+    // Keep track of our initial residual norm, if needed
+    // Note: this is used to determine how fast KINSOL has converged...
+
+    if (userData->initialResidualNorm() < 0.0) {
+        userData->setInitialResidualNorm(std::sqrt(residualNorm));
     }
 
     return 0;
@@ -110,6 +125,34 @@ void * KinsolSolverUserData::userData() const
 
 //==============================================================================
 
+void KinsolSolverUserData::setUserData(void *pUserData)
+{
+    // Set our user data
+
+    mUserData = pUserData;
+}
+
+//==============================================================================
+
+double KinsolSolverUserData::initialResidualNorm() const
+{
+    // Return our initial residual norm, or a negative value if it has not yet
+    // been computed
+
+    return mInitialResidualNorm;
+}
+
+//==============================================================================
+
+void KinsolSolverUserData::setInitialResidualNorm(double pInitialResidualNorm)
+{
+    // Set our initial residual norm
+
+    mInitialResidualNorm = pInitialResidualNorm;
+}
+
+//==============================================================================
+
 KinsolSolverData::KinsolSolverData(void *pSolver, N_Vector pParametersVector,
                                    N_Vector pOnesVector, SUNMatrix pMatrix,
                                    SUNLinearSolver pLinearSolver,
@@ -177,13 +220,39 @@ KinsolSolverUserData * KinsolSolverData::userData() const
 
 //==============================================================================
 
-void KinsolSolverData::setUserData(KinsolSolverUserData *pUserData)
+bool KinsolSolverData::hasOutdatedJacobian() const
 {
-    // Set our user data, after having delete our 'old' ones
+    // Return whether our Jacobian is outdated
 
-    delete mUserData;
+    return mOutdatedJacobian;
+}
 
-    mUserData = pUserData;
+//==============================================================================
+
+void KinsolSolverData::setOutdatedJacobian(bool pOutdatedJacobian)
+{
+    // Set whether our Jacobian is outdated
+
+    mOutdatedJacobian = pOutdatedJacobian;
+}
+
+//==============================================================================
+
+int KinsolSolverData::jacobianAge() const
+{
+    // Return the age of our Jacobian, i.e. the number of iterations since it
+    // was last updated
+
+    return mJacobianAge;
+}
+
+//==============================================================================
+
+void KinsolSolverData::setJacobianAge(int pJacobianAge)
+{
+    // Set the age of our Jacobian
+
+    mJacobianAge = pJacobianAge;
 }
 
 //==============================================================================
@@ -199,12 +268,19 @@ KinsolSolver::~KinsolSolver()
 
 //==============================================================================
 
-void KinsolSolver::solve(ComputeSystemFunction pComputeSystem,
+void KinsolSolver::solve(int pSystem, ComputeSystemFunction pComputeSystem,
                          double *pParameters, int pSize, void *pUserData)
 {
     // Check whether we need to initialise or update ourselves
+    // Note: our data is indexed by the number of the NLA system to solve, so
+    //       retrieving it is just a matter of accessing an array...
+
+    if (pSystem >= mData.size()) {
+        mData.resize(pSystem+1);
+        mStatistics.resize(pSystem+1);
+    }
 
-    KinsolSolverData *data = mData.value(reinterpret_cast<void *>(pComputeSystem));
+    KinsolSolverData *data = mData[pSystem];
 
     if (data == nullptr) {
         // Retrieve our properties
@@ -260,6 +336,48 @@ void KinsolSolver::solve(ComputeSystemFunction pComputeSystem,
             return;
         }
 
+        // Retrieve our Jacobian reuse properties, if they are relevant, i.e. if
+        // we use a direct linear solver
+        // Note: an iterative linear solver doesn't need a Jacobian since we
+        //       don't use a preconditioner...
+
+        mReuseJacobian = false;
+
+        if (   (linearSolverValue == DenseLinearSolver)
+            || (linearSolverValue == BandedLinearSolver)) {
+            if (mProperties.contains(ReuseJacobianId)) {
+                mReuseJacobian = mProperties.value(ReuseJacobianId).toBool();
+            } else {
+                emit error(tr(R"(the "Reuse Jacobian" property value could not be retrieved)"));
+
+                return;
+            }
+
+            if (mReuseJacobian) {
+                if (mProperties.contains(JacobianRefreshIntervalId)) {
+                    mJacobianRefreshInterval = mProperties.value(JacobianRefreshIntervalId).toInt();
+                } else {
+                    emit error(tr(R"(the "Jacobian refresh interval" property value could not be retrieved)"));
+
+                    return;
+                }
+
+                if (mProperties.contains(ConvergenceRateThresholdId)) {
+                    mConvergenceRateThreshold = mProperties.value(ConvergenceRateThresholdId).toDouble();
+
+                    if (mConvergenceRateThreshold > 1.0) {
+                        emit error(tr(R"(the "Convergence rate threshold" property must have a value between 0 and 1)"));
+
+                        return;
+                    }
+                } else {
+                    emit error(tr(R"(the "Convergence rate threshold" property value could not be retrieved)"));
+
+                    return;
+                }
+            }
+        }
+
         // Create some vectors
 
         N_Vector parametersVector = N_VMake_Serial(pSize, pParameters);
@@ -289,6 +407,13 @@ void KinsolSolver::solve(ComputeSystemFunction pComputeSystem,
 
         KINSetNumMaxIters(solver, maximumNumberOfIterationsValue);
 
+        // Set the maximum number of iterations between Jacobian updates, if we
+        // are to reuse our Jacobian
+
+        if (mReuseJacobian) {
+            KINSetMaxSetupCalls(solver, mJacobianRefreshInterval);
+        }
+
         // Set our linear solver
 
         SUNMatrix matrix = nullptr;
@@ -324,19 +449,71 @@ void KinsolSolver::solve(ComputeSystemFunction pComputeSystem,
         data = new KinsolSolverData(solver, parametersVector, onesVector,
                                     matrix, linearSolver, userData);
 
-        mData.insert(reinterpret_cast<void *>(pComputeSystem), data);
+        mData[pSystem] = data;
     } else {
-        // We are already initiliased, so simply update our user data
+        // We are already initiliased, so simply update our parameters vector
+        // and user data
+        // Note: our parameters and user data may live on the stack of the
+        //       caller, so their address may differ from one call to another...
 
-        data->setUserData(new KinsolSolverUserData(pComputeSystem, pUserData));
+        N_VSetArrayPointer_Serial(pParameters, data->parametersVector());
 
-        KINSetUserData(data->solver(), data->userData());
+        data->userData()->setUserData(pUserData);
+    }
+
+    // Reuse the Jacobian from our previous solve, if requested and possible
+    // Note: this means that we use a modified Newton method across solves, with
+    //       our Jacobian being updated when our previous solve converged too
+    //       slowly or when our Jacobian has been used for too many iterations.
+    //       Also, KINSOL will update our Jacobian itself should a solve fail
+    //       with it...
+
+    void *solver = data->solver();
+
+    if (mReuseJacobian) {
+        KINSetNoInitSetup(solver, data->hasOutdatedJacobian()?SUNFALSE:SUNTRUE);
     }
 
     // Solve our linear system
 
-    KINSol(data->solver(), data->parametersVector(), KIN_LINESEARCH,
-           data->onesVector(), data->onesVector());
+    data->userData()->setInitialResidualNorm(-1.0);
+
+    int flag = KINSol(solver, data->parametersVector(), KIN_LINESEARCH,
+                      data->onesVector(), data->onesVector());
+
+    // Keep track of some statistics about our solve
+
+    long int iterationsCount = 0;
+    long int jacobianEvaluationsCount = 0;
+    double residualNorm = 0.0;
+
+    KINGetNumNonlinSolvIters(solver, &iterationsCount);
+    KINGetNumJacEvals(solver, &jacobianEvaluationsCount);
+    KINGetFuncNorm(solver, &residualNorm);
+
+    mStatistics[pSystem].addSolve(quint64(iterationsCount),
+                                  quint64(jacobianEvaluationsCount),
+                                  residualNorm);
+
+    // Determine whether our Jacobian should be updated before our next solve,
+    // i.e. whether our solve failed, whether our Jacobian has been used for
+    // too many iterations, or whether our solve converged too slowly, i.e. our
+    // residual norm decreased by less than our convergence rate threshold per
+    // iteration on average
+
+    if (mReuseJacobian) {
+        int jacobianAge = int(iterationsCount)+((jacobianEvaluationsCount != 0)?0:data->jacobianAge());
+        double initialResidualNorm = data->userData()->initialResidualNorm();
+        bool slowConvergence = false;
+
+        if ((iterationsCount != 0) && (initialResidualNorm > 0.0)) {
+            slowConvergence = std::pow(residualNorm/initialResidualNorm, 1.0/iterationsCount) > mConvergenceRateThreshold;
+        }
+
+        data->setJacobianAge(jacobianAge);
+        data->setOutdatedJacobian(   (flag < 0) || slowConvergence
+                                  || (jacobianAge >= mJacobianRefreshInterval));
+    }
 }
 
 //==============================================================================
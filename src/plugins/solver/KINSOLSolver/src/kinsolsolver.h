@@ -46,6 +46,9 @@ static const auto MaximumNumberOfIterationsId = QStringLiteral("MaximumNumberOfI
 static const auto LinearSolverId              = QStringLiteral("LinearSolver");
 static const auto UpperHalfBandwidthId        = QStringLiteral("UpperHalfBandwidth");
 static const auto LowerHalfBandwidthId        = QStringLiteral("LowerHalfBandwidth");
+static const auto ReuseJacobianId             = QStringLiteral("ReuseJacobian");
+static const auto JacobianRefreshIntervalId   = QStringLiteral("JacobianRefreshInterval");
+static const auto ConvergenceRateThresholdId  = QStringLiteral("ConvergenceRateThreshold");
 
 //==============================================================================
 
@@ -58,8 +61,12 @@ static const auto TfqmrLinearSolver    = QStringLiteral("TFQMR");
 //==============================================================================
 
 // Default KINSOL parameter values
-// Note: KINSOL's default maximum number of iterations is 200, which ought to be
-//       big enough in most cases...
+// Note #1: KINSOL's default maximum number of iterations is 200, which ought to
+//          be big enough in most cases...
+// Note #2: by default, we don't reuse the Jacobian of an NLA system from one
+//          solve to another, but if we do then it gets refreshed at least
+//          every 10 iterations (i.e. KINSOL's default maximum number of
+//          iterations between calls to the linear solver setup function)...
 
 enum {
     MaximumNumberOfIterationsDefaultValue = 200
@@ -72,6 +79,14 @@ enum {
     LowerHalfBandwidthDefaultValue = 0
 };
 
+static const bool ReuseJacobianDefaultValue = false;
+
+enum {
+    JacobianRefreshIntervalDefaultValue = 10
+};
+
+static const double ConvergenceRateThresholdDefaultValue = 0.5;
+
 //==============================================================================
 
 class KinsolSolverUserData
@@ -83,11 +98,17 @@ public:
     Solver::NlaSolver::ComputeSystemFunction computeSystem() const;
 
     void * userData() const;
+    void setUserData(void *pUserData);
+
+    double initialResidualNorm() const;
+    void setInitialResidualNorm(double pInitialResidualNorm);
 
 private:
     Solver::NlaSolver::ComputeSystemFunction mComputeSystem;
 
     void *mUserData;
+
+    double mInitialResidualNorm = -1.0;
 };
 
 //==============================================================================
@@ -107,7 +128,12 @@ public:
     N_Vector onesVector() const;
 
     KinsolSolverUserData * userData() const;
-    void setUserData(KinsolSolverUserData *pUserData);
+
+    bool hasOutdatedJacobian() const;
+    void setOutdatedJacobian(bool pOutdatedJacobian);
+
+    int jacobianAge() const;
+    void setJacobianAge(int pJacobianAge);
 
 private:
     void *mSolver;
@@ -119,6 +145,9 @@ private:
     SUNLinearSolver mLinearSolver;
 
     KinsolSolverUserData *mUserData;
+
+    bool mOutdatedJacobian = true;
+    int mJacobianAge = 0;
 };
 
 //==============================================================================
@@ -130,11 +159,15 @@ class KinsolSolver : public OpenCOR::Solver::NlaSolver
 public:
     ~KinsolSolver() override;
 
-    void solve(ComputeSystemFunction pComputeSystem, double *pParameters,
-               int pSize, void *pUserData) override;
+    void solve(int pSystem, ComputeSystemFunction pComputeSystem,
+               double *pParameters, int pSize, void *pUserData) override;
 
 private:
-    QHash<void *, KinsolSolverData *> mData;
+    QVector<KinsolSolverData *> mData;
+
+    bool mReuseJacobian = ReuseJacobianDefaultValue;
+    int mJacobianRefreshInterval = JacobianRefreshIntervalDefaultValue;
+    double mConvergenceRateThreshold = ConvergenceRateThresholdDefaultValue;
 };
 
 //==============================================================================
@@ -158,6 +158,9 @@ Solver::Properties KINSOLSolverPlugin::solverProperties() const
     Descriptions LinearSolverDescriptions;
     Descriptions UpperHalfBandwidthDescriptions;
     Descriptions LowerHalfBandwidthDescriptions;
+    Descriptions ReuseJacobianDescriptions;
+    Descriptions JacobianRefreshIntervalDescriptions;
+    Descriptions ConvergenceRateThresholdDescriptions;
 
     MaximumNumberOfIterationsDescriptions.insert("en", QString::fromUtf8("Maximum number of iterations"));
     MaximumNumberOfIterationsDescriptions.insert("fr", QString::fromUtf8("Nombre maximum d'itérations"));
@@ -171,6 +174,15 @@ Solver::Properties KINSOLSolverPlugin::solverProperties() const
     LowerHalfBandwidthDescriptions.insert("en", QString::fromUtf8("Lower half-bandwidth"));
     LowerHalfBandwidthDescriptions.insert("fr", QString::fromUtf8("Demi largeur de bande inférieure"));
 
+    ReuseJacobianDescriptions.insert("en", QString::fromUtf8("Reuse Jacobian"));
+    ReuseJacobianDescriptions.insert("fr", QString::fromUtf8("Réutiliser la jacobienne"));
+
+    JacobianRefreshIntervalDescriptions.insert("en", QString::fromUtf8("Jacobian refresh interval"));
+    JacobianRefreshIntervalDescriptions.insert("fr", QString::fromUtf8("Intervalle de mise à jour de la jacobienne"));
+
+    ConvergenceRateThresholdDescriptions.insert("en", QString::fromUtf8("Convergence rate threshold"));
+    ConvergenceRateThresholdDescriptions.insert("fr", QString::fromUtf8("Seuil du taux de convergence"));
+
     QStringList LinearSolverListValues = { DenseLinearSolver,
                                            BandedLinearSolver,
                                            GmresLinearSolver,
@@ -180,7 +192,10 @@ Solver::Properties KINSOLSolverPlugin::solverProperties() const
     return { Solver::Property(Solver::Property::Type::IntegerGt0, MaximumNumberOfIterationsId, MaximumNumberOfIterationsDescriptions, {}, MaximumNumberOfIterationsDefaultValue, false),
              Solver::Property(Solver::Property::Type::List, LinearSolverId, LinearSolverDescriptions, LinearSolverListValues, LinearSolverDefaultValue, false),
              Solver::Property(Solver::Property::Type::IntegerGe0, UpperHalfBandwidthId, UpperHalfBandwidthDescriptions, {}, UpperHalfBandwidthDefaultValue, false),
-             Solver::Property(Solver::Property::Type::IntegerGe0, LowerHalfBandwidthId, LowerHalfBandwidthDescriptions, {}, LowerHalfBandwidthDefaultValue, false) };
+             Solver::Property(Solver::Property::Type::IntegerGe0, LowerHalfBandwidthId, LowerHalfBandwidthDescriptions, {}, LowerHalfBandwidthDefaultValue, false),
+             Solver::Property(Solver::Property::Type::Boolean, ReuseJacobianId, ReuseJacobianDescriptions, {}, ReuseJacobianDefaultValue, false),
+             Solver::Property(Solver::Property::Type::IntegerGt0, JacobianRefreshIntervalId, JacobianRefreshIntervalDescriptions, {}, JacobianRefreshIntervalDefaultValue, false),
+             Solver::Property(Solver::Property::Type::DoubleGt0, ConvergenceRateThresholdId, ConvergenceRateThresholdDescriptions, {}, ConvergenceRateThresholdDefaultValue, false) };
 }
 
 //==============================================================================
@@ -206,6 +221,23 @@ QMap<QString, bool> KINSOLSolverPlugin::solverPropertiesVisibility(const QMap<QS
         res.insert(LowerHalfBandwidthId, false);
     }
 
+    if (   (linearSolver == DenseLinearSolver)
+        || (linearSolver == BandedLinearSolver)) {
+        // Dense/banded linear solver, so our Jacobian may be reused
+
+        bool reuseJacobian = QVariant(pSolverPropertiesValues.value(ReuseJacobianId)).toBool();
+
+        res.insert(ReuseJacobianId, true);
+        res.insert(JacobianRefreshIntervalId, reuseJacobian);
+        res.insert(ConvergenceRateThresholdId, reuseJacobian);
+    } else {
+        // GMRES/Bi-CGStab/TFQMR linear solver, so no Jacobian to reuse
+
+        res.insert(ReuseJacobianId, false);
+        res.insert(JacobianRefreshIntervalId, false);
+        res.insert(ConvergenceRateThresholdId, false);
+    }
+
     return res;
 }
 
@@ -57,8 +57,8 @@ void SecondOrderRungeKuttaSolver::initialize(double pVoi, int pRatesStatesCount,
 
     // Initialise the ODE solver itself
 
-    OdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates, pStates,
-                          pAlgebraic, pComputeRates);
+    FixedStepOdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates,
+                                   pStates, pAlgebraic, pComputeRates);
 
     // (Re)create our mYk1 array
 
@@ -69,7 +69,9 @@ void SecondOrderRungeKuttaSolver::initialize(double pVoi, int pRatesStatesCount,
 
 //==============================================================================
 
-void SecondOrderRungeKuttaSolver::solve(double &pVoi, double pVoiEnd) const
+void SecondOrderRungeKuttaSolver::step(double pVoi, const double *pStates,
+                                       const double *pRates,
+                                       double *pNewStates) const
 {
     // k1 = h * f(t_n, Y_n)
     // k2 = h * f(t_n + h / 2, Y_n + k1 / 2)
@@ -78,47 +80,22 @@ void SecondOrderRungeKuttaSolver::solve(double &pVoi, double pVoiEnd) const
     // Note: the algorithm hereafter doesn't compute k1 and k2 as such and this
     //       simply for performance reasons...
 
-    double voiStart = pVoi;
+    double halfStep = 0.5*mStep;
 
-    int stepNumber = 0;
-    double realStep = mStep;
-    double realHalfStep = 0.5*realStep;
+    // Compute k1 and therefore Yk1
 
-    while (!qFuzzyCompare(pVoi, pVoiEnd)) {
-        // Check that the time step is correct
-
-        if (pVoi+realStep > pVoiEnd) {
-            realStep = pVoiEnd-pVoi;
-            realHalfStep = 0.5*realStep;
-        }
-
-        // Compute f(t_n, Y_n)
-
-        mComputeRates(pVoi, mConstants, mRates, mStates, mAlgebraic);
-
-        // Compute k1 and therefore Yk1
-
-        for (int i = 0; i < mRatesStatesCount; ++i) {
-            mYk1[i] = mStates[i]+realHalfStep*mRates[i];
-        }
-
-        // Compute f(t_n + h / 2, Y_n + k1 / 2)
-
-        mComputeRates(pVoi+realHalfStep, mConstants, mRates, mYk1, mAlgebraic);
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mYk1[i] = pStates[i]+halfStep*pRates[i];
+    }
 
-        // Compute Y_n+1
+    // Compute f(t_n + h / 2, Y_n + k1 / 2)
 
-        for (int i = 0; i < mRatesStatesCount; ++i) {
-            mStates[i] += realStep*mRates[i];
-        }
+    mComputeRates(pVoi+halfStep, mConstants, mRates, mYk1, mAlgebraic);
 
-        // Advance through time
+    // Compute Y_n+1
 
-        if (!qFuzzyCompare(realStep, mStep)) {
-            pVoi = pVoiEnd;
-        } else {
-            pVoi = voiStart+(++stepNumber)*mStep;
-        }
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        pNewStates[i] = pStates[i]+mStep*mRates[i];
     }
 }
 
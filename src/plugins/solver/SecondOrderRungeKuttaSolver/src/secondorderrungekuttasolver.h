@@ -42,7 +42,7 @@ static const double StepDefaultValue = 1.0;
 
 //==============================================================================
 
-class SecondOrderRungeKuttaSolver : public OpenCOR::Solver::OdeSolver
+class SecondOrderRungeKuttaSolver : public OpenCOR::Solver::FixedStepOdeSolver
 {
     Q_OBJECT
 
@@ -53,11 +53,11 @@ public:
                     double *pRates, double *pStates, double *pAlgebraic,
                     ComputeRatesFunction pComputeRates) override;
 
-    void solve(double &pVoi, double pVoiEnd) const override;
+protected:
+    void step(double pVoi, const double *pStates, const double *pRates,
+              double *pNewStates) const override;
 
 private:
-    double mStep = StepDefaultValue;
-
     double *mYk1 = nullptr;
 };
 
@@ -25,18 +25,21 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
-void doNonLinearSolve(char *pRuntime,
+void doNonLinearSolve(void *pNlaSolverContext, int pSystem,
                       void (*pFunction)(double *, double *, void *),
                       double *pParameters, int pSize, void *pUserData)
 {
     // Retrieve the NLA solver which we should use and solve our NLA system
-    // Note: we should always have an NLA solver, but better be safe than
-    //       sorry...
+    // Note #1: pNlaSolverContext is the address of our runtime's NLA solver
+    //          context, which was baked into the model code when it got
+    //          compiled, so no lookup is needed to find it...
+    // Note #2: we should always have an NLA solver, but better be safe than
+    //          sorry...
 
-    OpenCOR::Solver::NlaSolver *nlaSolver = OpenCOR::Solver::nlaSolver(pRuntime);
+    OpenCOR::Solver::NlaSolver *nlaSolver = static_cast<OpenCOR::Solver::NlaSolverContext *>(pNlaSolverContext)->nlaSolver();
 
     if (nlaSolver != nullptr) {
-        nlaSolver->solve(pFunction, pParameters, pSize, pUserData);
+        nlaSolver->solve(pSystem, pFunction, pParameters, pSize, pUserData);
     } else {
         qWarning("WARNING | %s:%d: no NLA solver could be found.", __FILE__, __LINE__);
     }
@@ -52,7 +55,7 @@ extern "C" Q_DECL_EXPORT int solverInterfaceVersion()
 {
     // Version of the solver interface
 
-    return 2;
+    return 10;
 }
 
 //==============================================================================
@@ -97,6 +100,53 @@ void Solver::emitError(const QString &pErrorMessage)
 
 //==============================================================================
 
+void OdeSolver::setStatesDependencies(const StatesDependencies &pStatesDependencies)
+{
+    // Keep track of the states on which each rate depends, if known
+    // Note: this is to be called before initialize() and it allows solvers
+    //       that need a Jacobian to compute it more efficiently...
+
+    mStatesDependencies = pStatesDependencies;
+}
+
+//==============================================================================
+
+void OdeSolver::setRootsFunction(int pRootsCount,
+                                 ComputeRootsFunction pComputeRoots)
+{
+    // Keep track of the function that computes the roots of our model, i.e.
+    // functions that change sign whenever one of its discontinuities is crossed
+    // Note: this is to be called before initialize() and it allows solvers
+    //       that support root finding to stop exactly at those
+    //       discontinuities...
+
+    mRootsCount = pRootsCount;
+    mComputeRoots = pComputeRoots;
+}
+
+//==============================================================================
+
+void OdeSolver::setSensitivities(const QVector<int> &pParameters,
+                                 double *pSensitivities,
+                                 ComputeComputedConstantsFunction pComputeComputedConstants)
+{
+    // Keep track of the constants with respect to which we are to compute the
+    // sensitivities of our states, of where those sensitivities are to be
+    // stored, and of the function that computes our computed constants, since
+    // some of them may depend on those constants
+    // Note #1: this is to be called before initialize() and only if
+    //          supportsSensitivities() returns true...
+    // Note #2: the sensitivity of the Ith state with respect to the Pth
+    //          parameter is to be stored at
+    //          pSensitivities[P*mRatesStatesCount+I]...
+
+    mSensitivityParameters = pParameters;
+    mSensitivities = pSensitivities;
+    mComputeComputedConstants = pComputeComputedConstants;
+}
+
+//==============================================================================
+
 void OdeSolver::initialize(double pVoi, int pRatesStatesCount,
                            double *pConstants, double *pRates, double *pStates,
                            double *pAlgebraic,
@@ -127,38 +177,245 @@ void OdeSolver::reinitialize(double pVoi)
 
 //==============================================================================
 
-NlaSolver::~NlaSolver() = default;
+bool OdeSolver::hasFixedStep() const
+{
+    // Return whether we use a fixed step, i.e. whether the steps we take are
+    // independent of our states and whether the new value of a state only
+    // depends on its rates
+    // Note: this means that we can solve several instances of a model at once
+    //       by considering them as one big model (see
+    //       SimulationSupport::SimulationEnsembleWorker)...
+
+    return false;
+}
+
+//==============================================================================
+
+bool OdeSolver::supportsSensitivities() const
+{
+    // Return whether we can compute the sensitivities of our states with
+    // respect to some of our constants (see setSensitivities())
+
+    return false;
+}
+
+//==============================================================================
+
+FixedStepOdeSolver::~FixedStepOdeSolver()
+{
+    // Delete some internal objects
+
+    delete[] mY;
+    delete[] mF;
+    delete[] mPreviousY;
+    delete[] mPreviousF;
+}
 
 //==============================================================================
 
-QString objectAddress(QObject *pObject)
+void FixedStepOdeSolver::initialize(double pVoi, int pRatesStatesCount,
+                                    double *pConstants, double *pRates,
+                                    double *pStates, double *pAlgebraic,
+                                    ComputeRatesFunction pComputeRates)
 {
-    // Return the given object's address as a string
+    // Initialise the ODE solver itself
+
+    OdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates, pStates,
+                          pAlgebraic, pComputeRates);
+
+    // (Re)create our various arrays
+
+    delete[] mY;
+    delete[] mF;
+    delete[] mPreviousY;
+    delete[] mPreviousF;
 
-    return QString::number(quint64(pObject));
+    mY = new double[pRatesStatesCount] {};
+    mF = new double[pRatesStatesCount] {};
+    mPreviousY = new double[pRatesStatesCount] {};
+    mPreviousF = new double[pRatesStatesCount] {};
+
+    // Start integrating from the given point
+
+    FixedStepOdeSolver::reinitialize(pVoi);
 }
 
 //==============================================================================
 
-NlaSolver * nlaSolver(const QString &pObjectAddress)
+void FixedStepOdeSolver::reinitialize(double pVoi)
 {
-    // Return the runtime's NLA solver
+    // Restart our integration grid from the given point, using our current
+    // states
+    // Note: our rates are computed lazily (see solve()) since, if our model
+    //       needs an NLA solver, the latter may not be fully set up yet...
+
+    mVoiStart = pVoi;
+    mStepNumber = 0;
+    mNeedRates = true;
+
+    mVoi = pVoi;
+    mPreviousVoi = pVoi;
 
-    QObject *object = reinterpret_cast<NlaSolver *>(QVariant(pObjectAddress).toULongLong());
+    memcpy(mY, mStates, size_t(mRatesStatesCount)*SizeOfDouble);
+}
+
+//==============================================================================
+
+void FixedStepOdeSolver::solve(double &pVoi, double pVoiEnd) const
+{
+    // Step through our own integration grid, i.e. mVoiStart+n*mStep, until we
+    // reach or go past pVoiEnd, and then compute our states at pVoiEnd using
+    // cubic Hermite interpolation between our last two grid points
+    // Note #1: this means that our step sequence is not affected by our output
+    //          points, unlike if we were to shorten our last step to land on
+    //          pVoiEnd...
+    // Note #2: f(t_n+1, Y_n+1) is both needed for our interpolation and as
+    //          f(t_n, Y_n) for our next step, so we only compute it once...
+
+    if (mNeedRates) {
+        mComputeRates(mVoi, mConstants, mF, mY, mAlgebraic);
+
+        mNeedRates = false;
+    }
+
+    while ((mVoi < pVoiEnd) && !qFuzzyCompare(mVoi, pVoiEnd)) {
+        std::swap(mY, mPreviousY);
+        std::swap(mF, mPreviousF);
+
+        mPreviousVoi = mVoi;
+
+        step(mPreviousVoi, mPreviousY, mPreviousF, mY);
+
+        mVoi = mVoiStart+double(++mStepNumber)*mStep;
+
+        mComputeRates(mVoi, mConstants, mF, mY, mAlgebraic);
+    }
+
+    // Compute our states and rates at pVoiEnd
+
+    if (qFuzzyCompare(mVoi, pVoiEnd) || qFuzzyCompare(mVoi, mPreviousVoi)) {
+        memcpy(mStates, mY, size_t(mRatesStatesCount)*SizeOfDouble);
+        memcpy(mRates, mF, size_t(mRatesStatesCount)*SizeOfDouble);
+    } else {
+        double step = mVoi-mPreviousVoi;
+        double theta = (pVoiEnd-mPreviousVoi)/step;
+        double thetaSquared = theta*theta;
+        double oneMinusTheta = 1.0-theta;
+        double h00 = (1.0+2.0*theta)*oneMinusTheta*oneMinusTheta;
+        double h10 = step*theta*oneMinusTheta*oneMinusTheta;
+        double h01 = thetaSquared*(3.0-2.0*theta);
+        double h11 = step*thetaSquared*(theta-1.0);
+        double dh00 = 6.0*theta*(theta-1.0)/step;
+        double dh10 = (3.0*theta-1.0)*(theta-1.0);
+        double dh11 = theta*(3.0*theta-2.0);
+
+        for (int i = 0; i < mRatesStatesCount; ++i) {
+            mStates[i] = h00*mPreviousY[i]+h10*mPreviousF[i]+h01*mY[i]+h11*mF[i];
+            mRates[i] = dh00*(mPreviousY[i]-mY[i])+dh10*mPreviousF[i]+dh11*mF[i];
+        }
+    }
+
+    pVoi = pVoiEnd;
+}
+
+//==============================================================================
+
+bool FixedStepOdeSolver::hasFixedStep() const
+{
+    // We use a fixed step
+
+    return true;
+}
+
+//==============================================================================
+
+void NlaSystemStatistics::addSolve(quint64 pIterationsCount,
+                                   quint64 pJacobianEvaluationsCount,
+                                   double pResidualNorm)
+{
+    // Keep track of a new solve of our NLA system
+
+    ++mSolvesCount;
+
+    mIterationsCount += pIterationsCount;
+    mJacobianEvaluationsCount += pJacobianEvaluationsCount;
+    mMaximumResidualNorm = qMax(mMaximumResidualNorm, pResidualNorm);
+}
+
+//==============================================================================
+
+quint64 NlaSystemStatistics::solvesCount() const
+{
+    // Return our number of solves
+
+    return mSolvesCount;
+}
+
+//==============================================================================
+
+quint64 NlaSystemStatistics::iterationsCount() const
+{
+    // Return our total number of iterations
+
+    return mIterationsCount;
+}
+
+//==============================================================================
+
+quint64 NlaSystemStatistics::jacobianEvaluationsCount() const
+{
+    // Return our total number of Jacobian evaluations
+
+    return mJacobianEvaluationsCount;
+}
+
+//==============================================================================
+
+double NlaSystemStatistics::maximumResidualNorm() const
+{
+    // Return the maximum residual norm we got at the end of a solve
+
+    return mMaximumResidualNorm;
+}
+
+//==============================================================================
+
+NlaSolver::~NlaSolver() = default;
+
+//==============================================================================
+
+NlaSolver::Statistics NlaSolver::statistics() const
+{
+    // Return the statistics for each of the NLA systems we have solved, if
+    // the NLA solver keeps track of them
+    // Note: the statistics for an NLA system are at the index given by its
+    //       number...
+
+    return mStatistics;
+}
+
+//==============================================================================
+
+NlaSolver * NlaSolverContext::nlaSolver() const
+{
+    // Return the NLA solver to be used by the calling thread
+    // Note: we keep track of our NLA solvers using QPointer, so that we get a
+    //       null pointer rather than a dangling one if an NLA solver gets
+    //       deleted without first being unset...
 
-    return reinterpret_cast<NlaSolver *>(QVariant(object->objectName()).toULongLong());
+    return mNlaSolvers.hasLocalData()?mNlaSolvers.localData().data():nullptr;
 }
 
 //==============================================================================
 
-void setNlaSolver(QObject *pObject, NlaSolver *pNlaSolver)
+void NlaSolverContext::setNlaSolver(NlaSolver *pNlaSolver)
 {
-    // Keep track of the runtime's NLA solver
-    // Note: normally, we would use QObject::setProperty(), but it doesn't play
-    //       well on Windows without a GUI (see https://bit.ly/2YCpzew). So,
-    //       instead, we use QObject::setObjectName() (!!)...
+    // Keep track of the NLA solver to be used by the calling thread
+    // Note: each thread (e.g. a simulation worker or an ensemble worker) has
+    //       its own NLA solver, which means that several simulations of the
+    //       same model can be run concurrently...
 
-    pObject->setObjectName(objectAddress(pNlaSolver));
+    mNlaSolvers.setLocalData(pNlaSolver);
 }
 
 //==============================================================================
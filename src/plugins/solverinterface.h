@@ -29,11 +29,14 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QPointer>
+#include <QThreadStorage>
 #include <QVariant>
+#include <QVector>
 
 //==============================================================================
 
-extern "C" void doNonLinearSolve(char *pRuntime,
+extern "C" void doNonLinearSolve(void *pNlaSolverContext, int pSystem,
                                  void (*pFunction)(double *, double *, void *),
                                  double *pParameters, int pSize,
                                  void *pUserData);
@@ -74,7 +77,16 @@ signals:
 class OdeSolver : public Solver
 {
 public:
+    using ComputeComputedConstantsFunction = void (*)(double pVoi, double *pConstants, double *pRates, double *pStates, double *pAlgebraic);
     using ComputeRatesFunction = void (*)(double pVoi, double *pConstants, double *pRates, double *pStates, double *pAlgebraic);
+    using ComputeRootsFunction = void (*)(double pVoi, double *pConstants, double *pRates, double *pStates, double *pAlgebraic, double *pRoots);
+    using StatesDependencies = QVector<QVector<int>>;
+
+    void setStatesDependencies(const StatesDependencies &pStatesDependencies);
+    void setRootsFunction(int pRootsCount, ComputeRootsFunction pComputeRoots);
+    void setSensitivities(const QVector<int> &pParameters,
+                          double *pSensitivities,
+                          ComputeComputedConstantsFunction pComputeComputedConstants);
 
     virtual void initialize(double pVoi, int pRatesStatesCount,
                             double *pConstants, double *pRates, double *pStates,
@@ -84,6 +96,9 @@ public:
 
     virtual void solve(double &pVoi, double pVoiEnd) const = 0;
 
+    virtual bool hasFixedStep() const;
+    virtual bool supportsSensitivities() const;
+
 protected:
     int mRatesStatesCount = 0;
 
@@ -93,29 +108,105 @@ protected:
     double *mAlgebraic = nullptr;
 
     ComputeRatesFunction mComputeRates = nullptr;
+
+    StatesDependencies mStatesDependencies;
+
+    int mRootsCount = 0;
+    ComputeRootsFunction mComputeRoots = nullptr;
+
+    QVector<int> mSensitivityParameters;
+    double *mSensitivities = nullptr;
+    ComputeComputedConstantsFunction mComputeComputedConstants = nullptr;
 };
 
 //==============================================================================
 
-class NlaSolver : public Solver
+class FixedStepOdeSolver : public OdeSolver
 {
 public:
-    ~NlaSolver() override;
+    ~FixedStepOdeSolver() override;
+
+    void initialize(double pVoi, int pRatesStatesCount, double *pConstants,
+                    double *pRates, double *pStates, double *pAlgebraic,
+                    ComputeRatesFunction pComputeRates) override;
+    void reinitialize(double pVoi) override;
+
+    void solve(double &pVoi, double pVoiEnd) const override;
+
+    bool hasFixedStep() const override;
+
+protected:
+    double mStep = 0.0;
+
+    virtual void step(double pVoi, const double *pStates, const double *pRates,
+                      double *pNewStates) const = 0;
+
+private:
+    double mVoiStart = 0.0;
+
+    mutable quint64 mStepNumber = 0;
+    mutable bool mNeedRates = true;
+
+    mutable double mVoi = 0.0;
+    mutable double mPreviousVoi = 0.0;
 
+    mutable double *mY = nullptr;
+    mutable double *mF = nullptr;
+    mutable double *mPreviousY = nullptr;
+    mutable double *mPreviousF = nullptr;
+};
+
+//==============================================================================
+
+class NlaSystemStatistics
+{
+public:
+    void addSolve(quint64 pIterationsCount, quint64 pJacobianEvaluationsCount,
+                  double pResidualNorm);
+
+    quint64 solvesCount() const;
+    quint64 iterationsCount() const;
+    quint64 jacobianEvaluationsCount() const;
+    double maximumResidualNorm() const;
+
+private:
+    quint64 mSolvesCount = 0;
+    quint64 mIterationsCount = 0;
+    quint64 mJacobianEvaluationsCount = 0;
+    double mMaximumResidualNorm = 0.0;
+};
+
+//==============================================================================
+
+class NlaSolver : public Solver
+{
+public:
     using ComputeSystemFunction = void (*)(double *, double *, void *);
+    using Statistics = QVector<NlaSystemStatistics>;
 
-    virtual void solve(ComputeSystemFunction pComputeSystem,
+    ~NlaSolver() override;
+
+    virtual void solve(int pSystem, ComputeSystemFunction pComputeSystem,
                        double *pParameters, int pSize,
                        void *pUserData = nullptr) = 0;
+
+    Statistics statistics() const;
+
+protected:
+    Statistics mStatistics;
 };
 
 //==============================================================================
 
-QString objectAddress(QObject *pObject);
-
-NlaSolver * nlaSolver(const QString &pObjectAddress);
+class NlaSolverContext
+{
+public:
+    NlaSolver * nlaSolver() const;
+    void setNlaSolver(NlaSolver *pNlaSolver);
 
-void setNlaSolver(QObject *pObject, NlaSolver *pNlaSolver);
+private:
+    QThreadStorage<QPointer<NlaSolver>> mNlaSolvers;
+};
 
 //==============================================================================
 
@@ -23,6 +23,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 #include "cellmlfile.h"
 #include "cellmlfilecellml10exporter.h"
+#include "cellmlfileimportcache.h"
 #include "cellmlfilemanager.h"
 #include "centralwidget.h"
 #include "corecliutils.h"
@@ -69,6 +70,11 @@ CellmlFile::CellmlFile(const QString &pFileName) :
 CellmlFile::~CellmlFile()
 {
     // Reset ourselves
+    // Note: we forget about our import contents first, so that our remote
+    //       imports remain in our import cache for other CellML files that may
+    //       need them...
+
+    mImportContents.clear();
 
     try {
         reset();
@@ -108,6 +114,26 @@ void CellmlFile::reset()
     mFullInstantiationNeeded = true;
     mDependenciesNeeded = true;
 
+    // Remove our remote imports from our import cache, so that they get
+    // fetched again (in case they have been updated) the next time we are
+    // loaded
+    // Note: our local imports don't need to be removed since they are only
+    //       reused if they haven't been modified...
+
+    CellmlFileImportCache *importCacheInstance = CellmlFileImportCache::instance();
+
+    for (auto importContents = mImportContents.constBegin(), importContentsEnd = mImportContents.constEnd();
+         importContents != importContentsEnd; ++importContents) {
+        bool isLocalFile;
+        QString dummy;
+
+        Core::checkFileNameOrUrl(importContents.key(), isLocalFile, dummy);
+
+        if (!isLocalFile) {
+            importCacheInstance->remove(importContents.key());
+        }
+    }
+
     mImportContents.clear();
 
     mUsedCmetaIds.clear();
@@ -159,6 +185,59 @@ void CellmlFile::retrieveImports(const QString &pXmlBase,
 
 //==============================================================================
 
+void CellmlFile::prefetchImports(const QString &pFileNameOrUrl,
+                                 const QList<iface::cellml_api::CellMLImport *> &pImportList,
+                                 const QStringList &pImportXmlBaseList)
+{
+    // Prefetch the contents of the given import together with that of our
+    // pending imports that have not yet been instantiated, with a busy widget
+    // if we are dealing with some remote files
+    // Note: this means that sibling imports get fetched concurrently rather
+    //       than one after the other...
+
+    QStringList fileNamesOrUrls = { pFileNameOrUrl };
+
+    for (int i = 0, iMax = pImportList.count(); i < iMax; ++i) {
+        iface::cellml_api::CellMLImport *import = pImportList[i];
+
+        if (!import->wasInstantiated()) {
+            QString url = QUrl(pImportXmlBaseList[i]).resolved(QString::fromStdWString(import->xlinkHref()->asText())).toString();
+            bool isLocalFile;
+            QString fileNameOrUrl;
+
+            Core::checkFileNameOrUrl(url, isLocalFile, fileNameOrUrl);
+
+            if (   (fileNameOrUrl != mFileName)
+                && !mImportContents.contains(fileNameOrUrl)) {
+                fileNamesOrUrls << fileNameOrUrl;
+            }
+        }
+    }
+
+    bool hasRemoteFiles = false;
+
+    for (const auto &fileNameOrUrl : qAsConst(fileNamesOrUrls)) {
+        bool isLocalFile;
+        QString dummy;
+
+        Core::checkFileNameOrUrl(fileNameOrUrl, isLocalFile, dummy);
+
+        hasRemoteFiles = hasRemoteFiles || !isLocalFile;
+    }
+
+    if (hasRemoteFiles) {
+        Core::showCentralBusyWidget();
+    }
+
+    CellmlFileImportCache::instance()->prefetch(fileNamesOrUrls);
+
+    if (hasRemoteFiles) {
+        Core::hideCentralBusyWidget();
+    }
+}
+
+//==============================================================================
+
 bool CellmlFile::fullyInstantiateImports(iface::cellml_api::Model *pModel,
                                          CellmlFileIssues &pIssues)
 {
@@ -230,23 +309,20 @@ bool CellmlFile::fullyInstantiateImports(iface::cellml_api::Model *pModel,
 
                         import->instantiateFromText(mImportContents.value(fileNameOrUrl).toStdWString());
                     } else {
-                        // We haven't already loaded the import contents, so do
-                        // so now, with a busy widget if requested and if we are
-                        // not dealing with a local file
+                        // We haven't already loaded the import contents, so
+                        // retrieve them from our import cache, after having
+                        // prefetched them, if needed, together with the
+                        // contents of our other pending imports
 
-                        QString fileContents;
+                        CellmlFileImportCache *importCacheInstance = CellmlFileImportCache::instance();
 
-                        if (!isLocalFile) {
-                            Core::showCentralBusyWidget();
+                        if (!importCacheInstance->contains(fileNameOrUrl)) {
+                            prefetchImports(fileNameOrUrl, importList, importXmlBaseList);
                         }
 
-                        bool res = Core::readFile(fileNameOrUrl, fileContents);
-
-                        if (!isLocalFile) {
-                            Core::hideCentralBusyWidget();
-                        }
+                        QString fileContents;
 
-                        if (res) {
+                        if (importCacheInstance->contents(fileNameOrUrl, fileContents)) {
                             // We were able to retrieve the import contents, so
                             // instantiate the import with it
 
@@ -168,6 +168,9 @@ private:
                          QList<iface::cellml_api::CellMLImport *> &pImportList,
                          QStringList &pImportXmlBaseList);
 
+    void prefetchImports(const QString &pFileNameOrUrl,
+                         const QList<iface::cellml_api::CellMLImport *> &pImportList,
+                         const QStringList &pImportXmlBaseList);
     bool fullyInstantiateImports(iface::cellml_api::Model *pModel,
                                  CellmlFileIssues &pIssues);
 
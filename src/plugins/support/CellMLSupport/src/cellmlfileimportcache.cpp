@@ -0,0 +1,357 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// CellML file import cache
+//==============================================================================
+
+#include "cellmlfileimportcache.h"
+#include "corecliutils.h"
+#include "file.h"
+
+//==============================================================================
+
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QMutexLocker>
+#include <QtConcurrent/QtConcurrent>
+
+//==============================================================================
+
+#include <limits>
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace CellMLSupport {
+
+//==============================================================================
+
+static const qint64 MaxSize = 64*1024*1024;   // 64 MB
+
+//==============================================================================
+
+CellmlFileImportCache::CellmlFileImportCache() :
+    mMaxSize(MaxSize)
+{
+}
+
+//==============================================================================
+
+CellmlFileImportCache * CellmlFileImportCache::instance()
+{
+    // Return the 'global' instance of our CellML file import cache class
+
+    static CellmlFileImportCache instance;
+
+    return static_cast<CellmlFileImportCache *>(Core::globalInstance("OpenCOR::CellMLSupport::CellmlFileImportCache::instance()",
+                                                                     &instance));
+}
+
+//==============================================================================
+
+bool CellmlFileImportCache::contains(const QString &pFileNameOrUrl)
+{
+    // Return whether we have an up-to-date version of the given file
+
+    QMutexLocker locker(&mMutex);
+
+    return isUpToDate(pFileNameOrUrl);
+}
+
+//==============================================================================
+
+bool CellmlFileImportCache::contents(const QString &pFileNameOrUrl,
+                                     QString &pContents)
+{
+    // Retrieve the contents of the given file, should we have an up-to-date
+    // version of it
+
+    QMutexLocker locker(&mMutex);
+
+    if (!isUpToDate(pFileNameOrUrl)) {
+        return false;
+    }
+
+    QString sha1 = mStampsSha1.value(pFileNameOrUrl).second;
+
+    pContents = mContents.value(sha1);
+
+    use(sha1);
+
+    return true;
+}
+
+//==============================================================================
+
+void CellmlFileImportCache::prefetch(const QStringList &pFileNamesOrUrls)
+{
+    // Determine which of the given files we need to fetch
+
+    QStringList fileNamesOrUrls;
+    bool hasRemoteFiles = false;
+
+    for (const auto &fileNameOrUrl : pFileNamesOrUrls) {
+        if (!fileNamesOrUrls.contains(fileNameOrUrl) && !contains(fileNameOrUrl)) {
+            bool isLocalFile;
+            QString dummy;
+
+            Core::checkFileNameOrUrl(fileNameOrUrl, isLocalFile, dummy);
+
+            fileNamesOrUrls << fileNameOrUrl;
+
+            hasRemoteFiles = hasRemoteFiles || !isLocalFile;
+        }
+    }
+
+    // Fetch the files, concurrently if there are several of them
+    // Note #1: remote files may take a while to be fetched, so we wait for
+    //          them using an event loop, as is done when reading a remote file,
+    //          rather than by blocking our thread...
+    // Note #2: our files are fetched into this instance of our cache, which is
+    //          the one our caller retrieved from its own thread, since
+    //          retrieving our 'global' instance from a background thread is not
+    //          safe (see instance())...
+
+    if (fileNamesOrUrls.isEmpty()) {
+        return;
+    }
+
+    auto fetchFunction = [this](const QString &pFileNameOrUrl) {
+        fetch(pFileNameOrUrl);
+    };
+
+    if (fileNamesOrUrls.count() == 1) {
+        fetch(fileNamesOrUrls.first());
+    } else if (hasRemoteFiles) {
+        QFutureWatcher<void> futureWatcher;
+        QEventLoop waitLoop;
+
+        QObject::connect(&futureWatcher, &QFutureWatcher<void>::finished,
+                         &waitLoop, &QEventLoop::quit);
+
+        futureWatcher.setFuture(QtConcurrent::map(fileNamesOrUrls, fetchFunction));
+
+        waitLoop.exec();
+    } else {
+        QtConcurrent::blockingMap(fileNamesOrUrls, fetchFunction);
+    }
+}
+
+//==============================================================================
+
+void CellmlFileImportCache::remove(const QString &pFileNameOrUrl)
+{
+    // Remove the given file from our cache
+
+    QMutexLocker locker(&mMutex);
+
+    release(mStampsSha1.take(pFileNameOrUrl).second);
+}
+
+//==============================================================================
+
+qint64 CellmlFileImportCache::maxSize()
+{
+    // Return the maximum size of our cache
+
+    QMutexLocker locker(&mMutex);
+
+    return mMaxSize;
+}
+
+//==============================================================================
+
+void CellmlFileImportCache::setMaxSize(qint64 pMaxSize)
+{
+    // Set the maximum size of our cache, i.e. the amount of memory (in bytes)
+    // that the contents of our files may use, and trim our cache, if needed
+
+    QMutexLocker locker(&mMutex);
+
+    mMaxSize = pMaxSize;
+
+    trim(QString());
+}
+
+//==============================================================================
+
+void CellmlFileImportCache::fetch(const QString &pFileNameOrUrl)
+{
+    // Read the given file and keep track of its contents
+    // Note #1: this method may be executed in a background thread, hence we
+    //          only access our members through insert()...
+    // Note #2: the stamp of a local file is retrieved before reading it, so
+    //          that if the file gets modified while we are reading it then its
+    //          contents will be considered out of date...
+
+    bool isLocalFile;
+    QString fileNameOrUrl;
+
+    Core::checkFileNameOrUrl(pFileNameOrUrl, isLocalFile, fileNameOrUrl);
+
+    QString stamp = isLocalFile?Core::File::stamp(fileNameOrUrl):QString();
+    QString contents;
+
+    if (Core::readFile(fileNameOrUrl, contents)) {
+        insert(pFileNameOrUrl, stamp, contents);
+    }
+}
+
+//==============================================================================
+
+bool CellmlFileImportCache::isUpToDate(const QString &pFileNameOrUrl) const
+{
+    // Return whether we have an up-to-date version of the given file
+    // Note #1: a local file is up to date if its stamp hasn't changed while a
+    //          remote file is up to date until it gets removed from our
+    //          cache...
+    // Note #2: our mutex must be locked when calling this method...
+
+    if (!mStampsSha1.contains(pFileNameOrUrl)) {
+        return false;
+    }
+
+    bool isLocalFile;
+    QString fileNameOrUrl;
+
+    Core::checkFileNameOrUrl(pFileNameOrUrl, isLocalFile, fileNameOrUrl);
+
+    return    !isLocalFile
+           || (mStampsSha1.value(pFileNameOrUrl).first == Core::File::stamp(fileNameOrUrl));
+}
+
+//==============================================================================
+
+void CellmlFileImportCache::use(const QString &pSha1)
+{
+    // Keep track of the fact that the contents with the given SHA-1 value have
+    // just been used (see trim())
+    // Note: our mutex must be locked when calling this method...
+
+    mContentsLastUsed.insert(pSha1, ++mUsage);
+}
+
+//==============================================================================
+
+void CellmlFileImportCache::release(const QString &pSha1)
+{
+    // Release the contents with the given SHA-1 value, unless they are still
+    // used by another file
+    // Note: our mutex must be locked when calling this method...
+
+    if (pSha1.isEmpty()) {
+        return;
+    }
+
+    for (const auto &stampSha1 : qAsConst(mStampsSha1)) {
+        if (stampSha1.second == pSha1) {
+            return;
+        }
+    }
+
+    mSize -= 2*mContents.take(pSha1).size();
+
+    mContentsLastUsed.remove(pSha1);
+}
+
+//==============================================================================
+
+void CellmlFileImportCache::trim(const QString &pSha1)
+{
+    // Make sure that our contents don't use more than our maximum size by
+    // removing our least recently used contents, except the ones with the
+    // given SHA-1 value, along with the files that use them
+    // Note #1: we consider that a character uses two bytes, as is the case
+    //          for a QString...
+    // Note #2: a file that gets removed from our cache will simply have to be
+    //          fetched again, should it be needed...
+    // Note #3: our mutex must be locked when calling this method...
+
+    while (mSize > mMaxSize) {
+        QString leastRecentlyUsedSha1;
+        quint64 leastRecentUsage = std::numeric_limits<quint64>::max();
+
+        for (auto contentsLastUsed = mContentsLastUsed.constBegin(), contentsLastUsedEnd = mContentsLastUsed.constEnd();
+             contentsLastUsed != contentsLastUsedEnd; ++contentsLastUsed) {
+            if (   (contentsLastUsed.key() != pSha1)
+                && (contentsLastUsed.value() < leastRecentUsage)) {
+                leastRecentlyUsedSha1 = contentsLastUsed.key();
+                leastRecentUsage = contentsLastUsed.value();
+            }
+        }
+
+        if (leastRecentlyUsedSha1.isEmpty()) {
+            return;
+        }
+
+        for (auto stampSha1 = mStampsSha1.begin(); stampSha1 != mStampsSha1.end();) {
+            if (stampSha1.value().second == leastRecentlyUsedSha1) {
+                stampSha1 = mStampsSha1.erase(stampSha1);
+            } else {
+                ++stampSha1;
+            }
+        }
+
+        release(leastRecentlyUsedSha1);
+    }
+}
+
+//==============================================================================
+
+void CellmlFileImportCache::insert(const QString &pFileNameOrUrl,
+                                   const QString &pStamp,
+                                   const QString &pContents)
+{
+    // Keep track of the stamp and contents of the given file
+    // Note: contents are stored by SHA-1 value, so that files with the same
+    //       contents (e.g. a library that is available both locally and
+    //       remotely) share the same copy...
+
+    QString sha1 = Core::sha1(pContents);
+
+    QMutexLocker locker(&mMutex);
+
+    QString oldSha1 = mStampsSha1.value(pFileNameOrUrl).second;
+
+    mStampsSha1.insert(pFileNameOrUrl, QPair<QString, QString>(pStamp, sha1));
+
+    if (!mContents.contains(sha1)) {
+        mContents.insert(sha1, pContents);
+
+        mSize += 2*pContents.size();
+    }
+
+    use(sha1);
+
+    if (oldSha1 != sha1) {
+        release(oldSha1);
+    }
+
+    trim(sha1);
+}
+
+//==============================================================================
+
+} // namespace CellMLSupport
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
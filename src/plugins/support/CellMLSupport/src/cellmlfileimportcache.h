@@ -0,0 +1,90 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// CellML file import cache
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include "cellmlsupportglobal.h"
+
+//==============================================================================
+
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <QStringList>
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace CellMLSupport {
+
+//==============================================================================
+
+class CELLMLSUPPORT_EXPORT CellmlFileImportCache
+{
+public:
+    static CellmlFileImportCache * instance();
+
+    bool contains(const QString &pFileNameOrUrl);
+    bool contents(const QString &pFileNameOrUrl, QString &pContents);
+
+    void prefetch(const QStringList &pFileNamesOrUrls);
+
+    void remove(const QString &pFileNameOrUrl);
+
+    qint64 maxSize();
+    void setMaxSize(qint64 pMaxSize);
+
+private:
+    QMutex mMutex;
+
+    QMap<QString, QPair<QString, QString>> mStampsSha1;
+    QMap<QString, QString> mContents;
+    QMap<QString, quint64> mContentsLastUsed;
+
+    quint64 mUsage = 0;
+    qint64 mSize = 0;
+    qint64 mMaxSize;
+
+    CellmlFileImportCache();
+
+    void fetch(const QString &pFileNameOrUrl);
+
+    bool isUpToDate(const QString &pFileNameOrUrl) const;
+    void use(const QString &pSha1);
+    void release(const QString &pSha1);
+    void trim(const QString &pSha1);
+
+    void insert(const QString &pFileNameOrUrl, const QString &pStamp,
+                const QString &pContents);
+};
+
+//==============================================================================
+
+} // namespace CellMLSupport
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -37,6 +37,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 //==============================================================================
 
 #include <QRegularExpression>
+#include <QSet>
 #include <QStringList>
 
 //==============================================================================
@@ -47,13 +48,6 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
-#include "llvmclangbegin.h"
-    #include "llvm/ADT/StringRef.h"
-    #include "llvm/Support/DynamicLibrary.h"
-#include "llvmclangend.h"
-
-//==============================================================================
-
 namespace OpenCOR {
 namespace CellMLSupport {
 
@@ -250,7 +244,8 @@ QIcon CellmlFileRuntimeParameter::icon(Type pParameterType)
 
 //==============================================================================
 
-CellmlFileRuntime::CellmlFileRuntime(CellmlFile *pCellmlFile)
+CellmlFileRuntime::CellmlFileRuntime(CellmlFile *pCellmlFile) :
+    mNlaSolverContext(new Solver::NlaSolverContext())
 {
     update(pCellmlFile);
 }
@@ -265,6 +260,8 @@ CellmlFileRuntime::~CellmlFileRuntime()
         reset(false, true, true);
     } catch (...) {
     }
+
+    delete mNlaSolverContext;
 }
 
 //==============================================================================
@@ -503,7 +500,9 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
                       "    double *aALGEBRAIC;\n"
                       "};\n"
                       "\n"
-                      "extern void doNonLinearSolve(char *, void (*)(double *, double *, void*), double *, int, void *);\n"
+                      "extern struct NlaSolverContext nlaSolverContext;\n"
+                      "\n"
+                      "extern void doNonLinearSolve(struct NlaSolverContext *, int, void (*)(double *, double *, void*), double *, int, void *);\n"
                       "\n"
                      +functionsString
                      +"\n";
@@ -533,6 +532,8 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
         }
     }
 
+    QString ratesCode = cleanCode(mCodeInformation->ratesString());
+
     modelCode +=  methodCode("initializeConstants(double *CONSTANTS, double *RATES, double *STATES)",
                              initConsts)
                  +methodCode("computeComputedConstants(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC)",
@@ -540,7 +541,25 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
                  +methodCode("computeVariables(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC, double *CONDVAR)",
                              mCodeInformation->variablesString())
                  +methodCode("computeRates(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC)",
-                             mCodeInformation->ratesString());
+                             ratesCode);
+
+    // Generate a function that computes the roots of the conditions on which
+    // our rates depend, if any, i.e. functions that change sign whenever one of
+    // those conditions switches, so that an ODE solver that supports root
+    // finding can stop exactly at the discontinuities of our model rather than
+    // step over them
+    // Note: a condition may depend on algebraic variables that are computed by
+    //       our rates code, so our roots are computed after running the part
+    //       of our rates code on which they depend (see rootsCode())...
+
+    const QStringList roots = rootFunctions(ratesCode);
+
+    if (!roots.isEmpty()) {
+        mRootsCount = roots.count();
+
+        modelCode += methodCode("computeRoots(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC, double *ROOTS)",
+                                rootsCode(ratesCode, roots));
+    }
 
     // Check whether the model code contains a definite integral, otherwise
     // compute it and check that everything went fine
@@ -548,9 +567,24 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
     if (modelCode.contains("defint(func")) {
         mIssues << CellmlFileIssue(CellmlFileIssue::Type::Error,
                                    tr("definite integrals are not supported"));
-    } else if (!mCompilerEngine->compileCode(modelCode)) {
-        mIssues << CellmlFileIssue(CellmlFileIssue::Type::Error,
-                                   mCompilerEngine->error());
+    } else {
+        // Map the external symbols needed to solve our NLA systems, if any
+        // Note: our NLA solver context is mapped to a symbol rather than having
+        //       its address hard-coded in our model code, so that our model
+        //       code doesn't depend on where our runtime lives in memory, and
+        //       can therefore be cached...
+
+        if (mAtLeastOneNlaSystem) {
+            mCompilerEngine->addExternalSymbol("doNonLinearSolve",
+                                               reinterpret_cast<void *>(doNonLinearSolve));
+            mCompilerEngine->addExternalSymbol("nlaSolverContext",
+                                               mNlaSolverContext);
+        }
+
+        if (!mCompilerEngine->compileCode(modelCode)) {
+            mIssues << CellmlFileIssue(CellmlFileIssue::Type::Error,
+                                       mCompilerEngine->error());
+        }
     }
 
     // Keep track of the ODE functions, but only if no issues were reported
@@ -558,13 +592,6 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
     if (!mIssues.isEmpty()) {
         reset(true, false, true);
     } else {
-        // Add the symbol of any required external function, if any
-
-        if (mAtLeastOneNlaSystem) {
-            llvm::sys::DynamicLibrary::AddSymbol("doNonLinearSolve",
-                                                 reinterpret_cast<void *>(doNonLinearSolve));
-        }
-
         // Retrieve the ODE functions
 
         mInitializeConstants = reinterpret_cast<InitializeConstantsFunction>(mCompilerEngine->getFunction("initializeConstants"));
@@ -572,14 +599,47 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
         mComputeVariables = reinterpret_cast<ComputeVariablesFunction>(mCompilerEngine->getFunction("computeVariables"));
         mComputeRates = reinterpret_cast<ComputeRatesFunction>(mCompilerEngine->getFunction("computeRates"));
 
+        if (mRootsCount != 0) {
+            mComputeRoots = reinterpret_cast<ComputeRootsFunction>(mCompilerEngine->getFunction("computeRoots"));
+        }
+
         // Make sure that we managed to retrieve all the ODE functions
 
         if (   (mInitializeConstants == nullptr) || (mComputeComputedConstants == nullptr)
-            || (mComputeVariables == nullptr) || (mComputeRates == nullptr)) {
+            || (mComputeVariables == nullptr) || (mComputeRates == nullptr)
+            || ((mRootsCount != 0) && (mComputeRoots == nullptr))) {
             mIssues << CellmlFileIssue(CellmlFileIssue::Type::Error,
                                        tr("an unexpected problem occurred while trying to retrieve the model functions"));
 
             reset(true, false, true);
+        } else if (!mAtLeastOneNlaSystem) {
+            // Retrieve the states on which our rates depend
+
+            retrieveStatesDependencies();
+
+            // Generate, but don't compile (see computeRatesBatch()), a batched
+            // version of computeRates(), i.e. one that computes the rates of
+            // ComputeRatesBatchSize instances of our model at once, with the
+            // arrays of those instances being interleaved (i.e. the Nth value
+            // of the Ith instance is at index N*ComputeRatesBatchSize+I)
+            // Note #1: with such a layout, the compiler can vectorise our loop
+            //          over our instances, i.e. compute several instances at
+            //          once using SIMD instructions...
+            // Note #2: this cannot be done when NLA systems need solving since
+            //          their code expects only one instance of our model...
+
+            static const QRegularExpression ArrayElementRegEx = QRegularExpression(R"(\b(CONSTANTS|RATES|STATES|ALGEBRAIC)\[(\d+)\])");
+
+            QString ratesCode = cleanCode(mCodeInformation->ratesString());
+
+            ratesCode.replace(ArrayElementRegEx, QString(R"(\1[%1*\2+i])").arg(ComputeRatesBatchSize));
+            ratesCode.replace('\n', "\n        ");
+
+            mComputeRatesBatchCode = methodCode("computeRatesBatch(double VOI, double * restrict CONSTANTS, double * restrict RATES, double * restrict STATES, double * restrict ALGEBRAIC)",
+                                                QString("    for (int i = 0; i < %1; ++i) {\n"
+                                                        "        %2\n"
+                                                        "    }").arg(ComputeRatesBatchSize)
+                                                               .arg(ratesCode));
         }
     }
 }
@@ -604,6 +664,15 @@ bool CellmlFileRuntime::needNlaSolver() const
 
 //==============================================================================
 
+Solver::NlaSolverContext * CellmlFileRuntime::nlaSolverContext() const
+{
+    // Return our NLA solver context
+
+    return mNlaSolverContext;
+}
+
+//==============================================================================
+
 void CellmlFileRuntime::importData(const QString &pName,
                                    const QStringList &pComponentHierarchy,
                                    int pIndex, double *pData)
@@ -688,6 +757,66 @@ CellmlFileRuntime::ComputeRatesFunction CellmlFileRuntime::computeRates() const
 
 //==============================================================================
 
+CellmlFileRuntime::ComputeRatesFunction CellmlFileRuntime::computeRatesBatch()
+{
+    // Return the batched version of the computeRates function, after having
+    // compiled it, if needed and possible
+    // Note: the batched version of computeRates() is only useful when running
+    //       several instances of our model at once (see
+    //       SimulationSupport::SimulationEnsembleWorker), hence we only compile
+    //       it on demand...
+
+    if ((mComputeRatesBatch == nullptr) && !mComputeRatesBatchCode.isEmpty()) {
+        mBatchCompilerEngine = new Compiler::CompilerEngine();
+
+        if (mBatchCompilerEngine->compileCode(mComputeRatesBatchCode)) {
+            mComputeRatesBatch = reinterpret_cast<ComputeRatesFunction>(mBatchCompilerEngine->getFunction("computeRatesBatch"));
+        }
+
+        // Don't try again if something went wrong
+
+        if (mComputeRatesBatch == nullptr) {
+            delete mBatchCompilerEngine;
+
+            mBatchCompilerEngine = nullptr;
+
+            mComputeRatesBatchCode = QString();
+        }
+    }
+
+    return mComputeRatesBatch;
+}
+
+//==============================================================================
+
+int CellmlFileRuntime::rootsCount() const
+{
+    // Return the number of roots in the model
+
+    return mRootsCount;
+}
+
+//==============================================================================
+
+CellmlFileRuntime::ComputeRootsFunction CellmlFileRuntime::computeRoots() const
+{
+    // Return the computeRoots function, if any
+
+    return mComputeRoots;
+}
+
+//==============================================================================
+
+QVector<QVector<int>> CellmlFileRuntime::statesDependencies() const
+{
+    // Return the states on which each of our rates depends, i.e. the sparsity
+    // pattern of the Jacobian of our model, if known
+
+    return mStatesDependencies;
+}
+
+//==============================================================================
+
 CellmlFileIssues CellmlFileRuntime::issues() const
 {
     // Return the issue(s)
@@ -743,6 +872,8 @@ void CellmlFileRuntime::resetFunctions()
     mComputeComputedConstants = nullptr;
     mComputeVariables = nullptr;
     mComputeRates = nullptr;
+    mComputeRatesBatch = nullptr;
+    mComputeRoots = nullptr;
 }
 
 //==============================================================================
@@ -753,6 +884,8 @@ void CellmlFileRuntime::reset(bool pRecreateCompilerEngine, bool pResetIssues,
     // Reset all of the runtime's properties
 
     mAtLeastOneNlaSystem = false;
+    mNlaSystemsCount = 0;
+    mRootsCount = 0;
 
     resetCodeInformation();
 
@@ -764,6 +897,14 @@ void CellmlFileRuntime::reset(bool pRecreateCompilerEngine, bool pResetIssues,
         mCompilerEngine = nullptr;
     }
 
+    delete mBatchCompilerEngine;
+
+    mBatchCompilerEngine = nullptr;
+
+    mComputeRatesBatchCode = QString();
+
+    mStatesDependencies.clear();
+
     resetFunctions();
 
     if (pResetIssues) {
@@ -860,6 +1001,351 @@ void CellmlFileRuntime::retrieveCodeInformation(iface::cellml_api::Model *pModel
 
 //==============================================================================
 
+void CellmlFileRuntime::retrieveStatesDependencies()
+{
+    // Determine the states on which each of our rates depends
+    // Note #1: the code that computes our rates consists of statements that
+    //          compute either an algebraic variable or a rate, so we go through
+    //          them in order while keeping track of the states on which each
+    //          algebraic variable and rate depends...
+    // Note #2: an algebraic variable that is not computed by our rates code
+    //          doesn't depend on our states, as far as our rates code is
+    //          concerned...
+    // Note #3: if we come across a statement that we don't expect, then we
+    //          cannot be sure of our dependencies, so we don't provide any...
+
+    static const QRegularExpression StatementRegEx = QRegularExpression(R"(^(RATES|ALGEBRAIC)\[(\d+)\] = (.*)$)",
+                                                                        QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression VariableRegEx = QRegularExpression(R"(\b(STATES|RATES|ALGEBRAIC)\[(\d+)\])");
+    static const QString Rates = "RATES";
+    static const QString States = "STATES";
+
+    QVector<QSet<int>> ratesDependencies(mStatesRatesCount);
+    QMap<int, QSet<int>> algebraicDependencies;
+    const QStringList statements = cleanCode(mCodeInformation->ratesString()).split(';');
+
+    for (const auto &statement : statements) {
+        QString trimmedStatement = statement.trimmed();
+
+        if (trimmedStatement.isEmpty()) {
+            continue;
+        }
+
+        QRegularExpressionMatch statementMatch = StatementRegEx.match(trimmedStatement);
+
+        if (!statementMatch.hasMatch()) {
+            return;
+        }
+
+        QSet<int> dependencies;
+        QRegularExpressionMatchIterator variableMatchIterator = VariableRegEx.globalMatch(statementMatch.captured(3));
+
+        while (variableMatchIterator.hasNext()) {
+            QRegularExpressionMatch variableMatch = variableMatchIterator.next();
+            QString variableArray = variableMatch.captured(1);
+            int variableIndex = variableMatch.captured(2).toInt();
+
+            if (variableArray == States) {
+                dependencies << variableIndex;
+            } else if (variableArray == Rates) {
+                if (variableIndex >= mStatesRatesCount) {
+                    return;
+                }
+
+                dependencies += ratesDependencies[variableIndex];
+            } else {
+                dependencies += algebraicDependencies.value(variableIndex);
+            }
+        }
+
+        int index = statementMatch.captured(2).toInt();
+
+        if (statementMatch.captured(1) == Rates) {
+            if (index >= mStatesRatesCount) {
+                return;
+            }
+
+            ratesDependencies[index] = dependencies;
+        } else {
+            algebraicDependencies.insert(index, dependencies);
+        }
+    }
+
+    // Keep track of our dependencies as sorted lists of states
+
+    mStatesDependencies.resize(mStatesRatesCount);
+
+    for (int i = 0; i < mStatesRatesCount; ++i) {
+        QList<int> states = ratesDependencies[i].values();
+
+        std::sort(states.begin(), states.end());
+
+        mStatesDependencies[i] = states.toVector();
+    }
+}
+
+//==============================================================================
+
+QStringList CellmlFileRuntime::rootFunctions(const QString &pCode) const
+{
+    // Retrieve the root functions of the conditions used in the given code
+    // Note: the CellML API generates a piecewise equation as a series of
+    //       ternary operators, so we look for the condition of each of them,
+    //       i.e. whatever precedes a '?' up to an unmatched '(', an assignment,
+    //       or another operand of a ternary operator...
+
+    static const QString NonAssignmentPrefixes = "<>=!";
+
+    QStringList res;
+
+    for (int i = 0, iMax = pCode.size(); i < iMax; ++i) {
+        if (pCode[i] != '?') {
+            continue;
+        }
+
+        int depth = 0;
+        int from = i-1;
+
+        for (; from >= 0; --from) {
+            QChar character = pCode[from];
+
+            if (character == ')') {
+                ++depth;
+            } else if (character == '(') {
+                if (depth == 0) {
+                    break;
+                }
+
+                --depth;
+            } else if (   (depth == 0)
+                       && (   (character == '?') || (character == ':')
+                           || (character == ';') || (character == ',')
+                           || (   (character == '=')
+                               && (from > 0) && !NonAssignmentPrefixes.contains(pCode[from-1])
+                               && (from+1 < iMax) && (pCode[from+1] != '=')))) {
+                break;
+            }
+        }
+
+        addRootFunctions(pCode.mid(from+1, i-from-1), res);
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+QString CellmlFileRuntime::rootsCode(const QString &pRatesCode,
+                                     const QStringList &pRootFunctions) const
+{
+    // Generate the code that computes the given root functions, preceded by
+    // the statements of the given rates code on which they depend, directly or
+    // indirectly
+    // Note #1: our roots get computed each time that an ODE solver checks for
+    //          a root, so we don't want to also compute all our rates (and
+    //          solve all our NLA systems) if we don't need to...
+    // Note #2: like in retrieveStatesDependencies(), we expect our rates code
+    //          to consist of statements that compute either an algebraic
+    //          variable or a rate. If we come across a statement that we don't
+    //          expect (e.g. one that solves an NLA system), then we cannot be
+    //          sure of our dependencies, so we use all of our rates code...
+
+    static const QRegularExpression StatementRegEx = QRegularExpression(R"(^(RATES|ALGEBRAIC)\[(\d+)\] = (.*)$)",
+                                                                        QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression VariableRegEx = QRegularExpression(R"(\b(RATES|ALGEBRAIC)\[(\d+)\])");
+
+    QString res;
+
+    for (int i = 0, iMax = pRootFunctions.count(); i < iMax; ++i) {
+        res += QString("\nROOTS[%1] = %2;").arg(QString::number(i), pRootFunctions[i]);
+    }
+
+    // Retrieve the variables on which our root functions depend
+
+    QSet<QString> neededVariables;
+    QRegularExpressionMatchIterator variableMatchIterator = VariableRegEx.globalMatch(res);
+
+    while (variableMatchIterator.hasNext()) {
+        neededVariables << variableMatchIterator.next().captured(0);
+    }
+
+    // Go backward through the statements of our rates code and keep those that
+    // compute a variable that we need, along with the variables on which it
+    // depends
+
+    const QStringList ratesStatements = pRatesCode.split(';');
+    QStringList statements;
+
+    for (const auto &statement : ratesStatements) {
+        QString trimmedStatement = statement.trimmed();
+
+        if (!trimmedStatement.isEmpty()) {
+            statements << trimmedStatement;
+        }
+    }
+
+    QStringList neededStatements;
+
+    for (int i = statements.count()-1; i >= 0; --i) {
+        QRegularExpressionMatch statementMatch = StatementRegEx.match(statements[i]);
+
+        if (!statementMatch.hasMatch()) {
+            return pRatesCode+res;
+        }
+
+        if (!neededVariables.contains(QString("%1[%2]").arg(statementMatch.captured(1),
+                                                            statementMatch.captured(2)))) {
+            continue;
+        }
+
+        neededStatements.prepend(statements[i]+";");
+
+        variableMatchIterator = VariableRegEx.globalMatch(statementMatch.captured(3));
+
+        while (variableMatchIterator.hasNext()) {
+            neededVariables << variableMatchIterator.next().captured(0);
+        }
+    }
+
+    return neededStatements.join('\n')+res;
+}
+
+//==============================================================================
+
+void CellmlFileRuntime::addRootFunctions(const QString &pCondition,
+                                         QStringList &pRootFunctions) const
+{
+    // Strip the given condition of any negation and of any enclosing
+    // parentheses
+
+    QString condition = pCondition.trimmed();
+
+    forever {
+        if (condition.startsWith('!')) {
+            condition = condition.mid(1).trimmed();
+        } else if (condition.startsWith('(') && condition.endsWith(')')) {
+            int depth = 0;
+            int i = 0;
+
+            for (int iMax = condition.size(); i < iMax; ++i) {
+                if (condition[i] == '(') {
+                    ++depth;
+                } else if ((condition[i] == ')') && (--depth == 0)) {
+                    break;
+                }
+            }
+
+            if (i != condition.size()-1) {
+                break;
+            }
+
+            condition = condition.mid(1, condition.size()-2).trimmed();
+        } else {
+            break;
+        }
+    }
+
+    // Split our condition into its operands, should it be a logical
+    // conjunction or disjunction, and retrieve their root functions, or look
+    // for a relational operator, whose operands we can subtract to get a root
+    // function
+
+    static const QStringList LogicalOperators = { "&&", "||" };
+    static const QStringList RelationalOperators = { "<=", ">=", "==", "!=", "<", ">" };
+
+    int depth = 0;
+    int from = 0;
+    int relationalOperatorPosition = -1;
+    QString relationalOperator;
+    bool logicalOperator = false;
+
+    for (int i = 0, iMax = condition.size(); i < iMax; ++i) {
+        if (condition[i] == '(') {
+            ++depth;
+        } else if (condition[i] == ')') {
+            --depth;
+        } else if (depth == 0) {
+            QString twoCharacters = condition.mid(i, 2);
+
+            if (LogicalOperators.contains(twoCharacters)) {
+                addRootFunctions(condition.mid(from, i-from), pRootFunctions);
+
+                logicalOperator = true;
+                from = i+2;
+
+                ++i;
+            } else if (relationalOperatorPosition == -1) {
+                for (const auto &op : RelationalOperators) {
+                    if (condition.midRef(i, op.size()) == op) {
+                        relationalOperatorPosition = i;
+                        relationalOperator = op;
+
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    if (logicalOperator) {
+        addRootFunctions(condition.mid(from), pRootFunctions);
+
+        return;
+    }
+
+    // Our condition is a relational operation, so its root function is the
+    // difference between its two operands, unless it doesn't depend on
+    // anything that changes during a simulation
+    // Note: we also want to know when the argument of a floor() or ceil() call
+    //       crosses an integer value (e.g. when a periodic stimulus starts a
+    //       new period), so we use sin(pi*argument) as an additional root
+    //       function...
+
+    static const QRegularExpression VariableRegEx = QRegularExpression(R"(\b(VOI|STATES|RATES|ALGEBRAIC)\b)");
+    static const QRegularExpression StepFunctionRegEx = QRegularExpression(R"(\b(floor|ceil)\()");
+
+    if (   (relationalOperatorPosition == -1)
+        || !VariableRegEx.match(condition).hasMatch()) {
+        return;
+    }
+
+    QString rootFunction = QString("(%1)-(%2)").arg(condition.left(relationalOperatorPosition).trimmed(),
+                                                    condition.mid(relationalOperatorPosition+relationalOperator.size()).trimmed());
+
+    if (!pRootFunctions.contains(rootFunction)) {
+        pRootFunctions << rootFunction;
+    }
+
+    QRegularExpressionMatchIterator stepFunctionMatchIterator = StepFunctionRegEx.globalMatch(condition);
+
+    while (stepFunctionMatchIterator.hasNext()) {
+        QRegularExpressionMatch stepFunctionMatch = stepFunctionMatchIterator.next();
+        int argumentFrom = stepFunctionMatch.capturedEnd();
+        int argumentTo = argumentFrom;
+
+        for (int argumentDepth = 1, iMax = condition.size();
+             argumentTo < iMax; ++argumentTo) {
+            if (condition[argumentTo] == '(') {
+                ++argumentDepth;
+            } else if ((condition[argumentTo] == ')') && (--argumentDepth == 0)) {
+                break;
+            }
+        }
+
+        QString argument = condition.mid(argumentFrom, argumentTo-argumentFrom);
+
+        if (VariableRegEx.match(argument).hasMatch()) {
+            rootFunction = QString("sin(3.14159265358979323846*(%1))").arg(argument);
+
+            if (!pRootFunctions.contains(rootFunction)) {
+                pRootFunctions << rootFunction;
+            }
+        }
+    }
+}
+
+//==============================================================================
+
 QString CellmlFileRuntime::methodCode(const QString &pCodeSignature,
                                       const QString &pCodeBody)
 {
@@ -955,11 +1441,22 @@ QString CellmlFileRuntime::cleanCode(const std::wstring &pCode)
 
     // Also rename do_nonlinearsolve() to doNonLinearSolve() since CellML's CIS
     // service already defines do_nonlinearsolve() and, yet, we want to use our
-    // own non-linear solve routine defined in our Solver interface, and add a
-    // new parameter to all our calls to doNonLinearSolve() so that
-    // doNonLinearSolve() can retrieve the correct instance of our NLA solver
+    // own non-linear solve routine defined in our Solver interface, and add two
+    // new parameters to all our calls to doNonLinearSolve(): our NLA solver
+    // context, so that doNonLinearSolve() can directly retrieve the correct
+    // instance of our NLA solver, and the number of the NLA system, so that our
+    // NLA solver can directly retrieve the data it keeps for that NLA system
+
+    static const QString DoNonLinearSolve = "do_nonlinearsolve(";
 
-    res.replace("do_nonlinearsolve(", QString(R"(doNonLinearSolve("%1", )").arg(Solver::objectAddress(this)));
+    for (int from = res.indexOf(DoNonLinearSolve); from != -1;
+         from = res.indexOf(DoNonLinearSolve, from)) {
+        QString call = QString("doNonLinearSolve(&nlaSolverContext, %1, ").arg(mNlaSystemsCount++);
+
+        res.replace(from, DoNonLinearSolve.size(), call);
+
+        from += call.size();
+    }
 
     return res;
 }
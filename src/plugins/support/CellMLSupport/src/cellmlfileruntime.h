@@ -33,9 +33,9 @@ along with this program. If not, see <https://gnu.org/licenses>.
 #include <QIcon>
 #include <QList>
 #include <QMap>
+#include <QVector>
 #ifdef Q_OS_WIN
     #include <QSet>
-    #include <QVector>
 #endif
 
 //==============================================================================
@@ -59,6 +59,12 @@ namespace Compiler {
 
 //==============================================================================
 
+namespace Solver {
+    class NlaSolverContext;
+} // namespace Solver
+
+//==============================================================================
+
 namespace CellMLSupport {
 
 //==============================================================================
@@ -67,6 +73,10 @@ class CellmlFile;
 
 //==============================================================================
 
+static const int ComputeRatesBatchSize = 8;
+
+//==============================================================================
+
 class CELLMLSUPPORT_EXPORT CellmlFileRuntimeParameter
 {
 public:
@@ -134,6 +144,7 @@ public:
     using ComputeComputedConstantsFunction = void (*)(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC);
     using ComputeVariablesFunction = void (*)(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC);
     using ComputeRatesFunction = void (*)(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC);
+    using ComputeRootsFunction = void (*)(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC, double *ROOTS);
 
     explicit CellmlFileRuntime(CellmlFile *pCellmlFile);
     ~CellmlFileRuntime() override;
@@ -143,6 +154,7 @@ public:
     bool isValid() const;
 
     bool needNlaSolver() const;
+    Solver::NlaSolverContext * nlaSolverContext() const;
 
     void importData(const QString &pName,
                     const QStringList &pComponentHierarchy, int pIndex,
@@ -158,6 +170,13 @@ public:
     ComputeVariablesFunction computeVariables() const;
     ComputeRatesFunction computeRates() const;
 
+    ComputeRatesFunction computeRatesBatch();
+
+    int rootsCount() const;
+    ComputeRootsFunction computeRoots() const;
+
+    QVector<QVector<int>> statesDependencies() const;
+
     CellmlFileIssues issues() const;
 
     CellmlFileRuntimeParameters parameters() const;
@@ -167,14 +186,21 @@ public:
 
 private:
     bool mAtLeastOneNlaSystem = false;
+    int mNlaSystemsCount = 0;
+
+    Solver::NlaSolverContext *mNlaSolverContext;
 
     ObjRef<iface::cellml_services::CodeInformation> mCodeInformation = nullptr;
 
     int mConstantsCount = 0;
     int mStatesRatesCount = 0;
     int mAlgebraicCount = 0;
+    int mRootsCount = 0;
 
     Compiler::CompilerEngine *mCompilerEngine = nullptr;
+    Compiler::CompilerEngine *mBatchCompilerEngine = nullptr;
+
+    QString mComputeRatesBatchCode;
 
     CellmlFileIssues mIssues;
 
@@ -185,6 +211,10 @@ private:
     ComputeComputedConstantsFunction mComputeComputedConstants = nullptr;
     ComputeVariablesFunction mComputeVariables = nullptr;
     ComputeRatesFunction mComputeRates = nullptr;
+    ComputeRatesFunction mComputeRatesBatch = nullptr;
+    ComputeRootsFunction mComputeRoots = nullptr;
+
+    QVector<QVector<int>> mStatesDependencies;
 
     void resetCodeInformation();
 
@@ -199,6 +229,14 @@ private:
 
     void retrieveCodeInformation(iface::cellml_api::Model *pModel);
 
+    void retrieveStatesDependencies();
+
+    QStringList rootFunctions(const QString &pCode) const;
+    QString rootsCode(const QString &pRatesCode,
+                      const QStringList &pRootFunctions) const;
+    void addRootFunctions(const QString &pCondition,
+                          QStringList &pRootFunctions) const;
+
     QString cleanCode(const std::wstring &pCode);
     QString methodCode(const QString &pCodeSignature, const QString &pCodeBody);
     QString methodCode(const QString &pCodeSignature,
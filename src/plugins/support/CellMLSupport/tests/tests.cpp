@@ -26,6 +26,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 //==============================================================================
 
 #include "cellmlfile.h"
+#include "cellmlfileimportcache.h"
 #include "corecliutils.h"
 #include "tests.h"
 
@@ -134,6 +135,190 @@ void Tests::runtimeTests()
 
 //==============================================================================
 
+void Tests::rootsTests()
+{
+    // Make sure that a model without any piecewise equation doesn't have any
+    // roots
+
+    OpenCOR::CellMLSupport::CellmlFile nobleCellmlFile(OpenCOR::fileName("models/noble_model_1962.cellml"));
+    OpenCOR::CellMLSupport::CellmlFileRuntime *nobleRuntime = nobleCellmlFile.runtime();
+
+    QVERIFY(nobleRuntime->isValid());
+    QCOMPARE(nobleRuntime->rootsCount(), 0);
+    QVERIFY(nobleRuntime->computeRoots() == nullptr);
+
+    // Make sure that the stimulus of the Hodgkin-Huxley model, which is active
+    // for 10 <= time <= 10.5, results in two roots, which change sign at the
+    // beginning and at the end of the stimulus, respectively
+
+    OpenCOR::CellMLSupport::CellmlFile hhCellmlFile(OpenCOR::fileName("models/hodgkin_huxley_squid_axon_model_1952.cellml"));
+    OpenCOR::CellMLSupport::CellmlFileRuntime *hhRuntime = hhCellmlFile.runtime();
+
+    QVERIFY(hhRuntime->isValid());
+    QCOMPARE(hhRuntime->rootsCount(), 2);
+    QVERIFY(hhRuntime->computeRoots() != nullptr);
+
+    int constantsCount = hhRuntime->constantsCount();
+    int ratesCount = hhRuntime->ratesCount();
+    int statesCount = hhRuntime->statesCount();
+    int algebraicCount = hhRuntime->algebraicCount();
+    QVector<double> constants(constantsCount);
+    QVector<double> rates(ratesCount);
+    QVector<double> states(statesCount);
+    QVector<double> algebraic(algebraicCount);
+    double beforeRoots[2];
+    double duringRoots[2];
+    double afterRoots[2];
+
+    hhRuntime->initializeConstants()(constants.data(), rates.data(), states.data());
+    hhRuntime->computeComputedConstants()(0.0, constants.data(), rates.data(), states.data(), algebraic.data());
+
+    hhRuntime->computeRoots()(5.0, constants.data(), rates.data(), states.data(), algebraic.data(), beforeRoots);
+    hhRuntime->computeRoots()(10.25, constants.data(), rates.data(), states.data(), algebraic.data(), duringRoots);
+    hhRuntime->computeRoots()(15.0, constants.data(), rates.data(), states.data(), algebraic.data(), afterRoots);
+
+    QVERIFY(beforeRoots[0]*duringRoots[0] < 0.0);
+    QVERIFY(beforeRoots[1]*duringRoots[1] > 0.0);
+    QVERIFY(duringRoots[0]*afterRoots[0] > 0.0);
+    QVERIFY(duringRoots[1]*afterRoots[1] < 0.0);
+}
+
+//==============================================================================
+
+void Tests::statesDependenciesTests()
+{
+    // Make sure that we get the right states dependencies for a model where:
+    //  - dx/dt = a with a = k*y, i.e. a rate that depends on a state through
+    //    an algebraic variable;
+    //  - dy/dt = -x, i.e. a rate that directly depends on a state;
+    //  - dz/dt = k, i.e. a rate that doesn't depend on any state; and
+    //  - dw/dt = b-w with b = a*z, i.e. a rate that depends on a state both
+    //    directly and through a chain of algebraic variables.
+
+    OpenCOR::CellMLSupport::CellmlFile cellmlFile(OpenCOR::fileName("src/plugins/support/CellMLSupport/tests/data/states_dependencies.cellml"));
+    OpenCOR::CellMLSupport::CellmlFileRuntime *runtime = cellmlFile.runtime();
+
+    QVERIFY(runtime->isValid());
+    QCOMPARE(runtime->statesCount(), 4);
+
+    const OpenCOR::CellMLSupport::CellmlFileRuntimeParameters parameters = runtime->parameters();
+    QMap<QString, int> statesIndexes;
+
+    for (auto parameter : parameters) {
+        if (parameter->type() == OpenCOR::CellMLSupport::CellmlFileRuntimeParameter::Type::State) {
+            statesIndexes.insert(parameter->name(), parameter->index());
+        }
+    }
+
+    QCOMPARE(statesIndexes.count(), 4);
+
+    int x = statesIndexes.value("x");
+    int y = statesIndexes.value("y");
+    int z = statesIndexes.value("z");
+    int w = statesIndexes.value("w");
+    QVector<QVector<int>> statesDependencies = runtime->statesDependencies();
+    QVector<int> wDependencies = QVector<int>() << y << z << w;
+
+    std::sort(wDependencies.begin(), wDependencies.end());
+
+    QCOMPARE(statesDependencies.count(), 4);
+    QCOMPARE(statesDependencies[x], QVector<int>() << y);
+    QCOMPARE(statesDependencies[y], QVector<int>() << x);
+    QCOMPARE(statesDependencies[z], QVector<int>());
+    QCOMPARE(statesDependencies[w], wDependencies);
+}
+
+//==============================================================================
+
+void Tests::importCacheTests()
+{
+    // Prefetch a couple of local files, one of them twice, and make sure that
+    // our import cache has their contents
+
+    OpenCOR::CellMLSupport::CellmlFileImportCache *importCacheInstance = OpenCOR::CellMLSupport::CellmlFileImportCache::instance();
+    QString childFileName = OpenCOR::fileName("src/plugins/support/CellMLSupport/tests/data/units_import_only_child_model.cellml");
+    QString fileName = OpenCOR::Core::temporaryFileName();
+    QString contents;
+
+    QVERIFY(OpenCOR::Core::writeFile(fileName, QByteArray("<model/>")));
+
+    importCacheInstance->prefetch({ childFileName, fileName, childFileName });
+
+    QVERIFY(importCacheInstance->contents(childFileName, contents));
+    QCOMPARE(contents, QString(OpenCOR::rawFileContents(childFileName)));
+    QVERIFY(importCacheInstance->contents(fileName, contents));
+    QCOMPARE(contents, QString("<model/>"));
+
+    // Modify one of our files and make sure that our import cache doesn't
+    // consider it up to date anymore, until it gets fetched again
+
+    QVERIFY(OpenCOR::Core::writeFile(fileName, QByteArray("<model name=\"modified\"/>")));
+
+    QVERIFY(!importCacheInstance->contains(fileName));
+    QVERIFY(!importCacheInstance->contents(fileName, contents));
+
+    importCacheInstance->prefetch({ fileName });
+
+    QVERIFY(importCacheInstance->contents(fileName, contents));
+    QCOMPARE(contents, QString("<model name=\"modified\"/>"));
+
+    // Remove our files from our import cache and make sure that it doesn't
+    // know about them anymore
+
+    importCacheInstance->remove(childFileName);
+    importCacheInstance->remove(fileName);
+
+    QVERIFY(!importCacheInstance->contains(childFileName));
+    QVERIFY(!importCacheInstance->contains(fileName));
+
+    // Make our import cache only big enough for our child file and make sure
+    // that it gets evicted once it is not the most recently used file anymore
+
+    qint64 maxSize = importCacheInstance->maxSize();
+    qint64 childFileSize = 2*QString(OpenCOR::rawFileContents(childFileName)).size();
+
+    importCacheInstance->setMaxSize(childFileSize);
+    importCacheInstance->prefetch({ childFileName });
+
+    QVERIFY(importCacheInstance->contains(childFileName));
+
+    importCacheInstance->prefetch({ fileName });
+
+    QVERIFY(!importCacheInstance->contains(childFileName));
+    QVERIFY(importCacheInstance->contains(fileName));
+
+    // Shrink our import cache so that nothing fits in it anymore and make sure
+    // that a file being added is still kept, even if it is bigger than our
+    // import cache
+
+    importCacheInstance->setMaxSize(1);
+
+    QVERIFY(!importCacheInstance->contains(fileName));
+
+    importCacheInstance->prefetch({ childFileName });
+
+    QVERIFY(importCacheInstance->contains(childFileName));
+
+    importCacheInstance->setMaxSize(maxSize);
+    importCacheInstance->remove(childFileName);
+
+    // Make sure that a model that imports some units can be loaded twice, the
+    // second time with its import coming from our import cache
+
+    QStringList modelParameters = OpenCOR::fileContents(OpenCOR::fileName("src/plugins/support/CellMLSupport/tests/data/noble_model_1962.out"));
+
+    runtimeTest(OpenCOR::fileName("src/plugins/support/CellMLSupport/tests/data/units_import_only_parent_model.cellml"),
+                "1.1", modelParameters);
+    runtimeTest(OpenCOR::fileName("src/plugins/support/CellMLSupport/tests/data/units_import_only_parent_model.cellml"),
+                "1.1", modelParameters);
+
+    // Clean up after ourselves
+
+    QFile::remove(fileName);
+}
+
+//==============================================================================
+
 QTEST_GUILESS_MAIN(Tests)
 
 //==============================================================================
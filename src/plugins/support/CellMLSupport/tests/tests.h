@@ -39,6 +39,9 @@ private:
 
 private slots:
     void runtimeTests();
+    void rootsTests();
+    void statesDependenciesTests();
+    void importCacheTests();
 };
 
 //==============================================================================
@@ -0,0 +1,120 @@
+import opencor as oc
+import os
+import sys
+
+sys.dont_write_bytecode = True
+
+import utils
+
+
+def run_single(simulation, constants, states):
+    # Run the simulation using the given constants and states, and return the
+    # values of its state
+
+    simulation.reset()
+    simulation.clear_results()
+
+    data = simulation.data()
+
+    for uri, value in constants.items():
+        data.constants()[uri] = value
+
+    for uri, value in states.items():
+        data.states()[uri] = value
+
+    simulation.run()
+
+    return list(simulation.results().states()['main/x'].values())
+
+
+def check_member(title, ensemble_values, single_values):
+    # Check that the values of an ensemble member match those of the equivalent
+    # single run
+
+    max_error = max(abs(ensemble_values[i] - single_values[i]) for i in range(len(single_values)))
+
+    print(' - %s: %s' % (title, 'OK' if ((len(ensemble_values) == len(single_values)) and (max_error < 1.0e-9))
+                                  else 'KO (maximum error: %e)' % max_error))
+
+
+def test_ensemble(simulation, solver_name):
+    # Run an ensemble that overrides a constant on which the initial value of
+    # our state depends, a constant used by our rates and our state, and check
+    # each member against an equivalent single run
+
+    utils.header('Ensemble tests (%s)' % solver_name, solver_name == 'CVODE')
+
+    data = simulation.data()
+
+    data.set_ode_solver(solver_name)
+
+    if solver_name != 'CVODE':
+        data.set_ode_solver_property('Step', 0.01)
+
+    simulation.reset()
+    simulation.clear_results()
+    simulation.run_ensemble([{'main/x0': 3.0},
+                             {'main/k': 1.0},
+                             {'main/x': 5.0}])
+
+    x = simulation.results().states()['main/x']
+    ensemble_values = [list(x.values(run)) for run in range(3)]
+
+    check_member('Constant defining an initial state (main/x0)', ensemble_values[0],
+                 run_single(simulation, {'main/x0': 3.0}, {'main/x': 3.0}))
+    check_member('Constant (main/k)', ensemble_values[1],
+                 run_single(simulation, {'main/k': 1.0}, {}))
+    check_member('State (main/x)', ensemble_values[2],
+                 run_single(simulation, {}, {'main/x': 5.0}))
+
+
+def test_batched_ensemble(simulation, solver_name):
+    # Run an ensemble that is big enough to need two batches, the second of
+    # which is padded, and check that each member of the (batched) ensemble
+    # matches both an equivalent single run and the same member run on its own
+    # as a (scalar) ensemble
+
+    utils.header('Batched ensemble tests (%s)' % solver_name, False)
+
+    data = simulation.data()
+
+    data.set_ode_solver(solver_name)
+    data.set_ode_solver_property('Step', 0.01)
+
+    members = [{'main/k': 0.1 * (i + 1), 'main/x': 1.0 + i} for i in range(11)]
+
+    simulation.reset()
+    simulation.clear_results()
+    simulation.run_ensemble(members)
+
+    x = simulation.results().states()['main/x']
+    batched_values = [list(x.values(run)) for run in range(len(members))]
+
+    for i, member in enumerate(members):
+        simulation.reset()
+        simulation.clear_results()
+        simulation.run_ensemble([member])
+
+        scalar_values = list(simulation.results().states()['main/x'].values(0))
+
+        check_member('Member #%d (ensemble)' % (i + 1), batched_values[i], scalar_values)
+        check_member('Member #%d (single run)' % (i + 1), batched_values[i],
+                     run_single(simulation, {'main/k': member['main/k']}, {'main/x': member['main/x']}))
+
+
+if __name__ == '__main__':
+    # Test ensembles using both a variable-step and a fixed-step ODE solver, as
+    # well as batched ensembles using fixed-step ODE solvers
+
+    simulation = oc.open_simulation(os.path.dirname(os.path.abspath(__file__)) + '/exponential_decay.cellml')
+    data = simulation.data()
+
+    data.set_ending_point(5.0)
+    data.set_point_interval(0.1)
+
+    test_ensemble(simulation, 'CVODE')
+    test_ensemble(simulation, 'Euler (forward)')
+    test_batched_ensemble(simulation, 'Euler (forward)')
+    test_batched_ensemble(simulation, 'Runge-Kutta (4th order)')
+
+    oc.close_simulation(simulation)
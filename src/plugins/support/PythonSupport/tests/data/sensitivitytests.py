@@ -0,0 +1,49 @@
+import math
+import opencor as oc
+import os
+import sys
+
+sys.dont_write_bytecode = True
+
+import utils
+
+
+def check_sensitivity(results, uri, expected_value):
+    # Check that the given sensitivity matches its expected value at each point
+
+    points = results.voi().values()
+    sensitivity = results.sensitivities()[uri].values()
+    max_error = max(abs(sensitivity[i] - expected_value(points[i])) for i in range(len(points)))
+
+    print(' - %s: %s' % (uri, 'OK' if max_error < 1.0e-4 else 'KO (maximum error: %e)' % max_error))
+
+
+if __name__ == '__main__':
+    # Test the sensitivities of a model for which they are known analytically,
+    # i.e. dx/dt = -k*x with x(0) = x0, which means that x(t) = x0*exp(-k*t),
+    # d(x)/d(k) = -t*x0*exp(-k*t) and d(x)/d(x0) = exp(-k*t)
+    # Note: d(x)/d(x0) is not zero at t = 0, so it also tests the seeding of
+    #       our sensitivities...
+
+    utils.header('Sensitivity tests')
+
+    simulation = oc.open_simulation(os.path.dirname(os.path.abspath(__file__)) + '/exponential_decay.cellml')
+    data = simulation.data()
+
+    data.set_ending_point(5.0)
+    data.set_point_interval(0.1)
+    data.set_ode_solver('CVODE')
+    data.set_ode_solver_property('RelativeTolerance', 1.0e-9)
+    data.set_ode_solver_property('AbsoluteTolerance', 1.0e-9)
+    data.set_sensitivity_parameters(['main/k', 'main/x0'])
+
+    simulation.run()
+
+    results = simulation.results()
+    k = 0.5
+    x0 = 2.0
+
+    check_sensitivity(results, 'd(main/x)/d(main/k)', lambda t: -t * x0 * math.exp(-k * t))
+    check_sensitivity(results, 'd(main/x)/d(main/x0)', lambda t: math.exp(-k * t))
+
+    oc.close_simulation(simulation)
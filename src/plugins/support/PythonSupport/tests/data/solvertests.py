@@ -0,0 +1,55 @@
+import math
+import opencor as oc
+import os
+import sys
+
+sys.dont_write_bytecode = True
+
+import utils
+
+
+def test_solver(simulation, tolerance, interpolate_solution):
+    # Run our simulation using the given tolerance and check that the maximum
+    # error of our state, compared to its analytical solution, i.e.
+    # x(t) = x0*exp(-k*t), is within a small multiple of our tolerance
+
+    data = simulation.data()
+
+    data.set_ode_solver('Dormand-Prince')
+    data.set_ode_solver_property('RelativeTolerance', tolerance)
+    data.set_ode_solver_property('AbsoluteTolerance', tolerance)
+    data.set_ode_solver_property('InterpolateSolution', interpolate_solution)
+
+    simulation.reset()
+    simulation.clear_results()
+    simulation.run()
+
+    results = simulation.results()
+    points = results.voi().values()
+    x = results.states()['main/x'].values()
+    max_error = max(abs(x[i] - 2.0 * math.exp(-0.5 * points[i])) for i in range(len(points)))
+
+    print(' - Tolerance: %g, interpolate solution: %s: %s'
+          % (tolerance, 'yes' if interpolate_solution else 'no',
+             'OK' if ((len(points) == 501) and (max_error < 10.0 * tolerance))
+             else 'KO (maximum error: %e)' % max_error))
+
+
+if __name__ == '__main__':
+    # Test the Dormand-Prince solver against an analytical solution, using a
+    # point interval that is much smaller than the steps it takes, so that most
+    # of our points are computed using its dense output
+
+    utils.header('Dormand-Prince solver tests')
+
+    simulation = oc.open_simulation(os.path.dirname(os.path.abspath(__file__)) + '/exponential_decay.cellml')
+    data = simulation.data()
+
+    data.set_ending_point(5.0)
+    data.set_point_interval(0.01)
+
+    for tolerance in [1.0e-6, 1.0e-9]:
+        for interpolate_solution in [True, False]:
+            test_solver(simulation, tolerance, interpolate_solution)
+
+    oc.close_simulation(simulation)
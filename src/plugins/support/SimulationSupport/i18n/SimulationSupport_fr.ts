@@ -34,6 +34,49 @@
         <source>The memory required for the simulation could not be allocated.</source>
         <translation>La mémoire requise pour la simulation n&apos;a pas pu être allouée.</translation>
     </message>
+    <message>
+        <source>The ensemble values must be a list of dictionaries.</source>
+        <translation>Les valeurs de l&apos;ensemble doivent être une liste de dictionnaires.</translation>
+    </message>
+    <message>
+        <source>The simulation is already running.</source>
+        <translation>La simulation est déjà en cours d&apos;exécution.</translation>
+    </message>
+    <message>
+        <source>The ensemble values must contain at least one dictionary.</source>
+        <translation>Les valeurs de l&apos;ensemble doivent contenir au moins un dictionnaire.</translation>
+    </message>
+    <message>
+        <source>The ensemble values must map the URI of a constant or state to a number.</source>
+        <translation>Les valeurs de l&apos;ensemble doivent associer l&apos;URI d&apos;une constante ou d&apos;un état à un nombre.</translation>
+    </message>
+    <message>
+        <source>&apos;%1&apos; is not the URI of a constant or state.</source>
+        <translation>&apos;%1&apos; n&apos;est pas l&apos;URI d&apos;une constante ou d&apos;un état.</translation>
+    </message>
+    <message>
+        <source>The simulation could not be run (%1).</source>
+        <translation>La simulation n&apos;a pas pu être exécutée (%1).</translation>
+    </message>
+    <message>
+        <source>&apos;%1&apos; is not a valid variable.</source>
+        <translation>&apos;%1&apos; n&apos;est pas une variable valide.</translation>
+    </message>
+    <message>
+        <source>&apos;%1&apos; is not a valid constant.</source>
+        <translation>&apos;%1&apos; n&apos;est pas une constante valide.</translation>
+    </message>
+    <message>
+        <source>The sensitivity parameters cannot be set while the simulation is running.</source>
+        <translation>Les paramètres de sensibilité ne peuvent pas être définis pendant que la simulation est en cours d&apos;exécution.</translation>
+    </message>
+</context>
+<context>
+    <name>OpenCOR::SimulationSupport::SimulationWorker</name>
+    <message>
+        <source>the ODE solver does not support sensitivity analysis</source>
+        <translation>le solveur EDO ne supporte pas l&apos;analyse de sensibilité</translation>
+    </message>
 </context>
 <context>
     <name>QObject</name>
@@ -28,10 +28,12 @@ along with this program. If not, see <https://gnu.org/licenses>.
 #include "interfaces.h"
 #include "sedmlfilemanager.h"
 #include "simulation.h"
+#include "simulationensembleworker.h"
 #include "simulationworker.h"
 
 //==============================================================================
 
+#include <QSet>
 #include <QThread>
 
 //==============================================================================
@@ -45,6 +47,11 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <cmath>
+#include <limits>
+
+//==============================================================================
+
 namespace OpenCOR {
 namespace SimulationSupport {
 
@@ -157,7 +164,11 @@ SimulationData::~SimulationData()
 
 void SimulationData::reload()
 {
-    // Reload ourselves by deleting and recreating our arrays
+    // Reload ourselves by deleting and recreating our arrays, after having
+    // forgotten about our sensitivity parameters since our model may have
+    // changed
+
+    mSensitivityParameters.clear();
 
     deleteArrays();
     createArrays();
@@ -209,6 +220,15 @@ double * SimulationData::algebraic() const
 
 //==============================================================================
 
+double * SimulationData::sensitivities() const
+{
+    // Return our sensitivities array
+
+    return mSensitivities;
+}
+
+//==============================================================================
+
 DataStore::DataStoreValues * SimulationData::constantsValues() const
 {
     // Return our constants values
@@ -528,6 +548,51 @@ void SimulationData::setNlaSolverProperty(const QString &pName,
 
 //==============================================================================
 
+QVector<int> SimulationData::sensitivityParameters() const
+{
+    // Return the index of the constants with respect to which we compute the
+    // sensitivities of our states
+
+    return mSensitivityParameters;
+}
+
+//==============================================================================
+
+bool SimulationData::setSensitivityParameters(const QVector<int> &pSensitivityParameters)
+{
+    // Set the index of the constants with respect to which we are to compute
+    // the sensitivities of our states, if they are different from our current
+    // ones, but only if our simulation is not running since our simulation
+    // worker (and its ODE solver) uses our current sensitivities array
+    // Note #1: our sensitivities are recorded by our results, so we need to
+    //          reset them since we have a new sensitivities array...
+    // Note #2: our initial sensitivities only make sense for our initial
+    //          states, so we reset our states (but not our constants) and
+    //          initialise our sensitivities (see reset())...
+
+    if (mSimulation->isRunning()) {
+        return false;
+    }
+
+    if (pSensitivityParameters == mSensitivityParameters) {
+        return true;
+    }
+
+    mSensitivityParameters = pSensitivityParameters;
+
+    delete[] mSensitivities;
+
+    createSensitivities();
+
+    reset(true, false);
+
+    mSimulation->results()->reset();
+
+    return true;
+}
+
+//==============================================================================
+
 void SimulationData::reset(bool pInitialize, bool pAll)
 {
     // Reset our parameter values which means both initialising our 'constants'
@@ -546,7 +611,7 @@ void SimulationData::reset(bool pInitialize, bool pAll)
 
         nlaSolver = static_cast<Solver::NlaSolver *>(nlaSolverInterface()->solverInstance());
 
-        Solver::setNlaSolver(runtime, nlaSolver);
+        runtime->nlaSolverContext()->setNlaSolver(nlaSolver);
 
         // Keep track of any error that might be reported by our NLA solver
 
@@ -574,6 +639,10 @@ void SimulationData::reset(bool pInitialize, bool pAll)
         mStatesArray->reset();
         mAlgebraicArray->reset();
 
+        if (mSensitivities != nullptr) {
+            memset(mSensitivities, 0, size_t(mSensitivityParameters.count()*runtime->statesCount())*Solver::SizeOfDouble);
+        }
+
         runtime->initializeConstants()(constants(), rates(), states());
     }
 
@@ -602,9 +671,17 @@ void SimulationData::reset(bool pInitialize, bool pAll)
         recomputeComputedConstantsAndVariables(mStartingPoint, pInitialize);
     }
 
-    // Delete our NLA solver, if any
+    // Initialise our sensitivities, now that we know our initial states
+
+    if (pInitialize) {
+        initializeSensitivities();
+    }
+
+    // Unset and delete our NLA solver, if any
 
     if (nlaSolver != nullptr) {
+        runtime->nlaSolverContext()->setNlaSolver(nullptr);
+
         delete nlaSolver;
     }
 
@@ -781,6 +858,79 @@ void SimulationData::createArrays()
         mConstantsValues = mRatesValues = mStatesValues = mAlgebraicValues = nullptr;
         mInitialConstants = mInitialStates = mDummyStates = nullptr;
     }
+
+    // Create our sensitivities array
+
+    createSensitivities();
+}
+
+//==============================================================================
+
+void SimulationData::createSensitivities()
+{
+    // Create our sensitivities array, if needed, i.e. if we have a runtime and
+    // some sensitivity parameters
+    // Note: the sensitivity of the Ith state with respect to the Pth
+    //       sensitivity parameter is at mSensitivities[P*statesCount+I]...
+
+    CellMLSupport::CellmlFileRuntime *runtime = mSimulation->runtime();
+
+    if ((runtime != nullptr) && !mSensitivityParameters.isEmpty()) {
+        mSensitivities = new double[mSensitivityParameters.count()*runtime->statesCount()] {};
+    } else {
+        mSensitivities = nullptr;
+    }
+}
+
+//==============================================================================
+
+void SimulationData::initializeSensitivities()
+{
+    // Initialise our sensitivities, i.e. the derivative of the initial value of
+    // our states with respect to our sensitivity parameters
+    // Note #1: the initial value of a state may depend on a constant (e.g. when
+    //          it is initialised using a constant), in which case its initial
+    //          sensitivity with respect to that constant is not zero. We
+    //          determine it using a forward difference quotient, i.e. we
+    //          perturb our sensitivity parameter and recompute the initial
+    //          value of our states, like CVODES does for our rates...
+    // Note #2: this relies on our states having just been initialised and on
+    //          our NLA solver, if any, having been set (see reset())...
+
+    if (mSensitivities == nullptr) {
+        return;
+    }
+
+    static const double SqrtUnitRoundoff = std::sqrt(std::numeric_limits<double>::epsilon());
+
+    CellMLSupport::CellmlFileRuntime *runtime = mSimulation->runtime();
+    int constantsCount = runtime->constantsCount();
+    int statesCount = runtime->statesCount();
+    QVector<double> perturbedConstants(constantsCount);
+    QVector<double> perturbedRates(runtime->ratesCount());
+    QVector<double> perturbedStates(statesCount);
+    QVector<double> perturbedAlgebraic(runtime->algebraicCount());
+
+    for (int i = 0, iMax = mSensitivityParameters.count(); i < iMax; ++i) {
+        int parameter = mSensitivityParameters[i];
+
+        memcpy(perturbedConstants.data(), constants(), size_t(constantsCount)*Solver::SizeOfDouble);
+        memcpy(perturbedRates.data(), rates(), size_t(runtime->ratesCount())*Solver::SizeOfDouble);
+        memcpy(perturbedStates.data(), states(), size_t(statesCount)*Solver::SizeOfDouble);
+        memcpy(perturbedAlgebraic.data(), algebraic(), size_t(runtime->algebraicCount())*Solver::SizeOfDouble);
+
+        double increment = SqrtUnitRoundoff*qMax(std::abs(perturbedConstants[parameter]), 1.0);
+
+        perturbedConstants[parameter] += increment;
+
+        runtime->computeComputedConstants()(mStartingPoint, perturbedConstants.data(),
+                                            perturbedRates.data(), perturbedStates.data(),
+                                            perturbedAlgebraic.data());
+
+        for (int j = 0; j < statesCount; ++j) {
+            mSensitivities[i*statesCount+j] = (perturbedStates[j]-states()[j])/increment;
+        }
+    }
 }
 
 //==============================================================================
@@ -820,12 +970,15 @@ void SimulationData::deleteArrays()
     delete[] mInitialStates;
     delete[] mDummyStates;
 
+    delete[] mSensitivities;
+
     // Reset our various arrays
     // Note: this shouldn't be needed, but better be safe than sorry...
 
     mConstantsArray = mRatesArray = mStatesArray = mAlgebraicArray = nullptr;
     mConstantsValues = mRatesValues = mStatesValues = mAlgebraicValues = nullptr;
     mInitialConstants = mInitialStates = mDummyStates = nullptr;
+    mSensitivities = nullptr;
 }
 
 //==============================================================================
@@ -886,6 +1039,8 @@ void SimulationResults::createDataStore()
 
     mDataStore = new DataStore::DataStore(mSimulation->cellmlFile()->xmlBase());
 
+    mDataStore->setMemoryLimit(mMemoryLimit);
+
     mPointsVariable = mDataStore->voi();
 
     mConstantsVariables = mDataStore->addVariables(simulationData->constants(), runtime->constantsCount());
@@ -939,6 +1094,31 @@ void SimulationResults::createDataStore()
         }
     }
 
+    // Add and customise our sensitivity variables, if any, i.e. the
+    // sensitivities of our states with respect to some of our constants, using
+    // our (now customised) state and constant variables
+
+    if (simulationData->sensitivities() != nullptr) {
+        const QVector<int> sensitivityParameters = simulationData->sensitivityParameters();
+        int statesCount = runtime->statesCount();
+
+        mSensitivitiesVariables = mDataStore->addVariables(simulationData->sensitivities(),
+                                                           sensitivityParameters.count()*statesCount);
+
+        for (int i = 0, iMax = sensitivityParameters.count(); i < iMax; ++i) {
+            DataStore::DataStoreVariable *constantVariable = mConstantsVariables[sensitivityParameters[i]];
+
+            for (int j = 0; j < statesCount; ++j) {
+                DataStore::DataStoreVariable *stateVariable = mStatesVariables[j];
+                DataStore::DataStoreVariable *variable = mSensitivitiesVariables[i*statesCount+j];
+
+                variable->setUri(QString("d(%1)/d(%2)").arg(stateVariable->uri(), constantVariable->uri()));
+                variable->setName(QString("d(%1)/d(%2)").arg(stateVariable->name(), constantVariable->name()));
+                variable->setUnit(QString("%1/%2").arg(stateVariable->unit(), constantVariable->unit()));
+            }
+        }
+    }
+
     // Reimport our data, if any, and update their array so that it contains the
     // computed values for our start point
 
@@ -963,6 +1143,81 @@ void SimulationResults::createDataStore()
     if (!mDataDataStores.isEmpty()) {
         emit simulationData->dataUpdated(mSimulation->currentPoint());
     }
+
+    // Make sure that our variables are recorded as expected
+
+    updateRecording();
+}
+
+//==============================================================================
+
+void SimulationResults::updateRecording()
+{
+    // Update the way our constant, rate, state and algebraic variables are to
+    // be recorded
+    // Note #1: if no variables have been specified then we record all of them,
+    //          as we have always done. Otherwise, the variables that have been
+    //          specified are recorded at every point while the others are not
+    //          recorded at all, except for constants, which we record once per
+    //          run so that their value remains available (e.g. for export)...
+    // Note #2: the VOI, imported data and sensitivities are always recorded,
+    //          the latter since they have been explicitly requested...
+
+    QSet<QString> recordedVariables = mRecordedVariables.toSet();
+    bool recordAll = recordedVariables.isEmpty();
+
+    for (auto variable : qAsConst(mConstantsVariables)) {
+        variable->setRecording((recordAll || recordedVariables.contains(variable->uri()))?
+                                   DataStore::DataStoreVariable::Recording::Always:
+                                   DataStore::DataStoreVariable::Recording::Once);
+    }
+
+    const DataStore::DataStoreVariables variables = mRatesVariables+mStatesVariables+mAlgebraicVariables;
+
+    for (auto variable : variables) {
+        variable->setRecording((recordAll || recordedVariables.contains(variable->uri()))?
+                                   DataStore::DataStoreVariable::Recording::Always:
+                                   DataStore::DataStoreVariable::Recording::None);
+    }
+
+    for (auto variable : qAsConst(mSensitivitiesVariables)) {
+        variable->setRecording(DataStore::DataStoreVariable::Recording::Always);
+    }
+}
+
+//==============================================================================
+
+void SimulationResults::updateNeedRecomputeVariables()
+{
+    // Determine whether our rates and algebraic variables need to be
+    // recomputed before adding a point to our current run, i.e. whether at
+    // least one of them is recorded
+    // Note: our states are up to date after a call to our ODE solver, and so
+    //       are our constants, so we can skip the potentially expensive
+    //       recomputation of our rates and algebraic variables if none of them
+    //       is to be recorded (e.g. when only states are plotted)...
+
+    mNeedRecomputeVariables = false;
+
+    const DataStore::DataStoreVariables variables = mRatesVariables+mAlgebraicVariables;
+
+    for (auto variable : variables) {
+        if (variable->recording() != DataStore::DataStoreVariable::Recording::None) {
+            mNeedRecomputeVariables = true;
+
+            break;
+        }
+    }
+}
+
+//==============================================================================
+
+bool SimulationResults::needRecomputeVariables() const
+{
+    // Return whether our rates and algebraic variables need to be recomputed
+    // before adding a point to our current run
+
+    return mNeedRecomputeVariables;
 }
 
 //==============================================================================
@@ -978,12 +1233,15 @@ void SimulationResults::deleteDataStore()
 
     mDataStore = nullptr;
 
+    mRealPointRunsCount = -1;
+
     mPointsVariable = nullptr;
 
     mConstantsVariables = DataStore::DataStoreVariables();
     mRatesVariables = DataStore::DataStoreVariables();
     mStatesVariables = DataStore::DataStoreVariables();
     mAlgebraicVariables = DataStore::DataStoreVariables();
+    mSensitivitiesVariables = DataStore::DataStoreVariables();
 
     mData.clear();
 }
@@ -997,6 +1255,8 @@ void SimulationResults::reload()
     // reloading a file)
 
     mDataDataStores.clear();
+    mDataDataStoresVariables.clear();
+    mDataDataStoresCursors.clear();
 
     reset();
 }
@@ -1035,6 +1295,7 @@ void SimulationResults::importData(DataStore::DataStoreImportData *pImportData)
 
     mData.insert(resultsValues, resultsVariables);
     mDataDataStores.insert(resultsValues, importDataStore);
+    mDataDataStoresVariables.insert(resultsValues, importDataStore->variables());
 
     // Customise our imported data
 
@@ -1117,6 +1378,8 @@ bool SimulationResults::addRun()
         bool res = mDataStore->addRun(simulationSize);
 
         if (res) {
+            updateNeedRecomputeVariables();
+
             emit runAdded();
         }
 
@@ -1128,6 +1391,39 @@ bool SimulationResults::addRun()
 
 //==============================================================================
 
+int SimulationResults::addRuns(int pRunsCount)
+{
+    // Ask our data store to add the given number of runs to itself and let
+    // people know about it, if we were able to add them, and return the index
+    // of the first of those runs
+    // Note: if we cannot add all the runs, then we keep none of them and
+    //       return -1...
+
+    quint64 simulationSize = mSimulation->size();
+
+    if ((simulationSize == 0) || (pRunsCount <= 0)) {
+        return -1;
+    }
+
+    int oldRunsCount = runsCount();
+
+    for (int i = 0; i < pRunsCount; ++i) {
+        if (!mDataStore->addRun(simulationSize)) {
+            mDataStore->keepRuns(oldRunsCount);
+
+            return -1;
+        }
+    }
+
+    updateNeedRecomputeVariables();
+
+    emit runAdded();
+
+    return oldRunsCount;
+}
+
+//==============================================================================
+
 double SimulationResults::realPoint(double pPoint, int pRun) const
 {
     // Determine the real value of the given point, if we didn't have several
@@ -1200,23 +1496,82 @@ double SimulationResults::realValue(double pPoint,
 
 void SimulationResults::addPoint(double pPoint)
 {
-    // Make sure that all our variables are up to date
+    // Make sure that all our variables are up to date, if needed
 
-    mSimulation->data()->recomputeVariables(pPoint);
+    if (mNeedRecomputeVariables) {
+        mSimulation->data()->recomputeVariables(pPoint);
+    }
 
     // Make sure that we have the correct imported data values for the given
     // point, keeping in mind that we may have several runs
+    // Note #1: the offset of our current run only changes when a run gets
+    //          added, so we cache it rather than recompute it for every
+    //          point...
+    // Note #2: our points are normally increasing, so rather than doing a
+    //          binary search for each imported variable (see realValue()), we
+    //          keep track of where we were in each imported VOI and move
+    //          forward from there. We then share the resulting interpolation
+    //          between all the variables of a given imported data store...
 
-    const QList<double *> dataKeys = mDataDataStores.keys();
-    double realPoint = SimulationResults::realPoint(pPoint);
+    if (!mDataDataStores.isEmpty()) {
+        int runsCount = SimulationResults::runsCount();
 
-    for (auto data : dataKeys) {
-        DataStore::DataStore *dataStore = mDataDataStores.value(data);
-        DataStore::DataStoreVariable *voi = dataStore->voi();
-        DataStore::DataStoreVariables variables = dataStore->variables();
+        if (runsCount != mRealPointRunsCount) {
+            mRealPointOffset = realPoint(0.0);
+            mRealPointRunsCount = runsCount;
+        }
+
+        double realPoint = mRealPointOffset+pPoint;
+
+        for (auto data = mDataDataStores.constBegin(), dataEnd = mDataDataStores.constEnd();
+             data != dataEnd; ++data) {
+            DataStore::DataStoreVariable *voi = data.value()->voi();
+            const DataStore::DataStoreVariables variables = mDataDataStoresVariables.value(data.key());
+            double *voiValues = voi->values();
+            quint64 voiSize = voi->size();
+            int variablesCount = variables.count();
+
+            if (   (voiValues == nullptr) || (voiSize == 0)
+                || (realPoint < voiValues[0]) || (realPoint > voiValues[voiSize-1])) {
+                for (int i = 0; i < variablesCount; ++i) {
+                    data.key()[i] = qQNaN();
+                }
+
+                continue;
+            }
+
+            // Determine the index of the VOI value that is just before (or at)
+            // our point, doing a binary search if we can't move forward from
+            // where we were
+
+            quint64 index = mDataDataStoresCursors.value(data.key());
 
-        for (int i = 0, iMax = variables.count(); i < iMax; ++i) {
-            data[i] = realValue(realPoint, voi, variables[i]);
+            if ((index >= voiSize) || (voiValues[index] > realPoint)) {
+                index = quint64(std::upper_bound(voiValues, voiValues+voiSize, realPoint)-voiValues)-1;
+            }
+
+            while ((index+1 < voiSize) && (voiValues[index+1] <= realPoint)) {
+                ++index;
+            }
+
+            mDataDataStoresCursors.insert(data.key(), index);
+
+            // Compute the value of our imported variables, interpolating them
+            // if needed
+
+            if (index+1 == voiSize) {
+                for (int i = 0; i < variablesCount; ++i) {
+                    data.key()[i] = variables[i]->value(index);
+                }
+            } else {
+                double ratio = (realPoint-voiValues[index])/(voiValues[index+1]-voiValues[index]);
+
+                for (int i = 0; i < variablesCount; ++i) {
+                    double *values = variables[i]->values();
+
+                    data.key()[i] = values[index]+ratio*(values[index+1]-values[index]);
+                }
+            }
         }
     }
 
@@ -1227,6 +1582,46 @@ void SimulationResults::addPoint(double pPoint)
 
 //==============================================================================
 
+void SimulationResults::addPoint(double pPoint, int pRun,
+                                 const double *pConstants, const double *pRates,
+                                 const double *pStates,
+                                 const double *pAlgebraic)
+{
+    // Add the given point and model values to the given run
+    // Note #1: this is used by our ensemble workers, which have their own model
+    //          arrays and each write to their own run, hence we cannot rely on
+    //          DataStore::addValues()...
+    // Note #2: imported data is not supported by ensemble runs, so we leave it
+    //          alone, and neither are sensitivities, so we don't have any
+    //          values for them...
+    // Note #3: like in DataStore::addValues(), we must add the VOI value last
+    //          (see issue #1579)...
+
+    for (int i = 0, iMax = mConstantsVariables.count(); i < iMax; ++i) {
+        mConstantsVariables[i]->addValue(pConstants[i], pRun);
+    }
+
+    for (int i = 0, iMax = mRatesVariables.count(); i < iMax; ++i) {
+        mRatesVariables[i]->addValue(pRates[i], pRun);
+    }
+
+    for (int i = 0, iMax = mStatesVariables.count(); i < iMax; ++i) {
+        mStatesVariables[i]->addValue(pStates[i], pRun);
+    }
+
+    for (int i = 0, iMax = mAlgebraicVariables.count(); i < iMax; ++i) {
+        mAlgebraicVariables[i]->addValue(pAlgebraic[i], pRun);
+    }
+
+    for (auto variable : qAsConst(mSensitivitiesVariables)) {
+        variable->addValue(qQNaN(), pRun);
+    }
+
+    mPointsVariable->addValue(pPoint, pRun);
+}
+
+//==============================================================================
+
 quint64 SimulationResults::size(int pRun) const
 {
     // Return the size of our data store for the given run
@@ -1238,6 +1633,53 @@ quint64 SimulationResults::size(int pRun) const
 
 //==============================================================================
 
+QStringList SimulationResults::recordedVariables() const
+{
+    // Return the URI of the variables that we record at every point
+
+    return mRecordedVariables;
+}
+
+//==============================================================================
+
+void SimulationResults::setRecordedVariables(const QStringList &pRecordedVariables)
+{
+    // Set the URI of the variables that we are to record at every point (an
+    // empty list meaning that all of them are to be recorded) and update the
+    // way our variables are to be recorded
+    // Note: this only affects the runs that get added from now on...
+
+    mRecordedVariables = pRecordedVariables;
+
+    updateRecording();
+}
+
+//==============================================================================
+
+quint64 SimulationResults::memoryLimit() const
+{
+    // Return the amount of memory (in bytes) that the values of a run may use
+
+    return mMemoryLimit;
+}
+
+//==============================================================================
+
+void SimulationResults::setMemoryLimit(quint64 pMemoryLimit)
+{
+    // Set the amount of memory (in bytes) that the values of a run may use (0
+    // meaning that there is no limit), beyond which points get ignored
+    // Note: this only affects the runs that get added from now on...
+
+    mMemoryLimit = pMemoryLimit;
+
+    if (mDataStore != nullptr) {
+        mDataStore->setMemoryLimit(pMemoryLimit);
+    }
+}
+
+//==============================================================================
+
 DataStore::DataStore * SimulationResults::dataStore() const
 {
     // Return our data store
@@ -1360,6 +1802,15 @@ DataStore::DataStoreVariables SimulationResults::algebraicVariables() const
 
 //==============================================================================
 
+DataStore::DataStoreVariables SimulationResults::sensitivitiesVariables() const
+{
+    // Return our sensitivities variables
+
+    return mSensitivitiesVariables;
+}
+
+//==============================================================================
+
 SimulationImportData::SimulationImportData(Simulation *pSimulation) :
     SimulationObject(pSimulation)
 {
@@ -1779,6 +2230,26 @@ SimulationWorker * Simulation::worker() const
 
 //==============================================================================
 
+Solver::NlaSolver::Statistics Simulation::nlaSolverStatistics() const
+{
+    // Return the statistics of the NLA solver used by our last run, if any
+
+    return mNlaSolverStatistics;
+}
+
+//==============================================================================
+
+void Simulation::setNlaSolverStatistics(const Solver::NlaSolver::Statistics &pNlaSolverStatistics)
+{
+    // Keep track of the statistics of the NLA solver used by our last run
+    // Note: this is called by our worker just before it lets people know that
+    //       it is done...
+
+    mNlaSolverStatistics = pNlaSolverStatistics;
+}
+
+//==============================================================================
+
 Simulation::FileType Simulation::fileType() const
 {
     // Return our file type
@@ -1904,6 +2375,10 @@ bool Simulation::isRunning() const
 {
     // Return whether we are running
 
+    if (mEnsembleWorkersCount != 0) {
+        return true;
+    }
+
     return (mWorker != nullptr)?
                 mWorker->isRunning():
                 false;
@@ -2038,6 +2513,178 @@ void Simulation::run()
 
 //==============================================================================
 
+bool Simulation::runEnsemble(const SimulationEnsembleValuesList &pValuesList,
+                             int pThreadsCount)
+{
+    // Make sure that we have a runtime, that we are not already running and
+    // that the simulation settings we were given are sound
+
+    if (   (mRuntime == nullptr) || (mWorker != nullptr)
+        || (mEnsembleWorkersCount != 0) || pValuesList.isEmpty()
+        || !simulationSettingsOk()) {
+        return false;
+    }
+
+    // Map the URI of our constants and states to their position in our
+    // simulation data
+
+    QHash<QString, int> constantsIndexes;
+    QHash<QString, int> statesIndexes;
+    DataStore::DataStoreValues *constantsValues = mData->constantsValues();
+    DataStore::DataStoreValues *statesValues = mData->statesValues();
+
+    for (int i = 0, iMax = constantsValues->count(); i < iMax; ++i) {
+        constantsIndexes.insert(constantsValues->at(i)->uri(), i);
+    }
+
+    for (int i = 0, iMax = statesValues->count(); i < iMax; ++i) {
+        statesIndexes.insert(statesValues->at(i)->uri(), i);
+    }
+
+    // Add a run for each member of our ensemble
+
+    int firstRun = mResults->addRuns(pValuesList.count());
+
+    if (firstRun == -1) {
+        return false;
+    }
+
+    // Create our ensemble members, using our current constants and states as a
+    // basis
+
+    int constantsCount = mRuntime->constantsCount();
+    int statesCount = mRuntime->statesCount();
+    QVector<double> constants(constantsCount);
+    QVector<double> states(statesCount);
+    SimulationEnsembleMembers members;
+
+    memcpy(constants.data(), mData->constants(), size_t(constantsCount)*Solver::SizeOfDouble);
+    memcpy(states.data(), mData->states(), size_t(statesCount)*Solver::SizeOfDouble);
+
+    // Note: a member's states overrides are kept apart from its states since
+    //       the initial value of some of its states may depend on some of its
+    //       constants (see SimulationEnsembleWorker::initializeMember())...
+
+    for (int i = 0, iMax = pValuesList.count(); i < iMax; ++i) {
+        QVector<double> memberConstants = constants;
+        QMap<int, double> memberStatesOverrides;
+        const SimulationEnsembleValues &values = pValuesList[i];
+
+        for (auto value = values.constBegin(), valueEnd = values.constEnd();
+             value != valueEnd; ++value) {
+            if (constantsIndexes.contains(value.key())) {
+                memberConstants[constantsIndexes.value(value.key())] = value.value();
+            } else if (statesIndexes.contains(value.key())) {
+                memberStatesOverrides.insert(statesIndexes.value(value.key()), value.value());
+            }
+        }
+
+        members << SimulationEnsembleMember(firstRun+i, memberConstants, states,
+                                            memberStatesOverrides);
+    }
+
+    // Determine whether our members can be run in batches, i.e. whether we use
+    // a fixed-step ODE solver and our runtime can provide us with a batched
+    // version of computeRates() (see SimulationEnsembleWorker::runMembers())
+
+    Solver::OdeSolver::ComputeRatesFunction computeRatesBatch = nullptr;
+
+    if (members.count() > 1) {
+        auto odeSolver = static_cast<Solver::OdeSolver *>(mData->odeSolverInterface()->solverInstance());
+
+        if (odeSolver->hasFixedStep()) {
+            computeRatesBatch = mRuntime->computeRatesBatch();
+        }
+
+        delete odeSolver;
+    }
+
+    // Determine how many workers we need
+    // Note: if our members are to be run in batches, then there is no point in
+    //       having more workers than batches...
+
+    int threadsCount = (pThreadsCount > 0)?
+                           pThreadsCount:
+                           QThread::idealThreadCount();
+
+    threadsCount = qMax(1, qMin(threadsCount,
+                                (computeRatesBatch != nullptr)?
+                                    (members.count()+CellMLSupport::ComputeRatesBatchSize-1)/CellMLSupport::ComputeRatesBatchSize:
+                                    members.count()));
+
+    // Create our workers and move them to their own thread
+
+    mEnsembleNextMember.storeRelease(0);
+    mEnsembleStopped.storeRelease(0);
+    mEnsembleError = false;
+    mEnsembleWorkersCount = threadsCount;
+
+    emit running(false);
+
+    mEnsembleTimer.start();
+
+    for (int i = 0; i < threadsCount; ++i) {
+        auto thread = new QThread();
+        auto worker = new SimulationEnsembleWorker(this, members,
+                                                   computeRatesBatch,
+                                                   &mEnsembleNextMember,
+                                                   &mEnsembleStopped);
+
+        worker->moveToThread(thread);
+
+        connect(thread, &QThread::started,
+                worker, &SimulationEnsembleWorker::run);
+
+        connect(worker, &SimulationEnsembleWorker::done,
+                this, &Simulation::ensembleWorkerDone);
+        connect(worker, &SimulationEnsembleWorker::done,
+                thread, &QThread::quit);
+        connect(worker, &SimulationEnsembleWorker::done,
+                worker, &SimulationEnsembleWorker::deleteLater);
+
+        connect(worker, &SimulationEnsembleWorker::error,
+                this, &Simulation::ensembleWorkerError);
+
+        connect(thread, &QThread::finished,
+                thread, &QThread::deleteLater);
+
+        thread->start();
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+void Simulation::ensembleWorkerDone()
+{
+    // One of our ensemble workers is done, so let people know that our
+    // ensemble is done, if it was our last worker
+
+    if (--mEnsembleWorkersCount == 0) {
+        emit done(mEnsembleError?-1:mEnsembleTimer.elapsed());
+    }
+}
+
+//==============================================================================
+
+void Simulation::ensembleWorkerError(const QString &pMessage)
+{
+    // One of our ensemble workers reported an error, so stop all our workers
+    // and let people know about the error, but only if another error hasn't
+    // already been reported
+
+    mEnsembleStopped.storeRelease(1);
+
+    if (!mEnsembleError) {
+        mEnsembleError = true;
+
+        emit error(pMessage);
+    }
+}
+
+//==============================================================================
+
 void Simulation::pause()
 {
     // Pause our worker
@@ -2062,11 +2709,13 @@ void Simulation::resume()
 
 void Simulation::stop()
 {
-    // Stop our worker
+    // Stop our worker and ensemble workers, if any
 
     if (mWorker != nullptr) {
         mWorker->stop();
     }
+
+    mEnsembleStopped.storeRelease(1);
 }
 
 //==============================================================================
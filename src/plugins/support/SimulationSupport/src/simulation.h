@@ -31,6 +31,11 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+//==============================================================================
+
 #include <functional>
 
 //==============================================================================
@@ -68,8 +73,16 @@ namespace SimulationSupport {
 
 //==============================================================================
 
+static const qint64 VariablesRefreshInterval = 100;   // ms
+// Note: this is how often our rates and algebraic variables get recomputed
+//       during a run if they are not recorded (see SimulationWorker::run()),
+//       so that their value remains up to date for the GUI...
+
+//==============================================================================
+
 class Simulation;
 class SimulationData;
+class SimulationEnsembleWorker;
 class SimulationWorker;
 
 //==============================================================================
@@ -120,6 +133,14 @@ private:
 
 using SimulationIssues = QList<SimulationIssue>;
 
+//==============================================================================
+// Note: the values of an ensemble member are the constants and/or states that
+//       differ from those of our simulation data, and they are referenced by
+//       their URI...
+
+using SimulationEnsembleValues = QMap<QString, double>;
+using SimulationEnsembleValuesList = QList<SimulationEnsembleValues>;
+
 //==============================================================================
 
 class SimulationObject : public QObject
@@ -147,6 +168,7 @@ public:
     double * rates() const;
     double * states() const;
     double * algebraic() const;
+    double * sensitivities() const;
     double * data(DataStore::DataStore *pDataStore) const;
 
     void importData(DataStore::DataStoreImportData *pImportData);
@@ -196,6 +218,9 @@ private:
     DataStore::DataStoreValues *mStatesValues = nullptr;
     DataStore::DataStoreValues *mAlgebraicValues = nullptr;
 
+    QVector<int> mSensitivityParameters;
+    double *mSensitivities = nullptr;
+
     double *mInitialConstants = nullptr;
     double *mInitialStates = nullptr;
     double *mDummyStates = nullptr;
@@ -207,6 +232,9 @@ private:
     void createArrays();
     void deleteArrays();
 
+    void createSensitivities();
+    void initializeSensitivities();
+
     SolverInterface * solverInterface(const QString &pSolverName) const;
 
     bool doIsModified(bool pCheckConstants) const;
@@ -242,6 +270,9 @@ public slots:
     void setNlaSolverProperty(const QString &pName, const QVariant &pValue,
                               bool pReset = true);
 
+    QVector<int> sensitivityParameters() const;
+    bool setSensitivityParameters(const QVector<int> &pSensitivityParameters);
+
     void reset(bool pInitialize = true, bool pAll = true);
 
     void recomputeComputedConstantsAndVariables(double pCurrentPoint,
@@ -269,8 +300,14 @@ public:
     void importData(DataStore::DataStoreImportData *pImportData);
 
     bool addRun();
+    int addRuns(int pRunsCount);
 
     void addPoint(double pPoint);
+    void addPoint(double pPoint, int pRun, const double *pConstants,
+                  const double *pRates, const double *pStates,
+                  const double *pAlgebraic);
+
+    bool needRecomputeVariables() const;
 
     double * points(int pRun = -1) const;
 
@@ -287,24 +324,41 @@ public:
     DataStore::DataStoreVariables ratesVariables() const;
     DataStore::DataStoreVariables statesVariables() const;
     DataStore::DataStoreVariables algebraicVariables() const;
+    DataStore::DataStoreVariables sensitivitiesVariables() const;
+
+    static QString uri(const QStringList &pComponentHierarchy,
+                       const QString &pName);
 
 private:
     DataStore::DataStore *mDataStore = nullptr;
 
+    QStringList mRecordedVariables;
+
+    quint64 mMemoryLimit = 0;
+
+    bool mNeedRecomputeVariables = true;
+
     DataStore::DataStoreVariable *mPointsVariable = nullptr;
 
     DataStore::DataStoreVariables mConstantsVariables;
     DataStore::DataStoreVariables mRatesVariables;
     DataStore::DataStoreVariables mStatesVariables;
     DataStore::DataStoreVariables mAlgebraicVariables;
+    DataStore::DataStoreVariables mSensitivitiesVariables;
 
     QHash<double *, DataStore::DataStoreVariables> mData;
     QHash<double *, DataStore::DataStore *> mDataDataStores;
+    QHash<double *, DataStore::DataStoreVariables> mDataDataStoresVariables;
+    QHash<double *, quint64> mDataDataStoresCursors;
+
+    int mRealPointRunsCount = -1;
+    double mRealPointOffset = 0.0;
 
     void createDataStore();
     void deleteDataStore();
 
-    QString uri(const QStringList &pComponentHierarchy, const QString &pName);
+    void updateRecording();
+    void updateNeedRecomputeVariables();
 
     double realPoint(double pPoint, int pRun = -1) const;
 
@@ -324,6 +378,12 @@ public slots:
 
     quint64 size(int pRun = -1) const;
 
+    QStringList recordedVariables() const;
+    void setRecordedVariables(const QStringList &pRecordedVariables);
+
+    quint64 memoryLimit() const;
+    void setMemoryLimit(quint64 pMemoryLimit);
+
     OpenCOR::DataStore::DataStore * dataStore() const;
 };
 
@@ -368,6 +428,9 @@ public:
 
     SimulationWorker * worker() const;
 
+    Solver::NlaSolver::Statistics nlaSolverStatistics() const;
+    void setNlaSolverStatistics(const Solver::NlaSolver::Statistics &pNlaSolverStatistics);
+
     Simulation::FileType fileType() const;
 
     CellMLSupport::CellmlFile * cellmlFile() const;
@@ -381,6 +444,8 @@ public:
     bool addRun();
 
     void run();
+    bool runEnsemble(const SimulationEnsembleValuesList &pValuesList,
+                     int pThreadsCount = 0);
     void pause();
     void resume();
     void stop();
@@ -403,6 +468,14 @@ private:
 
     SimulationWorker *mWorker = nullptr;
 
+    Solver::NlaSolver::Statistics mNlaSolverStatistics;
+
+    int mEnsembleWorkersCount = 0;
+    QAtomicInt mEnsembleNextMember;
+    QAtomicInt mEnsembleStopped = 0;
+    bool mEnsembleError = false;
+    QElapsedTimer mEnsembleTimer;
+
     SimulationData *mData = nullptr;
     SimulationResults *mResults = nullptr;
     SimulationImportData *mImportData = nullptr;
@@ -451,6 +524,9 @@ public slots:
 
 private slots:
     void fileManaged(const QString &pFileName);
+
+    void ensembleWorkerDone();
+    void ensembleWorkerError(const QString &pMessage);
 };
 
 //==============================================================================
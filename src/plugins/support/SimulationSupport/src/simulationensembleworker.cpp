@@ -0,0 +1,489 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Simulation ensemble worker
+//==============================================================================
+
+#include "cellmlfileruntime.h"
+#include "simulation.h"
+#include "simulationensembleworker.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace SimulationSupport {
+
+//==============================================================================
+
+SimulationEnsembleMember::SimulationEnsembleMember(int pRun,
+                                                   const QVector<double> &pConstants,
+                                                   const QVector<double> &pStates,
+                                                   const QMap<int, double> &pStatesOverrides) :
+    mRun(pRun),
+    mConstants(pConstants),
+    mStates(pStates),
+    mStatesOverrides(pStatesOverrides)
+{
+}
+
+//==============================================================================
+
+int SimulationEnsembleMember::run() const
+{
+    // Return our run
+
+    return mRun;
+}
+
+//==============================================================================
+
+const QVector<double> & SimulationEnsembleMember::constants() const
+{
+    // Return our constants
+
+    return mConstants;
+}
+
+//==============================================================================
+
+const QVector<double> & SimulationEnsembleMember::states() const
+{
+    // Return our states
+
+    return mStates;
+}
+
+//==============================================================================
+
+const QMap<int, double> & SimulationEnsembleMember::statesOverrides() const
+{
+    // Return our states overrides
+
+    return mStatesOverrides;
+}
+
+//==============================================================================
+
+SimulationEnsembleWorker::SimulationEnsembleWorker(Simulation *pSimulation,
+                                                   const SimulationEnsembleMembers &pMembers,
+                                                   Solver::OdeSolver::ComputeRatesFunction pComputeRatesBatch,
+                                                   QAtomicInt *pNextMember,
+                                                   const QAtomicInt *pStopped) :
+    mSimulation(pSimulation),
+    mRuntime(pSimulation->runtime()),
+    mOdeSolverInterface(pSimulation->data()->odeSolverInterface()),
+    mNlaSolverInterface(pSimulation->data()->nlaSolverInterface()),
+    mOdeSolverProperties(pSimulation->data()->odeSolverProperties()),
+    mNlaSolverProperties(pSimulation->data()->nlaSolverProperties()),
+    mStartingPoint(pSimulation->data()->startingPoint()),
+    mEndingPoint(pSimulation->data()->endingPoint()),
+    mPointInterval(pSimulation->data()->pointInterval()),
+    mStatesDependencies(pSimulation->runtime()->statesDependencies()),
+    mMembers(pMembers),
+    mComputeRatesBatch(pComputeRatesBatch),
+    mNextMember(pNextMember),
+    mStopped(pStopped)
+{
+    // Note: we retrieve everything we need from our simulation here, i.e. from
+    //       the main thread, so that we don't have to access our simulation
+    //       from our own thread while it might be modified...
+}
+
+//==============================================================================
+
+void SimulationEnsembleWorker::run()
+{
+    // Create our own copy of the model's arrays
+
+    int constantsCount = mRuntime->constantsCount();
+    int statesCount = mRuntime->statesCount();
+    auto constants = new double[constantsCount] {};
+    auto rates = new double[mRuntime->ratesCount()] {};
+    auto states = new double[statesCount] {};
+    auto algebraic = new double[mRuntime->algebraicCount()] {};
+
+    // Create our batched arrays, if needed (see runMembers())
+
+    double *batchConstants = nullptr;
+    double *batchRates = nullptr;
+    double *batchStates = nullptr;
+    double *batchAlgebraic = nullptr;
+
+    if (mComputeRatesBatch != nullptr) {
+        batchConstants = new double[CellMLSupport::ComputeRatesBatchSize*constantsCount] {};
+        batchRates = new double[CellMLSupport::ComputeRatesBatchSize*mRuntime->ratesCount()] {};
+        batchStates = new double[CellMLSupport::ComputeRatesBatchSize*statesCount] {};
+        batchAlgebraic = new double[CellMLSupport::ComputeRatesBatchSize*mRuntime->algebraicCount()] {};
+    }
+
+    // Set up our NLA solver, if needed
+    // Note: our runtime keeps track of one NLA solver per thread, so each
+    //       ensemble worker can have its own NLA solver...
+
+    Solver::NlaSolver *nlaSolver = nullptr;
+
+    if (mRuntime->needNlaSolver()) {
+        nlaSolver = static_cast<Solver::NlaSolver *>(mNlaSolverInterface->solverInstance());
+
+        nlaSolver->setProperties(mNlaSolverProperties);
+
+        mRuntime->nlaSolverContext()->setNlaSolver(nlaSolver);
+
+        connect(nlaSolver, &Solver::NlaSolver::error,
+                this, &SimulationEnsembleWorker::emitError);
+    }
+
+    // Keep running members (or batches of members) of our ensemble until there
+    // are none left or until we have been asked to stop
+
+    int membersStep = (mComputeRatesBatch != nullptr)?
+                          CellMLSupport::ComputeRatesBatchSize:
+                          1;
+
+    forever {
+        int member = mNextMember->fetchAndAddOrdered(membersStep);
+
+        if ((member >= mMembers.count()) || (mStopped->loadAcquire() != 0) || mError) {
+            break;
+        }
+
+        if (mComputeRatesBatch != nullptr) {
+            if (!runMembers(member, constants, rates, states, algebraic,
+                            batchConstants, batchRates, batchStates,
+                            batchAlgebraic)) {
+                break;
+            }
+        } else if (!runMember(mMembers[member], constants, rates, states,
+                              algebraic)) {
+            break;
+        }
+    }
+
+    // Unset and delete our NLA solver, if any, and delete our arrays
+
+    if (nlaSolver != nullptr) {
+        mRuntime->nlaSolverContext()->setNlaSolver(nullptr);
+
+        delete nlaSolver;
+    }
+
+    delete[] constants;
+    delete[] rates;
+    delete[] states;
+    delete[] algebraic;
+
+    delete[] batchConstants;
+    delete[] batchRates;
+    delete[] batchStates;
+    delete[] batchAlgebraic;
+
+    // Let people know that we are done
+
+    emit done();
+}
+
+//==============================================================================
+
+void SimulationEnsembleWorker::initializeMember(const SimulationEnsembleMember &pMember,
+                                                double *pConstants,
+                                                double *pRates,
+                                                double *pStates,
+                                                double *pAlgebraic)
+{
+    // Initialise our arrays using the member's constants and states, and
+    // compute our 'computed constants' and 'variables'
+    // Note: like when our simulation data gets reset, we compute our 'computed
+    //       constants' using the member's states, so that a state whose initial
+    //       value depends on a constant that the member overrides gets the
+    //       right initial value, and only then do we apply the member's states
+    //       overrides (see SimulationData::reset())...
+
+    memcpy(pConstants, pMember.constants().constData(), size_t(mRuntime->constantsCount())*Solver::SizeOfDouble);
+    memset(pRates, 0, size_t(mRuntime->ratesCount())*Solver::SizeOfDouble);
+    memcpy(pStates, pMember.states().constData(), size_t(mRuntime->statesCount())*Solver::SizeOfDouble);
+    memset(pAlgebraic, 0, size_t(mRuntime->algebraicCount())*Solver::SizeOfDouble);
+
+    mRuntime->computeComputedConstants()(mStartingPoint, pConstants, pRates, pStates, pAlgebraic);
+
+    const QMap<int, double> &statesOverrides = pMember.statesOverrides();
+
+    for (auto stateOverride = statesOverrides.constBegin(), stateOverrideEnd = statesOverrides.constEnd();
+         stateOverride != stateOverrideEnd; ++stateOverride) {
+        pStates[stateOverride.key()] = stateOverride.value();
+    }
+
+    mRuntime->computeRates()(mStartingPoint, pConstants, pRates, pStates, pAlgebraic);
+    mRuntime->computeVariables()(mStartingPoint, pConstants, pRates, pStates, pAlgebraic);
+}
+
+//==============================================================================
+
+bool SimulationEnsembleWorker::runMember(const SimulationEnsembleMember &pMember,
+                                         double *pConstants, double *pRates,
+                                         double *pStates, double *pAlgebraic)
+{
+    // Initialise our arrays using the member's constants and states
+
+    int statesCount = mRuntime->statesCount();
+
+    initializeMember(pMember, pConstants, pRates, pStates, pAlgebraic);
+
+    // Set up our ODE solver
+    // Note: we use a new ODE solver for each member since some solvers (e.g.
+    //       CVODE) cannot be initialised more than once...
+
+    auto odeSolver = static_cast<Solver::OdeSolver *>(mOdeSolverInterface->solverInstance());
+
+    connect(odeSolver, &Solver::OdeSolver::error,
+            this, &SimulationEnsembleWorker::emitError);
+
+    odeSolver->setProperties(mOdeSolverProperties);
+    odeSolver->setStatesDependencies(mStatesDependencies);
+    odeSolver->setRootsFunction(mRuntime->rootsCount(),
+                                mRuntime->computeRoots());
+
+    double currentPoint = mStartingPoint;
+
+    odeSolver->initialize(currentPoint, statesCount,
+                          pConstants, pRates, pStates, pAlgebraic,
+                          mRuntime->computeRates());
+
+    // Compute our member, but only if no error has occurred so far
+
+    SimulationResults *results = mSimulation->results();
+    bool needRecomputeVariables = results->needRecomputeVariables();
+    int run = pMember.run();
+
+    if (!mError) {
+        results->addPoint(currentPoint, run,
+                          pConstants, pRates, pStates, pAlgebraic);
+
+        quint64 pointCounter = 0;
+
+        forever {
+            odeSolver->solve(currentPoint,
+                             qMin(mEndingPoint,
+                                  mStartingPoint+double(++pointCounter)*mPointInterval));
+
+            if (mError) {
+                break;
+            }
+
+            if (needRecomputeVariables) {
+                mRuntime->computeRates()(currentPoint, pConstants, pRates, pStates, pAlgebraic);
+                mRuntime->computeVariables()(currentPoint, pConstants, pRates, pStates, pAlgebraic);
+            }
+
+            results->addPoint(currentPoint, run,
+                              pConstants, pRates, pStates, pAlgebraic);
+
+            if (qFuzzyCompare(currentPoint, mEndingPoint) || (mStopped->loadAcquire() != 0)) {
+                break;
+            }
+        }
+    }
+
+    // Delete our ODE solver
+
+    delete odeSolver;
+
+    return !mError;
+}
+
+//==============================================================================
+
+static void scatterValues(const double *pValues, double *pBatchValues,
+                          int pCount, int pInstance)
+{
+    // Copy the given values to the given instance of the given batched values
+
+    for (int i = 0; i < pCount; ++i) {
+        pBatchValues[i*CellMLSupport::ComputeRatesBatchSize+pInstance] = pValues[i];
+    }
+}
+
+//==============================================================================
+
+static void gatherValues(const double *pBatchValues, double *pValues,
+                         int pCount, int pInstance)
+{
+    // Copy the given instance of the given batched values to the given values
+
+    for (int i = 0; i < pCount; ++i) {
+        pValues[i] = pBatchValues[i*CellMLSupport::ComputeRatesBatchSize+pInstance];
+    }
+}
+
+//==============================================================================
+
+void SimulationEnsembleWorker::addMembersPoint(double pPoint, int pFirstMember,
+                                               int pMembersCount,
+                                               bool pRecomputeVariables,
+                                               double *pConstants,
+                                               double *pRates,
+                                               double *pStates,
+                                               double *pAlgebraic,
+                                               const double *pBatchConstants,
+                                               const double *pBatchRates,
+                                               const double *pBatchStates,
+                                               const double *pBatchAlgebraic)
+{
+    // Add a point to the run of each of the given members, using our batched
+    // arrays
+
+    SimulationResults *results = mSimulation->results();
+    int constantsCount = mRuntime->constantsCount();
+    int ratesCount = mRuntime->ratesCount();
+    int statesCount = mRuntime->statesCount();
+    int algebraicCount = mRuntime->algebraicCount();
+
+    for (int i = 0; i < pMembersCount; ++i) {
+        gatherValues(pBatchConstants, pConstants, constantsCount, i);
+        gatherValues(pBatchRates, pRates, ratesCount, i);
+        gatherValues(pBatchStates, pStates, statesCount, i);
+        gatherValues(pBatchAlgebraic, pAlgebraic, algebraicCount, i);
+
+        if (pRecomputeVariables) {
+            mRuntime->computeRates()(pPoint, pConstants, pRates, pStates, pAlgebraic);
+            mRuntime->computeVariables()(pPoint, pConstants, pRates, pStates, pAlgebraic);
+        }
+
+        results->addPoint(pPoint, mMembers[pFirstMember+i].run(),
+                          pConstants, pRates, pStates, pAlgebraic);
+    }
+}
+
+//==============================================================================
+
+bool SimulationEnsembleWorker::runMembers(int pFirstMember, double *pConstants,
+                                          double *pRates, double *pStates,
+                                          double *pAlgebraic,
+                                          double *pBatchConstants,
+                                          double *pBatchRates,
+                                          double *pBatchStates,
+                                          double *pBatchAlgebraic)
+{
+    // Initialise our batched arrays using the ComputeRatesBatchSize members
+    // starting from the given one
+    // Note: if there are fewer members left, then we use the last member to
+    //       fill our batched arrays, but we don't keep track of its results
+    //       more than once...
+
+    int constantsCount = mRuntime->constantsCount();
+    int ratesCount = mRuntime->ratesCount();
+    int statesCount = mRuntime->statesCount();
+    int algebraicCount = mRuntime->algebraicCount();
+    int membersCount = qMin(CellMLSupport::ComputeRatesBatchSize,
+                            mMembers.count()-pFirstMember);
+
+    for (int i = 0; i < CellMLSupport::ComputeRatesBatchSize; ++i) {
+        if (i < membersCount) {
+            initializeMember(mMembers[pFirstMember+i],
+                             pConstants, pRates, pStates, pAlgebraic);
+        }
+
+        scatterValues(pConstants, pBatchConstants, constantsCount, i);
+        scatterValues(pRates, pBatchRates, ratesCount, i);
+        scatterValues(pStates, pBatchStates, statesCount, i);
+        scatterValues(pAlgebraic, pBatchAlgebraic, algebraicCount, i);
+    }
+
+    // Set up our ODE solver
+    // Note: our ODE solver uses a fixed step (see Simulation::runEnsemble()),
+    //       so it can solve all our members at once by considering them as
+    //       one model with ComputeRatesBatchSize times as many states, and by
+    //       using the batched version of computeRates()...
+
+    auto odeSolver = static_cast<Solver::OdeSolver *>(mOdeSolverInterface->solverInstance());
+
+    connect(odeSolver, &Solver::OdeSolver::error,
+            this, &SimulationEnsembleWorker::emitError);
+
+    odeSolver->setProperties(mOdeSolverProperties);
+
+    double currentPoint = mStartingPoint;
+
+    odeSolver->initialize(currentPoint,
+                          CellMLSupport::ComputeRatesBatchSize*statesCount,
+                          pBatchConstants, pBatchRates, pBatchStates,
+                          pBatchAlgebraic, mComputeRatesBatch);
+
+    // Compute our members, but only if no error has occurred so far
+
+    bool needRecomputeVariables = mSimulation->results()->needRecomputeVariables();
+
+    if (!mError) {
+        addMembersPoint(currentPoint, pFirstMember, membersCount, false,
+                        pConstants, pRates, pStates, pAlgebraic,
+                        pBatchConstants, pBatchRates, pBatchStates,
+                        pBatchAlgebraic);
+
+        quint64 pointCounter = 0;
+
+        forever {
+            odeSolver->solve(currentPoint,
+                             qMin(mEndingPoint,
+                                  mStartingPoint+double(++pointCounter)*mPointInterval));
+
+            if (mError) {
+                break;
+            }
+
+            addMembersPoint(currentPoint, pFirstMember, membersCount,
+                            needRecomputeVariables,
+                            pConstants, pRates, pStates, pAlgebraic,
+                            pBatchConstants, pBatchRates, pBatchStates,
+                            pBatchAlgebraic);
+
+            if (qFuzzyCompare(currentPoint, mEndingPoint) || (mStopped->loadAcquire() != 0)) {
+                break;
+            }
+        }
+    }
+
+    // Delete our ODE solver
+
+    delete odeSolver;
+
+    return !mError;
+}
+
+//==============================================================================
+
+void SimulationEnsembleWorker::emitError(const QString &pMessage)
+{
+    // A solver error occurred, so keep track of it and let people know about
+    // it, but only if another error hasn't already been received
+
+    if (!mError) {
+        mError = true;
+
+        emit error(pMessage);
+    }
+}
+
+//==============================================================================
+
+} // namespace SimulationSupport
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
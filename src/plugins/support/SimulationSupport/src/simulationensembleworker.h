@@ -0,0 +1,159 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Simulation ensemble worker
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include "solverinterface.h"
+
+//==============================================================================
+
+#include <QAtomicInt>
+#include <QMap>
+#include <QObject>
+#include <QVector>
+
+//==============================================================================
+
+namespace OpenCOR {
+
+//==============================================================================
+
+namespace CellMLSupport {
+    class CellmlFileRuntime;
+} // namespace CellMLSupport
+
+//==============================================================================
+
+namespace SimulationSupport {
+
+//==============================================================================
+
+class Simulation;
+
+//==============================================================================
+
+class SimulationEnsembleMember
+{
+public:
+    explicit SimulationEnsembleMember(int pRun, const QVector<double> &pConstants,
+                                      const QVector<double> &pStates,
+                                      const QMap<int, double> &pStatesOverrides);
+
+    int run() const;
+
+    const QVector<double> & constants() const;
+    const QVector<double> & states() const;
+    const QMap<int, double> & statesOverrides() const;
+
+private:
+    int mRun;
+
+    QVector<double> mConstants;
+    QVector<double> mStates;
+    QMap<int, double> mStatesOverrides;
+};
+
+//==============================================================================
+
+using SimulationEnsembleMembers = QList<SimulationEnsembleMember>;
+
+//==============================================================================
+
+class SimulationEnsembleWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SimulationEnsembleWorker(Simulation *pSimulation,
+                                      const SimulationEnsembleMembers &pMembers,
+                                      Solver::OdeSolver::ComputeRatesFunction pComputeRatesBatch,
+                                      QAtomicInt *pNextMember,
+                                      const QAtomicInt *pStopped);
+
+private:
+    Simulation *mSimulation;
+
+    CellMLSupport::CellmlFileRuntime *mRuntime;
+
+    SolverInterface *mOdeSolverInterface;
+    SolverInterface *mNlaSolverInterface;
+
+    Solver::Solver::Properties mOdeSolverProperties;
+    Solver::Solver::Properties mNlaSolverProperties;
+
+    double mStartingPoint;
+    double mEndingPoint;
+    double mPointInterval;
+
+    Solver::OdeSolver::StatesDependencies mStatesDependencies;
+
+    SimulationEnsembleMembers mMembers;
+
+    Solver::OdeSolver::ComputeRatesFunction mComputeRatesBatch;
+
+    QAtomicInt *mNextMember;
+    const QAtomicInt *mStopped;
+
+    bool mError = false;
+
+    void initializeMember(const SimulationEnsembleMember &pMember,
+                          double *pConstants, double *pRates, double *pStates,
+                          double *pAlgebraic);
+
+    bool runMember(const SimulationEnsembleMember &pMember, double *pConstants,
+                   double *pRates, double *pStates, double *pAlgebraic);
+
+    void addMembersPoint(double pPoint, int pFirstMember, int pMembersCount,
+                         bool pRecomputeVariables, double *pConstants,
+                         double *pRates, double *pStates, double *pAlgebraic,
+                         const double *pBatchConstants,
+                         const double *pBatchRates,
+                         const double *pBatchStates,
+                         const double *pBatchAlgebraic);
+    bool runMembers(int pFirstMember, double *pConstants, double *pRates,
+                    double *pStates, double *pAlgebraic,
+                    double *pBatchConstants, double *pBatchRates,
+                    double *pBatchStates, double *pBatchAlgebraic);
+
+signals:
+    void done();
+
+    void error(const QString &pMessage);
+
+public slots:
+    void run();
+
+private slots:
+    void emitError(const QString &pMessage);
+};
+
+//==============================================================================
+
+} // namespace SimulationSupport
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -35,6 +35,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 #include <QApplication>
 #include <QFileInfo>
+#include <QSet>
 #include <QWidget>
 
 //==============================================================================
@@ -324,6 +325,135 @@ bool SimulationSupportPythonWrapper::run(Simulation *pSimulation)
 
 //==============================================================================
 
+bool SimulationSupportPythonWrapper::run_ensemble(Simulation *pSimulation,
+                                                  PyObject *pValuesList,
+                                                  int pThreadsCount)
+{
+    // Run an ensemble of simulations, i.e. one simulation for each dictionary
+    // of constants and/or states values in the given list, but only if it
+    // doesn't have blocking issues and if it is valid
+
+    if (pSimulation->hasBlockingIssues()) {
+        throw std::runtime_error(tr("The simulation has blocking issues and cannot therefore be run.").toStdString());
+    }
+
+    if (!valid(pSimulation)) {
+        throw std::runtime_error(tr("The simulation has an invalid runtime and cannot therefore be run.").toStdString());
+    }
+
+    if (pSimulation->isRunning()) {
+        throw std::runtime_error(tr("The simulation is already running.").toStdString());
+    }
+
+    // Retrieve the values of our ensemble members, making sure that they are
+    // for known constants and/or states
+
+    if ((pValuesList == nullptr) || (PyList_Check(pValuesList) == 0)) {
+        throw std::runtime_error(tr("The ensemble values must be a list of dictionaries.").toStdString());
+    }
+
+    if (PyList_Size(pValuesList) == 0) {
+        throw std::runtime_error(tr("The ensemble values must contain at least one dictionary.").toStdString());
+    }
+
+    QSet<QString> uris;
+    DataStore::DataStoreValues *constantsValues = pSimulation->data()->constantsValues();
+    DataStore::DataStoreValues *statesValues = pSimulation->data()->statesValues();
+
+    for (int i = 0, iMax = constantsValues->count(); i < iMax; ++i) {
+        uris << constantsValues->at(i)->uri();
+    }
+
+    for (int i = 0, iMax = statesValues->count(); i < iMax; ++i) {
+        uris << statesValues->at(i)->uri();
+    }
+
+    SimulationEnsembleValuesList valuesList;
+
+    for (Py_ssize_t i = 0, iMax = PyList_Size(pValuesList); i < iMax; ++i) {
+        PyObject *valuesDict = PyList_GetItem(pValuesList, i);
+
+        if (PyDict_Check(valuesDict) == 0) {
+            throw std::runtime_error(tr("The ensemble values must be a list of dictionaries.").toStdString());
+        }
+
+        SimulationEnsembleValues values;
+        PyObject *key = nullptr;
+        PyObject *value = nullptr;
+        Py_ssize_t position = 0;
+
+        while (PyDict_Next(valuesDict, &position, &key, &value) != 0) {
+            if ((PyUnicode_Check(key) == 0) || (PyNumber_Check(value) == 0)) {
+                throw std::runtime_error(tr("The ensemble values must map the URI of a constant or state to a number.").toStdString());
+            }
+
+            QString uri = QString::fromUtf8(PyUnicode_AsUTF8(key));
+
+            if (!uris.contains(uri)) {
+                throw std::runtime_error(tr("'%1' is not the URI of a constant or state.").arg(uri).toStdString());
+            }
+
+            values.insert(uri, PyFloat_AsDouble(value));
+        }
+
+        valuesList << values;
+    }
+
+    // Reset our internals
+
+    mElapsedTime = -1;
+    mErrorMessage = QString();
+
+    // Keep track of any simulation error and of when the simulation is done
+
+    QWidget *focusWidget = QApplication::focusWidget();
+
+    connect(pSimulation, &Simulation::error,
+            this, &SimulationSupportPythonWrapper::simulationError,
+            Qt::UniqueConnection);
+    connect(pSimulation, &Simulation::done,
+            this, &SimulationSupportPythonWrapper::simulationDone,
+            Qt::UniqueConnection);
+
+    // Run our ensemble and wait for it to complete
+    // Note #1: our simulation tries to allocate all the memory it needs before
+    //          running our ensemble...
+    // Note #2: our simulation will have emitted an error if its settings are
+    //          not sound, in which case we report it rather than a memory
+    //          allocation issue...
+
+    QEventLoop waitLoop;
+
+    connect(pSimulation, &Simulation::done,
+            &waitLoop, &QEventLoop::quit);
+
+    if (!pSimulation->runEnsemble(valuesList, pThreadsCount)) {
+        if (!mErrorMessage.isEmpty()) {
+            throw std::runtime_error(tr("The simulation could not be run (%1).").arg(mErrorMessage).toStdString());
+        }
+
+        throw std::runtime_error(tr("The memory required for the simulation could not be allocated.").toStdString());
+    }
+
+    waitLoop.exec();
+
+    // Throw any error message that has been generated
+
+    if (!mErrorMessage.isEmpty()) {
+        throw std::runtime_error(mErrorMessage.toStdString());
+    }
+
+    // Restore the focus to the previous widget
+
+    if (focusWidget != nullptr) {
+        focusWidget->setFocus();
+    }
+
+    return mElapsedTime >= 0;
+}
+
+//==============================================================================
+
 void SimulationSupportPythonWrapper::reset(Simulation *pSimulation, bool pAll)
 {
     // Reset the given simulation
@@ -549,6 +679,61 @@ PyObject * SimulationSupportPythonWrapper::algebraic(SimulationData *pSimulation
 
 //==============================================================================
 
+QStringList SimulationSupportPythonWrapper::sensitivity_parameters(SimulationData *pSimulationData) const
+{
+    // Return the URI of the constants with respect to which the sensitivities
+    // of the states are computed for the given simulation data
+
+    QStringList res;
+    DataStore::DataStoreValues *constantsValues = pSimulationData->constantsValues();
+    const QVector<int> sensitivityParameters = pSimulationData->sensitivityParameters();
+
+    for (auto sensitivityParameter : sensitivityParameters) {
+        res << constantsValues->at(sensitivityParameter)->uri();
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+void SimulationSupportPythonWrapper::set_sensitivity_parameters(SimulationData *pSimulationData,
+                                                                const QStringList &pSensitivityParameters)
+{
+    // Set the URI of the constants with respect to which the sensitivities of
+    // the states are to be computed for the given simulation data, making sure
+    // that they are valid and that the simulation is not running
+    // Note: this resets the states and the results of the simulation since
+    //       they need to account for the new sensitivities...
+
+    QStringList constants;
+    DataStore::DataStoreValues *constantsValues = pSimulationData->constantsValues();
+
+    if (constantsValues != nullptr) {
+        for (auto constantValue : *constantsValues) {
+            constants << constantValue->uri();
+        }
+    }
+
+    QVector<int> sensitivityParameters;
+
+    for (const auto &sensitivityParameter : pSensitivityParameters) {
+        int index = constants.indexOf(sensitivityParameter);
+
+        if (index == -1) {
+            throw std::runtime_error(tr("'%1' is not a valid constant.").arg(sensitivityParameter).toStdString());
+        }
+
+        sensitivityParameters << index;
+    }
+
+    if (!pSimulationData->setSensitivityParameters(sensitivityParameters)) {
+        throw std::runtime_error(tr("The sensitivity parameters cannot be set while the simulation is running.").toStdString());
+    }
+}
+
+//==============================================================================
+
 DataStore::DataStore * SimulationSupportPythonWrapper::data_store(SimulationResults *pSimulationResults) const
 {
     // Return the data store for the given simulation results
@@ -603,6 +788,51 @@ PyObject * SimulationSupportPythonWrapper::algebraic(SimulationResults *pSimulat
 
 //==============================================================================
 
+PyObject * SimulationSupportPythonWrapper::sensitivities(SimulationResults *pSimulationResults) const
+{
+    // Return the sensitivities variables for the given simulation results
+
+    return DataStore::DataStorePythonWrapper::dataStoreVariablesDict(pSimulationResults->sensitivitiesVariables());
+}
+
+//==============================================================================
+
+QStringList SimulationSupportPythonWrapper::recorded_variables(SimulationResults *pSimulationResults) const
+{
+    // Return the URI of the variables recorded by the given simulation results
+
+    return pSimulationResults->recordedVariables();
+}
+
+//==============================================================================
+
+void SimulationSupportPythonWrapper::set_recorded_variables(SimulationResults *pSimulationResults,
+                                                            const QStringList &pRecordedVariables)
+{
+    // Set the URI of the variables to be recorded by the given simulation
+    // results, making sure that they are valid
+
+    QStringList validVariables;
+    const DataStore::DataStoreVariables variables = pSimulationResults->constantsVariables()
+                                                   +pSimulationResults->ratesVariables()
+                                                   +pSimulationResults->statesVariables()
+                                                   +pSimulationResults->algebraicVariables();
+
+    for (auto variable : variables) {
+        validVariables << variable->uri();
+    }
+
+    for (const auto &recordedVariable : pRecordedVariables) {
+        if (!validVariables.contains(recordedVariable)) {
+            throw std::runtime_error(tr("'%1' is not a valid variable.").arg(recordedVariable).toStdString());
+        }
+    }
+
+    pSimulationResults->setRecordedVariables(pRecordedVariables);
+}
+
+//==============================================================================
+
 void SimulationSupportPythonWrapper::set_value(DataStore::DataStoreValue *pDataStoreValue,
                                                double pValue)
 {
@@ -72,6 +72,8 @@ public slots:
     bool valid(OpenCOR::SimulationSupport::Simulation *pSimulation);
 
     bool run(OpenCOR::SimulationSupport::Simulation *pSimulation);
+    bool run_ensemble(OpenCOR::SimulationSupport::Simulation *pSimulation,
+                      PyObject *pValuesList, int pThreadsCount = 0);
 
     void reset(OpenCOR::SimulationSupport::Simulation *pSimulation,
                bool pAll = true);
@@ -114,6 +116,10 @@ public slots:
     PyObject * states(OpenCOR::SimulationSupport::SimulationData *pSimulationData) const;
     PyObject * algebraic(OpenCOR::SimulationSupport::SimulationData *pSimulationData) const;
 
+    QStringList sensitivity_parameters(OpenCOR::SimulationSupport::SimulationData *pSimulationData) const;
+    void set_sensitivity_parameters(OpenCOR::SimulationSupport::SimulationData *pSimulationData,
+                                    const QStringList &pSensitivityParameters);
+
     OpenCOR::DataStore::DataStore * data_store(OpenCOR::SimulationSupport::SimulationResults *pSimulationResults) const;
 
     OpenCOR::DataStore::DataStoreVariable * voi(OpenCOR::SimulationSupport::SimulationResults *pSimulationResults) const;
@@ -122,6 +128,11 @@ public slots:
     PyObject * states(OpenCOR::SimulationSupport::SimulationResults *pSimulationResults) const;
     PyObject * rates(OpenCOR::SimulationSupport::SimulationResults *pSimulationResults) const;
     PyObject * algebraic(OpenCOR::SimulationSupport::SimulationResults *pSimulationResults) const;
+    PyObject * sensitivities(OpenCOR::SimulationSupport::SimulationResults *pSimulationResults) const;
+
+    QStringList recorded_variables(OpenCOR::SimulationSupport::SimulationResults *pSimulationResults) const;
+    void set_recorded_variables(OpenCOR::SimulationSupport::SimulationResults *pSimulationResults,
+                                const QStringList &pRecordedVariables);
 
     void set_value(OpenCOR::DataStore::DataStoreValue *pDataStoreValue,
                    double pValue);
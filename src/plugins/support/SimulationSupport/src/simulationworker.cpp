@@ -54,7 +54,7 @@ bool SimulationWorker::isRunning() const
 {
     // Return whether our thread is running
 
-    return mThread->isRunning() && !mPaused;
+    return mThread->isRunning() && (mPaused.loadAcquire() == 0);
 }
 
 //==============================================================================
@@ -63,7 +63,7 @@ bool SimulationWorker::isPaused() const
 {
     // Return whether our thread is paused
 
-    return mThread->isRunning() && mPaused;
+    return mThread->isRunning() && (mPaused.loadAcquire() != 0);
 }
 
 //==============================================================================
@@ -96,12 +96,16 @@ void SimulationWorker::run()
     if (mRuntime->needNlaSolver()) {
         nlaSolver = static_cast<Solver::NlaSolver *>(mSimulation->data()->nlaSolverInterface()->solverInstance());
 
-        Solver::setNlaSolver(mRuntime, nlaSolver);
+        mRuntime->nlaSolverContext()->setNlaSolver(nlaSolver);
     }
 
     // Keep track of any error that might be reported by any of our solvers
+    // Note: our paused, stopped and reset flags are set from the GUI thread
+    //       while we are running in our own thread, hence they are atomic
+    //       (rather than plain booleans), and without needing a lock, which
+    //       would otherwise slow down our main work loop...
 
-    mStopped = false;
+    mStopped.storeRelease(0);
     mError = false;
 
     connect(odeSolver, &Solver::OdeSolver::error,
@@ -124,6 +128,24 @@ void SimulationWorker::run()
     // Initialise our ODE solver
 
     odeSolver->setProperties(mSimulation->data()->odeSolverProperties());
+    odeSolver->setStatesDependencies(mRuntime->statesDependencies());
+    odeSolver->setRootsFunction(mRuntime->rootsCount(),
+                                mRuntime->computeRoots());
+
+    // Ask our ODE solver to compute the sensitivities of our states with
+    // respect to some of our constants, if requested and if it can
+
+    QVector<int> sensitivityParameters = mSimulation->data()->sensitivityParameters();
+
+    if (!sensitivityParameters.isEmpty()) {
+        if (odeSolver->supportsSensitivities()) {
+            odeSolver->setSensitivities(sensitivityParameters,
+                                        mSimulation->data()->sensitivities(),
+                                        mRuntime->computeComputedConstants());
+        } else {
+            emitError(tr("the ODE solver does not support sensitivity analysis"));
+        }
+    }
 
     odeSolver->initialize(mCurrentPoint, mRuntime->statesCount(),
                           mSimulation->data()->constants(),
@@ -148,8 +170,10 @@ void SimulationWorker::run()
         // Start our timer
 
         QElapsedTimer timer;
+        QElapsedTimer variablesTimer;
 
         timer.start();
+        variablesTimer.start();
 
         // Add our first point
 
@@ -165,15 +189,19 @@ void SimulationWorker::run()
         QMutex pausedMutex;
 
         forever {
-            // Reinitialise our solver, if we have an NLA solver or if the model
-            // got reset
-            // Note: indeed, with a solver such as CVODE, we need to update our
-            //       internals...
-
-            if ((nlaSolver != nullptr) || mReset) {
+            // Reinitialise our solver, but only if the model got reset, i.e.
+            // if our states were changed from outside of our solver
+            // Note #1: indeed, our solver advances through time on its own
+            //          schedule, interpolating our states at our output points
+            //          if needed, so reinitialising it for no reason would only
+            //          throw away its history (e.g. CVODE's step size and
+            //          order)...
+            // Note #2: we check and clear our reset flag in one go, so that we
+            //          cannot miss a reset that would be requested in
+            //          between...
+
+            if (mReset.fetchAndStoreOrdered(0) != 0) {
                 odeSolver->reinitialize(mCurrentPoint);
-
-                mReset = false;
             }
 
             // Determine our next point and compute our model up to it
@@ -188,32 +216,67 @@ void SimulationWorker::run()
                 break;
             }
 
-            // Add our new point
+            // Add our new point, after having recomputed our rates and
+            // algebraic variables if our results don't need them (see
+            // SimulationResults::addPoint()) and if they haven't been
+            // recomputed for a while, so that the GUI can still show them
+            // Note: our data store only makes our new points visible once it
+            //       has flushed them (see DataStore::addValues()),
+            //       so we also have it flush them every now and then...
+
+            bool refreshVariables = variablesTimer.elapsed() >= VariablesRefreshInterval;
+
+            if (   refreshVariables
+                && !mSimulation->results()->needRecomputeVariables()) {
+                mSimulation->data()->recomputeVariables(mCurrentPoint);
+            }
 
             mSimulation->results()->addPoint(mCurrentPoint);
 
+            if (refreshVariables) {
+                mSimulation->results()->dataStore()->flushValues();
+
+                variablesTimer.restart();
+            }
+
             // Some post-processing, if needed
 
-            if (qFuzzyCompare(mCurrentPoint, endingPoint) || mStopped) {
+            if (qFuzzyCompare(mCurrentPoint, endingPoint) || (mStopped.loadAcquire() != 0)) {
                 // We have reached our ending point or we have been asked to
                 // stop, so leave our main work loop
 
                 break;
             }
 
-            // Delay things a bit, if needed
+            // Delay things a bit, if needed, after having flushed our new
+            // point(s) so that they can be seen while we are delaying things
 
             if (mSimulation->delay() != nullptr) {
+                if (*mSimulation->delay() != 0) {
+                    mSimulation->results()->dataStore()->flushValues();
+                }
+
                 Core::doNothing(mSimulation->delay(), &mStopped);
             }
 
             // Pause ourselves, if needed
 
-            if (mPaused) {
+            if (mPaused.loadAcquire() != 0) {
                 // We should be paused, so stop our timer
 
                 elapsedTime += timer.elapsed();
 
+                // Make sure that our rates and algebraic variables are up to
+                // date since our results may not need them (see
+                // SimulationResults::addPoint()) while the GUI may show them
+
+                mSimulation->data()->recomputeVariables(mCurrentPoint);
+
+                // Flush our new point(s), so that they can be seen while we
+                // are paused
+
+                mSimulation->results()->dataStore()->flushValues();
+
                 // Let people know that we are paused
 
                 emit paused();
@@ -226,7 +289,7 @@ void SimulationWorker::run()
 
                 // We are not paused anymore
 
-                mPaused = false;
+                mPaused.storeRelease(0);
 
                 // Let people know that we are running again
 
@@ -238,10 +301,18 @@ void SimulationWorker::run()
             }
         }
 
-        // Retrieve the total elapsed time, should no error have occurred
+        // Flush our remaining point(s)
+
+        mSimulation->results()->dataStore()->flushValues();
+
+        // Retrieve the total elapsed time, should no error have occurred, and
+        // make sure that our rates and algebraic variables are up to date (see
+        // above)
 
         if (!mError) {
             elapsedTime += timer.elapsed();
+
+            mSimulation->data()->recomputeVariables(mCurrentPoint);
         }
     }
 
@@ -250,6 +321,10 @@ void SimulationWorker::run()
     delete odeSolver;
 
     if (nlaSolver != nullptr) {
+        mSimulation->setNlaSolverStatistics(nlaSolver->statistics());
+
+        mRuntime->nlaSolverContext()->setNlaSolver(nullptr);
+
         delete nlaSolver;
     }
 
@@ -272,7 +347,7 @@ void SimulationWorker::pause()
     // Pause ourselves, if we are currently running
 
     if (isRunning()) {
-        mPaused = true;
+        mPaused.storeRelease(1);
     }
 }
 
@@ -294,7 +369,7 @@ void SimulationWorker::stop()
     // Stop ourselves, if we are currently running or paused
 
     if (isRunning() || isPaused()) {
-        mStopped = true;
+        mStopped.storeRelease(1);
 
         if (isPaused()) {
             mPausedCondition.wakeOne();
@@ -309,7 +384,7 @@ void SimulationWorker::reset()
     // Stop ourselves, if we are currently running or paused
 
     if (isRunning() || isPaused()) {
-        mReset = true;
+        mReset.storeRelease(1);
     }
 }
 
@@ -25,6 +25,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QAtomicInt>
 #include <QObject>
 #include <QWaitCondition>
 
@@ -76,10 +77,10 @@ private:
 
     double mCurrentPoint = 0.0;
 
-    bool mPaused = false;
-    bool mStopped = false;
+    QAtomicInt mPaused = 0;
+    QAtomicInt mStopped = 0;
 
-    bool mReset = false;
+    QAtomicInt mReset = 0;
 
     QWaitCondition mPausedCondition;
 
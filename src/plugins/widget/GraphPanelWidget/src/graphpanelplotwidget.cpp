@@ -42,7 +42,9 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <algorithm>
 #include <cfloat>
+#include <cmath>
 
 //==============================================================================
 
@@ -184,6 +186,10 @@ QColor GraphPanelPlotGraphProperties::symbolFillColor() const
 
 //==============================================================================
 
+static const QRectF InvalidRect = QRectF(0.0, 0.0, -1.0, -1.0);
+
+//==============================================================================
+
 GraphPanelPlotGraphRun::GraphPanelPlotGraphRun(GraphPanelPlotGraph *pOwner) :
     mOwner(pOwner)
 {
@@ -225,6 +231,42 @@ void GraphPanelPlotGraphRun::setRawSamples(const double *pDataX,
     for (int i = mSize; i < pSize; ++i) {
         if (   !qIsInf(pDataX[i]) && !qIsNaN(pDataX[i])
             && !qIsInf(pDataY[i]) && !qIsNaN(pDataY[i])) {
+            // Keep track of whether our valid X values are monotonic, since we
+            // can only decimate our lines if they are (see
+            // drawDecimatedLines())
+
+            mMonotonicDataX = mMonotonicDataX && (pDataX[i] >= mLastValidDataX);
+            mLastValidDataX = pDataX[i];
+
+            // Extend our bounding rectangles, so that only our new samples
+            // need to be considered
+
+            if (mHasBoundingRect) {
+                mMinX = qMin(mMinX, pDataX[i]);
+                mMaxX = qMax(mMaxX, pDataX[i]);
+                mMinY = qMin(mMinY, pDataY[i]);
+                mMaxY = qMax(mMaxY, pDataY[i]);
+            } else {
+                mMinX = mMaxX = pDataX[i];
+                mMinY = mMaxY = pDataY[i];
+
+                mHasBoundingRect = true;
+            }
+
+            if ((pDataX[i] > 0.0) && (pDataY[i] > 0.0)) {
+                if (mHasBoundingLogRect) {
+                    mMinLogX = qMin(mMinLogX, pDataX[i]);
+                    mMaxLogX = qMax(mMaxLogX, pDataX[i]);
+                    mMinLogY = qMin(mMinLogY, pDataY[i]);
+                    mMaxLogY = qMax(mMaxLogY, pDataY[i]);
+                } else {
+                    mMinLogX = mMaxLogX = pDataX[i];
+                    mMinLogY = mMaxLogY = pDataY[i];
+
+                    mHasBoundingLogRect = true;
+                }
+            }
+
             if (validData == EmptyData) {
                 validData.first = i;
                 validData.second = i;
@@ -243,6 +285,11 @@ void GraphPanelPlotGraphRun::setRawSamples(const double *pDataX,
         mValidData << validData;
     }
 
+    mDataX = pDataX;
+    mDataY = pDataY;
+
+    mDecimator.setRawSamples(pDataX, pDataY, pSize);
+
     mSize = pSize;
 
     QwtPlotCurve::setRawSamples(pDataX, pDataY, pSize);
@@ -250,6 +297,281 @@ void GraphPanelPlotGraphRun::setRawSamples(const double *pDataX,
 
 //==============================================================================
 
+QRectF GraphPanelPlotGraphRun::boundingRect() const
+{
+    // Return our bounding rectangle, i.e. the one that contains all our valid
+    // samples
+
+    return mHasBoundingRect?
+               QRectF(mMinX, mMinY, mMaxX-mMinX, mMaxY-mMinY):
+               InvalidRect;
+}
+
+//==============================================================================
+
+QRectF GraphPanelPlotGraphRun::boundingLogRect() const
+{
+    // Return our bounding log rectangle, i.e. the one that contains all our
+    // valid samples that have strictly positive coordinates
+
+    return mHasBoundingLogRect?
+               QRectF(mMinLogX, mMinLogY, mMaxLogX-mMinLogX, mMaxLogY-mMinLogY):
+               InvalidRect;
+}
+
+//==============================================================================
+
+static const int LevelBlockSize = 16;
+
+//==============================================================================
+
+void GraphPanelPlotGraphRunDecimator::setRawSamples(const double *pDataX,
+                                                    const double *pDataY,
+                                                    int pSize)
+{
+    // Keep track of the given raw samples and update our levels of detail,
+    // i.e. a pyramid where each level keeps track, for each block of
+    // LevelBlockSize elements of the level below it (or of our raw samples, for
+    // our first level), of the index of the sample with the minimum Y value
+    // and of the index of the sample with the maximum Y value
+    // Note #1: only the blocks that contain new samples (i.e. the last block of
+    //          each level, which may have been partial, and the ones after it)
+    //          need to be updated, meaning that the cost of an update is
+    //          proportional to the number of new samples...
+    // Note #2: a block that contains invalid samples is never used in its
+    //          entirety (see minimumMaximumIndexes()), so we don't need to
+    //          worry about those samples...
+
+    mDataX = pDataX;
+    mDataY = pDataY;
+
+    int elementsCount = pSize;
+    int firstElement = mSize;
+
+    for (int level = 0; elementsCount > LevelBlockSize; ++level) {
+        if (level == mMinimumIndexes.count()) {
+            mMinimumIndexes << QVector<int>();
+            mMaximumIndexes << QVector<int>();
+        }
+
+        // Note: a level may have fewer blocks than it should have, if it has
+        //       just been created (i.e. there were previously too few elements
+        //       to need it), in which case we need to compute its missing
+        //       blocks too...
+
+        QVector<int> &minimumIndexes = mMinimumIndexes[level];
+        QVector<int> &maximumIndexes = mMaximumIndexes[level];
+        int blocksCount = (elementsCount+LevelBlockSize-1)/LevelBlockSize;
+        int firstBlock = qMin(firstElement/LevelBlockSize, minimumIndexes.count());
+
+        minimumIndexes.resize(blocksCount);
+        maximumIndexes.resize(blocksCount);
+
+        for (int block = firstBlock; block < blocksCount; ++block) {
+            int from = block*LevelBlockSize;
+            int to = qMin(from+LevelBlockSize, elementsCount);
+            int minimumIndex = (level == 0)?from:mMinimumIndexes[level-1][from];
+            int maximumIndex = (level == 0)?from:mMaximumIndexes[level-1][from];
+
+            for (int element = from+1; element < to; ++element) {
+                int elementMinimumIndex = (level == 0)?element:mMinimumIndexes[level-1][element];
+                int elementMaximumIndex = (level == 0)?element:mMaximumIndexes[level-1][element];
+
+                if (mDataY[elementMinimumIndex] < mDataY[minimumIndex]) {
+                    minimumIndex = elementMinimumIndex;
+                }
+
+                if (mDataY[elementMaximumIndex] > mDataY[maximumIndex]) {
+                    maximumIndex = elementMaximumIndex;
+                }
+            }
+
+            minimumIndexes[block] = minimumIndex;
+            maximumIndexes[block] = maximumIndex;
+        }
+
+        elementsCount = blocksCount;
+        firstElement = firstBlock;
+    }
+
+    mSize = pSize;
+}
+
+//==============================================================================
+
+void GraphPanelPlotGraphRunDecimator::minimumMaximumIndexes(int pFrom, int pTo,
+                                                            int &pMinimumIndex,
+                                                            int &pMaximumIndex) const
+{
+    // Determine the index of the sample with the minimum Y value and the index
+    // of the sample with the maximum Y value between the given indexes
+    // (inclusive), using our raw samples for the unaligned ends of the given
+    // range and our levels of detail for the rest of it
+
+    pMinimumIndex = pFrom;
+    pMaximumIndex = pFrom;
+
+    int level = -1;
+    int from = pFrom;
+    int to = pTo+1;
+
+    forever {
+        int alignedFrom = LevelBlockSize*((from+LevelBlockSize-1)/LevelBlockSize);
+        int alignedTo = LevelBlockSize*(to/LevelBlockSize);
+        bool lastLevel =    (level+1 == mMinimumIndexes.count())
+                         || (alignedFrom >= alignedTo);
+
+        for (int element = from; element < to; ++element) {
+            if (!lastLevel && (element == alignedFrom)) {
+                element = alignedTo-1;
+
+                continue;
+            }
+
+            int minimumIndex = (level == -1)?element:mMinimumIndexes[level][element];
+            int maximumIndex = (level == -1)?element:mMaximumIndexes[level][element];
+
+            if (mDataY[minimumIndex] < mDataY[pMinimumIndex]) {
+                pMinimumIndex = minimumIndex;
+            }
+
+            if (mDataY[maximumIndex] > mDataY[pMaximumIndex]) {
+                pMaximumIndex = maximumIndex;
+            }
+        }
+
+        if (lastLevel) {
+            return;
+        }
+
+        from = alignedFrom/LevelBlockSize;
+        to = alignedTo/LevelBlockSize;
+
+        ++level;
+    }
+}
+
+//==============================================================================
+
+QVector<int> GraphPanelPlotGraphRunDecimator::indexes(const QwtScaleMap &pMapX,
+                                                      int pFrom, int pTo) const
+{
+    // Return the indexes of the samples, between the given indexes
+    // (inclusive), that are needed to draw our lines using the given X scale
+    // map, i.e. for each pixel column, the first and last samples, as well as
+    // the ones with the minimum and maximum Y values (M4 aggregation)
+    // Note: our X values are expected to be monotonic...
+
+    QVector<int> res;
+
+    res.reserve(4*(int(pMapX.pDist())+3));
+
+    auto addIndex = [&](int pIndex) {
+        if (res.isEmpty() || (pIndex != res.last())) {
+            res << pIndex;
+        }
+    };
+
+    for (int i = pFrom; i <= pTo;) {
+        // Determine the last sample that is in the same pixel column as the
+        // current one
+
+        double nextColumn = std::floor(pMapX.transform(mDataX[i]))+1.0;
+        int j = i;
+        int jMax = pTo;
+
+        while (j < jMax) {
+            int jMid = j+(jMax-j+1)/2;
+
+            if (pMapX.transform(mDataX[jMid]) < nextColumn) {
+                j = jMid;
+            } else {
+                jMax = jMid-1;
+            }
+        }
+
+        // Add the first, minimum, maximum and last samples of our pixel column
+
+        int minimumIndex;
+        int maximumIndex;
+
+        minimumMaximumIndexes(i, j, minimumIndex, maximumIndex);
+
+        addIndex(i);
+        addIndex(qMin(minimumIndex, maximumIndex));
+        addIndex(qMax(minimumIndex, maximumIndex));
+        addIndex(j);
+
+        i = j+1;
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+bool GraphPanelPlotGraphRun::drawDecimatedLines(QPainter *pPainter,
+                                                const QwtScaleMap &pMapX,
+                                                const QwtScaleMap &pMapY,
+                                                const QRectF &pCanvasRect,
+                                                int pFrom, int pTo) const
+{
+    // Make sure that we can decimate our lines, i.e. that our X values are
+    // monotonic and that we are to draw plain lines along an X axis that is
+    // not inverted
+
+    if (   !mMonotonicDataX
+        ||  (style() != Lines) || testCurveAttribute(Fitted)
+        ||  (brush().style() != Qt::NoBrush)
+        ||  (pMapX.p1() >= pMapX.p2()) || (pMapX.s1() >= pMapX.s2())) {
+        return false;
+    }
+
+    // Only consider the samples that are visible, as well as the one before
+    // and the one after them, so that lines that go out of view still get
+    // drawn
+
+    int from = qMax(pFrom, int(std::lower_bound(mDataX+pFrom, mDataX+pTo+1, pMapX.s1())-mDataX)-1);
+    int to = qMin(pTo, int(std::upper_bound(mDataX+pFrom, mDataX+pTo+1, pMapX.s2())-mDataX));
+
+    // Draw our lines as is, if there are only a few samples per pixel, or
+    // decimate them otherwise
+    // Note: to decimate our lines, we keep, for each pixel column, the first
+    //       and last samples, as well as the ones with the minimum and maximum
+    //       Y values (i.e. M4 aggregation), which results in the same pixels
+    //       being drawn...
+
+    if (to-from+1 <= 4*int(pMapX.pDist())) {
+        QwtPlotCurve::drawLines(pPainter, pMapX, pMapY, pCanvasRect, from, to);
+
+        return true;
+    }
+
+    bool doAlign = QwtPainter::roundingAlignment(pPainter);
+    QVector<int> indexes = mDecimator.indexes(pMapX, from, to);
+    QPolygonF polyline;
+
+    polyline.reserve(indexes.count());
+
+    for (auto index : indexes) {
+        double x = pMapX.transform(mDataX[index]);
+        double y = pMapY.transform(mDataY[index]);
+
+        if (doAlign) {
+            x = qRound(x);
+            y = qRound(y);
+        }
+
+        polyline << QPointF(x, y);
+    }
+
+    QwtPainter::drawPolyline(pPainter, polyline);
+
+    return true;
+}
+
+//==============================================================================
+
 void GraphPanelPlotGraphRun::drawLines(QPainter *pPainter,
                                        const QwtScaleMap &pMapX,
                                        const QwtScaleMap &pMapY,
@@ -269,8 +591,11 @@ void GraphPanelPlotGraphRun::drawLines(QPainter *pPainter,
                          pTo:
                          validData.second;
 
-            QwtPlotCurve::drawLines(pPainter, pMapX, pMapY,
-                                    pCanvasRect, from, to);
+            if (!drawDecimatedLines(pPainter, pMapX, pMapY, pCanvasRect,
+                                    from, to)) {
+                QwtPlotCurve::drawLines(pPainter, pMapX, pMapY,
+                                        pCanvasRect, from, to);
+            }
         }
     }
 }
@@ -303,9 +628,6 @@ void GraphPanelPlotGraphRun::drawSymbols(QPainter *pPainter,
     }
 }
 
-//==============================================================================
-
-static const QRectF InvalidRect = QRectF(0.0, 0.0, -1.0, -1.0);
 
 //==============================================================================
 
@@ -451,6 +773,11 @@ void GraphPanelPlotGraph::removeRuns()
     }
 
     mRuns.clear();
+
+    // Reset the cached version of our bounding rectangles
+
+    mBoundingRect = InvalidRect;
+    mBoundingLogRect = InvalidRect;
 }
 
 //==============================================================================
@@ -725,12 +1052,12 @@ void GraphPanelPlotGraph::setData(double *pDataX, double *pDataY, quint64 pSize,
     run->setRawSamples(pDataX, pDataY, int(pSize));
 
     // Reset the cached version of our bounding rectangles
+    // Note: our run keeps track of its own bounding rectangles, which it
+    //       extends with the new samples, so recomputing ours only means
+    //       combining those of our runs...
 
     mBoundingRect = InvalidRect;
     mBoundingLogRect = InvalidRect;
-
-    mBoundingRects.remove(run);
-    mBoundingLogRects.remove(run);
 }
 
 //==============================================================================
@@ -744,68 +1071,10 @@ QRectF GraphPanelPlotGraph::boundingRect()
         mBoundingRect = QRectF();
 
         for (auto run : qAsConst(mRuns)) {
-            if (run->dataSize() != 0) {
-                QRectF boundingRect = mBoundingRects.value(run, InvalidRect);
-
-                if (boundingRect == InvalidRect) {
-                    bool needInitMinX = true;
-                    bool needInitMaxX = true;
-                    bool needInitMinY = true;
-                    bool needInitMaxY = true;
-                    double minX = 1.0;
-                    double maxX = 1.0;
-                    double minY = 1.0;
-                    double maxY = 1.0;
-
-                    for (size_t i = 0, iMax = run->dataSize(); i < iMax; ++i) {
-                        QPointF sample = run->data()->sample(i);
-
-                        if (   !qIsInf(sample.x()) && !qIsNaN(sample.x())
-                            && !qIsInf(sample.y()) && !qIsNaN(sample.y())) {
-                            if (needInitMinX) {
-                                minX = sample.x();
-
-                                needInitMinX = false;
-                            } else if (sample.x() < minX) {
-                                minX = sample.x();
-                            }
-
-                            if (needInitMaxX) {
-                                maxX = sample.x();
-
-                                needInitMaxX = false;
-                            } else if (sample.x() > maxX) {
-                                maxX = sample.x();
-                            }
-
-                            if (needInitMinY) {
-                                minY = sample.y();
-
-                                needInitMinY = false;
-                            } else if (sample.y() < minY) {
-                                minY = sample.y();
-                            }
-
-                            if (needInitMaxY) {
-                                maxY = sample.y();
-
-                                needInitMaxY = false;
-                            } else if (sample.y() > maxY) {
-                                maxY = sample.y();
-                            }
-                        }
-                    }
-
-                    if (!needInitMinX && !needInitMaxX && !needInitMinY && !needInitMaxY) {
-                        boundingRect = QRectF(minX, minY, maxX-minX, maxY-minY);
-
-                        mBoundingRects.insert(run, boundingRect);
-                    }
-                }
+            QRectF boundingRect = run->boundingRect();
 
-                if (boundingRect != InvalidRect) {
-                    mBoundingRect |= boundingRect;
-                }
+            if (boundingRect != InvalidRect) {
+                mBoundingRect |= boundingRect;
             }
         }
     }
@@ -815,6 +1084,23 @@ QRectF GraphPanelPlotGraph::boundingRect()
 
 //==============================================================================
 
+QRectF GraphPanelPlotGraph::boundingRect(int pRun) const
+{
+    // Return the bounding rectangle of the given run, if it exists
+
+    if (mRuns.isEmpty()) {
+        return InvalidRect;
+    }
+
+    if (pRun == -1) {
+        return mRuns.last()->boundingRect();
+    }
+
+    return ((pRun >= 0) && (pRun < mRuns.count()))?mRuns[pRun]->boundingRect():InvalidRect;
+}
+
+//==============================================================================
+
 QRectF GraphPanelPlotGraph::boundingLogRect()
 {
     // Return the cached version of our bounding log rectangle, if we have one,
@@ -824,70 +1110,10 @@ QRectF GraphPanelPlotGraph::boundingLogRect()
         mBoundingLogRect = QRectF();
 
         for (auto run : qAsConst(mRuns)) {
-            if (run->dataSize() != 0) {
-                QRectF boundingLogRect = mBoundingLogRects.value(run, InvalidRect);
-
-                if (boundingLogRect == InvalidRect) {
-                    bool needInitMinX = true;
-                    bool needInitMaxX = true;
-                    bool needInitMinY = true;
-                    bool needInitMaxY = true;
-                    double minX = 1.0;
-                    double maxX = 1.0;
-                    double minY = 1.0;
-                    double maxY = 1.0;
-
-                    for (size_t i = 0, iMax = run->dataSize(); i < iMax; ++i) {
-                        QPointF sample = run->data()->sample(i);
-
-                        if (   !qIsInf(sample.x()) && !qIsNaN(sample.x())
-                            &&  (sample.x() > 0.0)
-                            && !qIsInf(sample.y()) && !qIsNaN(sample.y())
-                            &&  (sample.y() > 0.0)) {
-                            if (needInitMinX) {
-                                minX = sample.x();
-
-                                needInitMinX = false;
-                            } else if (sample.x() < minX) {
-                                minX = sample.x();
-                            }
-
-                            if (needInitMaxX) {
-                                maxX = sample.x();
-
-                                needInitMaxX = false;
-                            } else if (sample.x() > maxX) {
-                                maxX = sample.x();
-                            }
-
-                            if (needInitMinY) {
-                                minY = sample.y();
-
-                                needInitMinY = false;
-                            } else if (sample.y() < minY) {
-                                minY = sample.y();
-                            }
-
-                            if (needInitMaxY) {
-                                maxY = sample.y();
-
-                                needInitMaxY = false;
-                            } else if (sample.y() > maxY) {
-                                maxY = sample.y();
-                            }
-                        }
-                    }
+            QRectF boundingLogRect = run->boundingLogRect();
 
-                    if (!needInitMinX && !needInitMaxX && !needInitMinY && !needInitMaxY) {
-                        boundingLogRect = QRectF(minX, minY, maxX-minX, maxY-minY);
-
-                        mBoundingLogRects.insert(run, boundingLogRect);
-                    }
-                }
-
-                if (boundingLogRect != InvalidRect) {
-                    mBoundingLogRect |= boundingLogRect;
-                }
+            if (boundingLogRect != InvalidRect) {
+                mBoundingLogRect |= boundingLogRect;
             }
         }
     }
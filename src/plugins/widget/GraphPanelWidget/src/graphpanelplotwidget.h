@@ -30,6 +30,11 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QtNumeric>
+#include <QVector>
+
+//==============================================================================
+
 #include "qwtbegin.h"
     #include "qwt_legend.h"
     #include "qwt_plot.h"
@@ -132,6 +137,28 @@ private:
 
 //==============================================================================
 
+class GraphPanelPlotGraphRunDecimator
+{
+public:
+    void setRawSamples(const double *pDataX, const double *pDataY, int pSize);
+
+    QVector<int> indexes(const QwtScaleMap &pMapX, int pFrom, int pTo) const;
+
+private:
+    const double *mDataX = nullptr;
+    const double *mDataY = nullptr;
+
+    int mSize = 0;
+
+    QVector<QVector<int>> mMinimumIndexes;
+    QVector<QVector<int>> mMaximumIndexes;
+
+    void minimumMaximumIndexes(int pFrom, int pTo, int &pMinimumIndex,
+                               int &pMaximumIndex) const;
+};
+
+//==============================================================================
+
 class GraphPanelPlotGraph;
 
 //==============================================================================
@@ -145,6 +172,9 @@ public:
 
     void setRawSamples(const double *pDataX, const double *pDataY, int pSize);
 
+    QRectF boundingRect() const override;
+    QRectF boundingLogRect() const;
+
 protected:
     void drawLines(QPainter *pPainter, const QwtScaleMap &pMapX,
                    const QwtScaleMap &pMapY, const QRectF &pCanvasRect,
@@ -156,8 +186,33 @@ protected:
 private:
     GraphPanelPlotGraph *mOwner;
 
+    const double *mDataX = nullptr;
+    const double *mDataY = nullptr;
+
     int mSize = 0;
     QList<QPair<int, int>> mValidData;
+
+    bool mHasBoundingRect = false;
+    double mMinX = 1.0;
+    double mMaxX = 1.0;
+    double mMinY = 1.0;
+    double mMaxY = 1.0;
+
+    bool mHasBoundingLogRect = false;
+    double mMinLogX = 1.0;
+    double mMaxLogX = 1.0;
+    double mMinLogY = 1.0;
+    double mMaxLogY = 1.0;
+
+    bool mMonotonicDataX = true;
+    double mLastValidDataX = -qInf();
+
+    GraphPanelPlotGraphRunDecimator mDecimator;
+
+    bool drawDecimatedLines(QPainter *pPainter, const QwtScaleMap &pMapX,
+                            const QwtScaleMap &pMapY,
+                            const QRectF &pCanvasRect, int pFrom,
+                            int pTo) const;
 };
 
 //==============================================================================
@@ -225,6 +280,7 @@ public:
     void setData(double *pDataX, double *pDataY, quint64 pSize, int pRun = -1);
 
     QRectF boundingRect();
+    QRectF boundingRect(int pRun) const;
     QRectF boundingLogRect();
 
 private:
@@ -238,10 +294,7 @@ private:
     QColor mColor;
 
     QRectF mBoundingRect;
-    QHash<GraphPanelPlotGraphRun *, QRectF> mBoundingRects;
-
     QRectF mBoundingLogRect;
-    QHash<GraphPanelPlotGraphRun *, QRectF> mBoundingLogRects;
 
     GraphPanelPlotWidget *mPlot = nullptr;
 
@@ -0,0 +1,181 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Graph panel widget tests
+//==============================================================================
+
+#include "graphpanelplotwidget.h"
+#include "tests.h"
+
+//==============================================================================
+
+#include <QRandomGenerator>
+#include <QtTest/QtTest>
+
+//==============================================================================
+
+#include <cmath>
+
+//==============================================================================
+
+#include "qwtbegin.h"
+    #include "qwt_scale_map.h"
+#include "qwtend.h"
+
+//==============================================================================
+
+static void checkDecimation(const OpenCOR::GraphPanelWidget::GraphPanelPlotGraphRunDecimator &pDecimator,
+                            const QVector<double> &pDataX,
+                            const QVector<double> &pDataY, int pFrom, int pTo,
+                            double pPaintFrom, double pPaintTo)
+{
+    // Decimate the given samples, mapping them to the given paint interval
+
+    QwtScaleMap mapX;
+
+    mapX.setPaintInterval(pPaintFrom, pPaintTo);
+    mapX.setScaleInterval(pDataX[pFrom], pDataX[pTo]);
+
+    QVector<int> indexes = pDecimator.indexes(mapX, pFrom, pTo);
+
+    // Make sure that our indexes are strictly increasing and within range
+
+    QVERIFY(!indexes.isEmpty());
+    QCOMPARE(indexes.first(), pFrom);
+    QCOMPARE(indexes.last(), pTo);
+
+    for (int i = 1, iMax = indexes.count(); i < iMax; ++i) {
+        QVERIFY(indexes[i] > indexes[i-1]);
+    }
+
+    // Make sure that, for each pixel column, the first and last samples, and
+    // the minimum and maximum Y values, are the same for our decimated samples
+    // as for all the samples, as determined by brute force
+
+    struct Column
+    {
+        int first;
+        int last;
+        double minimum;
+        double maximum;
+    };
+
+    auto columns = [&](const QVector<int> &pIndexes) {
+        QMap<int, Column> res;
+
+        for (auto index : pIndexes) {
+            int column = int(std::floor(mapX.transform(pDataX[index])));
+
+            if (res.contains(column)) {
+                Column &data = res[column];
+
+                data.last = index;
+                data.minimum = qMin(data.minimum, pDataY[index]);
+                data.maximum = qMax(data.maximum, pDataY[index]);
+            } else {
+                res.insert(column, { index, index, pDataY[index], pDataY[index] });
+            }
+        }
+
+        return res;
+    };
+
+    QVector<int> allIndexes;
+
+    for (int i = pFrom; i <= pTo; ++i) {
+        allIndexes << i;
+    }
+
+    QMap<int, Column> expectedColumns = columns(allIndexes);
+    QMap<int, Column> decimatedColumns = columns(indexes);
+
+    QCOMPARE(decimatedColumns.keys(), expectedColumns.keys());
+
+    for (auto column = expectedColumns.constBegin(), columnEnd = expectedColumns.constEnd();
+         column != columnEnd; ++column) {
+        const Column &expectedColumn = column.value();
+        const Column &decimatedColumn = decimatedColumns[column.key()];
+
+        QCOMPARE(decimatedColumn.first, expectedColumn.first);
+        QCOMPARE(decimatedColumn.last, expectedColumn.last);
+        QCOMPARE(decimatedColumn.minimum, expectedColumn.minimum);
+        QCOMPARE(decimatedColumn.maximum, expectedColumn.maximum);
+    }
+
+    // Make sure that we have at most four samples per pixel column
+
+    QVERIFY(indexes.count() <= 4*expectedColumns.count());
+}
+
+//==============================================================================
+
+void Tests::decimationTests()
+{
+    // Generate some noisy samples with monotonic, but irregular (and sometimes
+    // repeated), X values
+
+    static const int Size = 100003;
+
+    QRandomGenerator randomGenerator(1);
+    QVector<double> dataX(Size);
+    QVector<double> dataY(Size);
+    double x = 0.0;
+
+    for (int i = 0; i < Size; ++i) {
+        if (randomGenerator.bounded(10) != 0) {
+            x += 0.002*randomGenerator.generateDouble();
+        }
+
+        dataX[i] = x;
+        dataY[i] = std::sin(x)+randomGenerator.generateDouble()-0.5;
+    }
+
+    // Provide our decimator with our samples in chunks of various sizes, like
+    // during a simulation, so that our levels of detail get updated
+    // incrementally (including when a new level is needed)
+
+    OpenCOR::GraphPanelWidget::GraphPanelPlotGraphRunDecimator decimator;
+    int size = 0;
+
+    for (auto chunkSize : { 1, 15, 16, 17, 1000, 4096, 12345 }) {
+        size += chunkSize;
+
+        decimator.setRawSamples(dataX.constData(), dataY.constData(), size);
+    }
+
+    decimator.setRawSamples(dataX.constData(), dataY.constData(), Size);
+
+    // Decimate all or some of our samples to various widths and check the
+    // result against a brute-force approach
+
+    checkDecimation(decimator, dataX, dataY, 0, Size-1, 0.0, 500.0);
+    checkDecimation(decimator, dataX, dataY, 17, Size-5, 3.0, 1000.0);
+    checkDecimation(decimator, dataX, dataY, 12345, 54321, 0.0, 100.0);
+    checkDecimation(decimator, dataX, dataY, 3, Size-1, 0.0, 7.0);
+    checkDecimation(decimator, dataX, dataY, 4097, 4097+255, 0.0, 10.0);
+}
+
+//==============================================================================
+
+QTEST_APPLESS_MAIN(Tests)
+
+//==============================================================================
+// End of file
+//==============================================================================